@@ -4,21 +4,36 @@ INPUT_DIR="inputs"
 OUTPUT_DIR="outputs"
 CFS_EXEC="bin/CFS"
 DPS_EXEC="bin/DPS-DTQ"
-REF_EXEC="bin/REF_PAPER_ALGO"
+REF_EXEC="bin/Reference"
+EDF_EXEC="bin/EDF"
+MLFQ_EXEC="bin/MLFQ"
+STRIDE_EXEC="bin/Stride"
 
 CFS_OUT_DIR="$OUTPUT_DIR/CFS"
 DPS_OUT_DIR="$OUTPUT_DIR/DPS-DTQ"
-REF_OUT_DIR="$OUTPUT_DIR/REF_PAPER_ALGO"
+REF_OUT_DIR="$OUTPUT_DIR/REFERENCE"
+EDF_OUT_DIR="$OUTPUT_DIR/EDF"
+MLFQ_OUT_DIR="$OUTPUT_DIR/MLFQ"
+STRIDE_OUT_DIR="$OUTPUT_DIR/STRIDE"
+LOTTERY_OUT_DIR="$OUTPUT_DIR/LOTTERY"
 
 mkdir -p "$CFS_OUT_DIR"
 mkdir -p "$DPS_OUT_DIR"
 mkdir -p "$REF_OUT_DIR"
+mkdir -p "$EDF_OUT_DIR"
+mkdir -p "$MLFQ_OUT_DIR"
+mkdir -p "$STRIDE_OUT_DIR"
+mkdir -p "$LOTTERY_OUT_DIR"
 
 for input_file in "$INPUT_DIR"/*.txt; do
     base_name=$(basename "$input_file" .txt)
     "$CFS_EXEC" "$input_file" > "$CFS_OUT_DIR/$base_name.csv"
     "$DPS_EXEC" "$input_file" > "$DPS_OUT_DIR/$base_name.csv"
     "$REF_EXEC" "$input_file" > "$REF_OUT_DIR/$base_name.csv"
+    "$EDF_EXEC" "$input_file" > "$EDF_OUT_DIR/$base_name.csv"
+    "$MLFQ_EXEC" "$input_file" > "$MLFQ_OUT_DIR/$base_name.csv"
+    "$STRIDE_EXEC" "$input_file" > "$STRIDE_OUT_DIR/$base_name.csv"
+    "$STRIDE_EXEC" --lottery "$input_file" > "$LOTTERY_OUT_DIR/$base_name.csv"
 done
 
 echo "Execution completed. Outputs written to $OUTPUT_DIR."
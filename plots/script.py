@@ -16,9 +16,9 @@ data_paths = {
         'tight_deadlines': 'outputs/CFS/tight_deadlines.csv'
     },
     'REF_PAPER_ALGO': {
-        'high_criticality_processes': 'outputs/REF_PAPER_ALGO/high_criticality_processes.csv',
-        'simultaneous_arrival': 'outputs/REF_PAPER_ALGO/simultaneous_arrival.csv',
-        'tight_deadlines': 'outputs/REF_PAPER_ALGO/tight_deadlines.csv'
+        'high_criticality_processes': 'outputs/REFERENCE/high_criticality_processes.csv',
+        'simultaneous_arrival': 'outputs/REFERENCE/simultaneous_arrival.csv',
+        'tight_deadlines': 'outputs/REFERENCE/tight_deadlines.csv'
     }
 }
 
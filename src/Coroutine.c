@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include "scheduler.h"
+
+#define MAX_FILENAME_LENGTH 256
+#define COROUTINE_STACK_SIZE (64 * 1024)
+#define DEFAULT_WORK_PER_UNIT 100000
+#define CALIBRATION_SWITCHES 100000
+
+// Each process is backed by a ucontext coroutine that performs burst_time
+// units of synthetic CPU work and yields back to the dispatcher once the
+// quantum granted by the policy (task->slice) is used up.
+typedef struct
+{
+    SchedTask task;
+    ucontext_t context;
+    char *stack;
+    int units_done;
+    int slice_used;
+    volatile unsigned long sink;
+} Coroutine;
+
+typedef struct
+{
+    ucontext_t dispatcher;
+    Coroutine *current;
+    long work_per_unit;
+    long switches;
+    double switch_ns;
+    double work_ns;
+    long switch_stamp; // Taken just before a swapcontext, read on the far side
+} Runtime;
+
+Runtime runtime;
+
+long monotonicNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+void recordSwitch(void)
+{
+    runtime.switch_ns += monotonicNs() - runtime.switch_stamp;
+    runtime.switches++;
+}
+
+void yieldToDispatcher(Coroutine *co)
+{
+    runtime.switch_stamp = monotonicNs();
+    swapcontext(&co->context, &runtime.dispatcher);
+    recordSwitch();
+}
+
+void doWorkUnit(Coroutine *co)
+{
+    unsigned long x = co->sink;
+    long start = monotonicNs();
+
+    for (long i = 0; i < runtime.work_per_unit; i++)
+    {
+        x = x * 6364136223846793005UL + 1442695040888963407UL;
+    }
+
+    runtime.work_ns += monotonicNs() - start;
+    co->sink = x;
+}
+
+void coroutineMain(void)
+{
+    Coroutine *co = runtime.current;
+    recordSwitch();
+
+    while (co->units_done < co->task.burst_time)
+    {
+        doWorkUnit(co);
+        co->units_done++;
+        co->slice_used++;
+
+        // Quantum expired: preempt at the unit boundary
+        if (co->slice_used >= co->task.slice && co->units_done < co->task.burst_time)
+            yieldToDispatcher(co);
+    }
+
+    // Returning switches to uc_link, the dispatcher
+    runtime.switch_stamp = monotonicNs();
+}
+
+int compareArrival(const void *a, const void *b)
+{
+    const Coroutine *c1 = *(Coroutine *const *)a;
+    const Coroutine *c2 = *(Coroutine *const *)b;
+    return c1->task.arrival_time - c2->task.arrival_time;
+}
+
+// Cost of a bare swapcontext round trip with no work in between
+ucontext_t ping_context;
+ucontext_t pong_context;
+
+void pongMain(void)
+{
+    for (;;)
+        swapcontext(&pong_context, &ping_context);
+}
+
+double calibrateSwitch(void)
+{
+    char *stack = malloc(COROUTINE_STACK_SIZE);
+    if (stack == NULL)
+        return 0.0;
+    getcontext(&pong_context);
+    pong_context.uc_stack.ss_sp = stack;
+    pong_context.uc_stack.ss_size = COROUTINE_STACK_SIZE;
+    pong_context.uc_link = NULL;
+    makecontext(&pong_context, pongMain, 0);
+
+    long start = monotonicNs();
+    for (int i = 0; i < CALIBRATION_SWITCHES; i++)
+        swapcontext(&ping_context, &pong_context);
+    long elapsed = monotonicNs() - start;
+
+    free(stack);
+    return (double)elapsed / (2.0 * CALIBRATION_SWITCHES);
+}
+
+int loadCoroutines(const char *filename, Coroutine ***out)
+{
+    FILE *file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("Error opening file: %s\n", filename);
+        exit(1);
+    }
+
+    int capacity = 16;
+    int n = 0;
+    int line_number = 0;
+    Coroutine **coroutines = malloc(sizeof(Coroutine *) * capacity);
+    if (coroutines == NULL)
+    {
+        printf("Out of memory\n");
+        exit(1);
+    }
+
+    for (;;)
+    {
+        Coroutine *co = calloc(1, sizeof(Coroutine));
+        if (co == NULL)
+        {
+            printf("Out of memory\n");
+            exit(1);
+        }
+        int status = sched_read_task(file, &co->task, &line_number);
+        if (status <= 0)
+        {
+            free(co);
+            if (status == SCHED_LINE_TOO_LONG)
+            {
+                printf("Over-long line %d\n", line_number);
+                exit(1);
+            }
+            if (status < 0)
+            {
+                printf("Error reading process information on line %d\n", line_number);
+                exit(1);
+            }
+            break;
+        }
+        if (co->task.burst_time <= 0)
+        {
+            printf("Line %d: burst time must be positive\n", line_number);
+            exit(1);
+        }
+        // The coroutine has no I/O to wait on, so it runs its CPU bursts
+        // back to back, and it shares nothing with nor waits on the others
+        co->task.io.count = 0;
+        co->task.sections.count = 0;
+        co->task.after.count = 0;
+
+        if (n == capacity)
+        {
+            Coroutine **grown = realloc(coroutines, sizeof(Coroutine *) * capacity * 2);
+            if (grown == NULL)
+            {
+                printf("Out of memory\n");
+                exit(1);
+            }
+            coroutines = grown;
+            capacity *= 2;
+        }
+        coroutines[n++] = co;
+    }
+
+    fclose(file);
+    qsort(coroutines, n, sizeof(Coroutine *), compareArrival);
+    *out = coroutines;
+    return n;
+}
+
+int main(int argc, char *argv[])
+{
+    char filename[MAX_FILENAME_LENGTH];
+    SchedPolicy policy = SCHED_POLICY_DPS_DTQ;
+
+    if (argc < 2)
+    {
+        printf("Usage: %s <input_file> [dps|cfs] [work_per_unit]\n", argv[0]);
+        return 1;
+    }
+
+    strncpy(filename, argv[1], MAX_FILENAME_LENGTH - 1);
+    filename[MAX_FILENAME_LENGTH - 1] = '\0';
+    if (argc > 2 && strcmp(argv[2], "cfs") == 0)
+        policy = SCHED_POLICY_CFS;
+    runtime.work_per_unit = argc > 3 ? atol(argv[3]) : DEFAULT_WORK_PER_UNIT;
+
+    Coroutine **coroutines;
+    int n = loadCoroutines(filename, &coroutines);
+    Scheduler *sched = sched_create(policy, NULL);
+    if (sched == NULL)
+    {
+        printf("Failed to create scheduler.\n");
+        return 1;
+    }
+
+    int current_time = 0;
+    int next_arrival = 0;
+    int completed = 0;
+    long start_ns = monotonicNs();
+
+    while (completed < n)
+    {
+        while (next_arrival < n && coroutines[next_arrival]->task.arrival_time <= current_time)
+        {
+            Coroutine *co = coroutines[next_arrival++];
+            co->stack = malloc(COROUTINE_STACK_SIZE);
+            if (co->stack == NULL)
+            {
+                printf("Out of memory\n");
+                return 1;
+            }
+            getcontext(&co->context);
+            co->context.uc_stack.ss_sp = co->stack;
+            co->context.uc_stack.ss_size = COROUTINE_STACK_SIZE;
+            co->context.uc_link = &runtime.dispatcher;
+            makecontext(&co->context, coroutineMain, 0);
+
+            int status = sched_submit(sched, &co->task);
+            if (status < 0)
+            {
+                printf("Failed to submit process %d.\n", co->task.id);
+                return 1;
+            }
+            if (status == SCHED_REJECTED)
+            {
+                // Turned away, so it never runs
+                free(co->stack);
+                co->stack = NULL;
+                completed++;
+            }
+        }
+
+        SchedTask *task = sched_pick_next(sched, current_time);
+        if (task == NULL)
+        {
+            if (next_arrival == n)
+                break; // Nothing ready and nothing left to arrive
+            current_time = coroutines[next_arrival]->task.arrival_time;
+            continue;
+        }
+
+        Coroutine *co = (Coroutine *)task;
+        co->slice_used = 0;
+        runtime.current = co;
+        runtime.switch_stamp = monotonicNs();
+        swapcontext(&runtime.dispatcher, &co->context);
+        recordSwitch();
+
+        current_time += co->slice_used;
+        int requeued = sched_charge(sched, task, co->slice_used);
+        if (requeued < 0)
+        {
+            printf("Failed to requeue process %d.\n", task->id);
+            return 1;
+        }
+        if (requeued == 0)
+        {
+            sched_complete(sched, task, current_time);
+            free(co->stack);
+            co->stack = NULL;
+            completed++;
+        }
+    }
+
+    double wall_ns = monotonicNs() - start_ns;
+    double raw_switch_ns = calibrateSwitch();
+
+    SchedMetrics metrics;
+    sched_metrics(sched, current_time, &metrics);
+    sched_destroy(sched);
+
+    printf("Metric,Value\n");
+    printf("Average Turnaround Time,%.2f\n", metrics.avg_turnaround_time);
+    printf("Average Waiting Time,%.2f\n", metrics.avg_waiting_time);
+    printf("Average Response Time,%.2f\n", metrics.avg_response_time);
+    printf("Throughput,%.2f\n", metrics.throughput);
+    printf("Fairness Index,%.2f\n", metrics.fairness_index);
+    printf("Starvation Count,%d\n", metrics.starvation_count);
+    printf("Load Balancing Efficiency,%.2f\n", metrics.load_balancing_efficiency);
+    printf("Context Switches,%ld\n", runtime.switches);
+    printf("Average Switch Cost (ns),%.1f\n", runtime.switches ? runtime.switch_ns / runtime.switches : 0.0);
+    printf("Raw swapcontext Cost (ns),%.1f\n", raw_switch_ns);
+    printf("Work Time (ms),%.3f\n", runtime.work_ns / 1e6);
+    printf("Wall Time (ms),%.3f\n", wall_ns / 1e6);
+    printf("Switch Overhead,%.4f\n", runtime.switch_ns / (runtime.switch_ns + runtime.work_ns));
+
+    for (int i = 0; i < n; i++)
+        free(coroutines[i]);
+    free(coroutines);
+
+    return 0;
+}
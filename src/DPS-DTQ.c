@@ -2,54 +2,11 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
-#include <math.h>
-#include <time.h>
 
-#define MAX_PROCESSES 100
-#define MAX_QUEUE_SIZE 100
-#define MAX_GANTT_CHART_SIZE 1000
-#define MAX_FILENAME_LENGTH 256
-
-// Process structure
-typedef struct
-{
-    int id;
-    int arrival_time;
-    int burst_time;
-    int remaining_burst;
-    int completion_time;
-    int waiting_time;
-    int turnaround_time;
-    int response_time;
-    int first_execution_time; // For response time calculation
-    int deadline;             // For real-time processes
-    int criticality;          // Higher for safety-critical tasks (1-10)
-    int period;               // For periodic tasks
-    int system_priority;      // Manual override or industry standard
-    bool executed;            // Flag to check if process has started execution
-    bool completed;           // Flag to check if process has completed
-} Process;
-
-// Dynamic Time Quantum structure
-typedef struct
-{
-    double base;               // Base time quantum
-    double current;            // Current time quantum after adjustment
-    double load_factor;        // CPU load factor (0.0 to 1.0)
-    double criticality_weight; // Weight for criticality (Wc)
-    double deadline_weight;    // Weight for deadline (Wf)
-    double aging_weight;       // Weight for aging (Wa)
-    double priority_weight;    // Weight for system priority (Ws)
-} DynamicQuantum;
+#include "scheduler.h"
+#include "sched_frontend.h"
 
-// Ready Queue structure
-typedef struct
-{
-    Process *processes[MAX_QUEUE_SIZE];
-    int front;
-    int rear;
-    int size;
-} ReadyQueue;
+#define MAX_GANTT_CHART_SIZE 1000
 
 // Gantt Chart structure
 typedef struct
@@ -59,158 +16,15 @@ typedef struct
     int end_time;
 } GanttChartItem;
 
-// Benchmarking metrics
-typedef struct
-{
-    double avg_turnaround_time;
-    double avg_waiting_time;
-    double avg_response_time;
-    double throughput;
-    double fairness_index;
-    int starvation_count;
-    double load_balancing_efficiency;
-} Metrics;
-
-Process processes[MAX_PROCESSES];
+SchedFrontend frontend;
 GanttChartItem gantt_chart[MAX_GANTT_CHART_SIZE];
 int gantt_chart_size = 0;
-Metrics metrics;
 
-void initializeQueue(ReadyQueue *queue);
-bool isQueueEmpty(ReadyQueue *queue);
-bool isQueueFull(ReadyQueue *queue);
-void enqueue(ReadyQueue *queue, Process *process);
-Process *dequeue(ReadyQueue *queue);
-void calculateDynamicPriority(Process *process, int current_time, DynamicQuantum *dtq);
-double calculateAgingFactor(Process *process, int current_time);
-void sortQueueByPriority(ReadyQueue *queue, int current_time, DynamicQuantum *dtq);
-void runDPS_DTQ(Process *processes, int n, DynamicQuantum *dtq);
-void calculateMetrics(Process *processes, int n, int total_time);
 void displayGanttChart();
-void displayProcessDetails(Process *processes, int n);
-void displayMetrics();
+void displayProcessDetails(const SchedTask *tasks, int n);
+void parseArguments(int argc, char *argv[]);
 void addToGanttChart(int process_id, int start_time, int end_time);
-int readProcessesFromFile(Process *processes, const char *filename);
-void writeDefaultInputFile(const char *filename);
-
-void initializeQueue(ReadyQueue *queue)
-{
-    queue->front = 0;
-    queue->rear = -1;
-    queue->size = 0;
-}
-
-bool isQueueEmpty(ReadyQueue *queue)
-{
-    return queue->size == 0;
-}
-
-bool isQueueFull(ReadyQueue *queue)
-{
-    return queue->size == MAX_QUEUE_SIZE;
-}
-
-void enqueue(ReadyQueue *queue, Process *process)
-{
-    if (isQueueFull(queue))
-    {
-        printf("Queue is full! Cannot add more processes.\n");
-        return;
-    }
-
-    queue->rear = (queue->rear + 1) % MAX_QUEUE_SIZE;
-    queue->processes[queue->rear] = process;
-    queue->size++;
-}
-
-Process *dequeue(ReadyQueue *queue)
-{
-    if (isQueueEmpty(queue))
-    {
-        return NULL;
-    }
-
-    Process *process = queue->processes[queue->front];
-    queue->front = (queue->front + 1) % MAX_QUEUE_SIZE;
-    queue->size--;
-
-    return process;
-}
-
-double calculateAgingFactor(Process *process, int current_time)
-{
-    int waiting_time = current_time - process->arrival_time -
-                       (process->burst_time - process->remaining_burst);
-
-    double aging_factor = waiting_time > 0 ? (double)waiting_time / 10.0 : 0.0;
-    if (aging_factor > 1.0)
-        aging_factor = 1.0;
-
-    return aging_factor;
-}
-
-void calculateDynamicPriority(Process *process, int current_time, DynamicQuantum *dtq)
-{
-    double priority = 0.0;
-
-    double criticality_component = process->criticality / 10.0;
-    double deadline_component = 0.0;
-    if (process->deadline > 0)
-    {
-        int time_to_deadline = process->deadline - current_time;
-        if (time_to_deadline <= 0)
-        {
-            deadline_component = 1.0;
-        }
-        else
-        {
-            deadline_component = 1.0 / (1.0 + time_to_deadline);
-        }
-    }
-
-    double period_component = 0.0;
-    if (process->period > 0)
-    {
-        period_component = 1.0 / process->period;
-    }
-
-    double aging_component = calculateAgingFactor(process, current_time);
-
-    double system_priority_component = process->system_priority / 10.0;
-    priority = (dtq->criticality_weight * criticality_component) +
-               (dtq->deadline_weight * deadline_component) +
-               (dtq->aging_weight * aging_component) +
-               (dtq->priority_weight * system_priority_component);
-
-    dtq->current = dtq->base * (1.0 + priority) * (1.0 - 0.5 * dtq->load_factor);
-
-    process->system_priority = (int)(priority * 100);
-}
-
-void sortQueueByPriority(ReadyQueue *queue, int current_time, DynamicQuantum *dtq)
-{
-    for (int i = 0; i < queue->size; i++)
-    {
-        int idx = (queue->front + i) % MAX_QUEUE_SIZE;
-        calculateDynamicPriority(queue->processes[idx], current_time, dtq);
-    }
-
-    for (int i = 0; i < queue->size - 1; i++)
-    {
-        for (int j = 0; j < queue->size - i - 1; j++)
-        {
-            int idx1 = (queue->front + j) % MAX_QUEUE_SIZE;
-            int idx2 = (queue->front + j + 1) % MAX_QUEUE_SIZE;
-
-            if (queue->processes[idx1]->system_priority < queue->processes[idx2]->system_priority)
-            {
-                Process *temp = queue->processes[idx1];
-                queue->processes[idx1] = queue->processes[idx2];
-                queue->processes[idx2] = temp;
-            }
-        }
-    }
-}
+void recordSlice(void *ctx, const SchedTask *task, int cpu, int start_time, int end_time);
 
 void addToGanttChart(int process_id, int start_time, int end_time)
 {
@@ -227,230 +41,26 @@ void addToGanttChart(int process_id, int start_time, int end_time)
     }
 }
 
-int readProcessesFromFile(Process *processes, const char *filename)
+// The Gantt chart has one lane, so only the first CPU is drawn
+void recordSlice(void *ctx, const SchedTask *task, int cpu, int start_time, int end_time)
 {
-    FILE *file = fopen(filename, "r");
-    if (file == NULL)
-    {
-        printf("Error opening file %s. Creating a default input file...\n", filename);
-        writeDefaultInputFile(filename);
-
-        file = fopen(filename, "r");
-        if (file == NULL)
-        {
-            printf("Failed to create default input file. Exiting...\n");
-            exit(1);
-        }
-        printf("Default input file created successfully.\n");
-    }
-
-    int n;
-    if (fscanf(file, "%d", &n) != 1)
-    {
-        printf("Error reading number of processes from file.\n");
-        fclose(file);
-        exit(1);
-    }
-
-    if (n <= 0 || n > MAX_PROCESSES)
-    {
-        printf("Invalid number of processes: %d (must be between 1 and %d)\n", n, MAX_PROCESSES);
-        fclose(file);
-        exit(1);
-    }
-
-    for (int i = 0; i < n; i++)
-    {
-        if (fscanf(file, "%d %d %d %d %d %d %d",
-                   &processes[i].id,
-                   &processes[i].arrival_time,
-                   &processes[i].burst_time,
-                   &processes[i].deadline,
-                   &processes[i].criticality,
-                   &processes[i].period,
-                   &processes[i].system_priority) != 7)
-        {
-            printf("Error reading data for process %d\n", i + 1);
-            fclose(file);
-            exit(1);
-        }
-
-        processes[i].remaining_burst = processes[i].burst_time;
-        processes[i].completion_time = 0;
-        processes[i].waiting_time = 0;
-        processes[i].turnaround_time = 0;
-        processes[i].response_time = 0;
-        processes[i].first_execution_time = -1;
-        processes[i].executed = false;
-        processes[i].completed = false;
-    }
-
-    fclose(file);
-    return n;
-}
-
-void writeDefaultInputFile(const char *filename)
-{
-    FILE *file = fopen(filename, "w");
-    if (file == NULL)
-    {
-        printf("Error creating default input file.\n");
+    (void)ctx;
+    if (cpu != 0)
         return;
-    }
-
-    int n = 10;
-    fprintf(file, "%d\n", n);
-
-    fprintf(file, "1 0 8 20 7 0 5\n");
-    fprintf(file, "2 2 4 15 9 0 8\n");
-    fprintf(file, "3 4 2 10 6 10 3\n");
-    fprintf(file, "4 6 6 25 3 0 4\n");
-    fprintf(file, "5 8 5 0 5 12 6\n");
-    fprintf(file, "6 10 3 18 8 0 7\n");
-    fprintf(file, "7 12 7 30 4 15 5\n");
-    fprintf(file, "8 14 1 17 10 0 9\n");
-    fprintf(file, "9 16 9 0 2 20 2\n");
-    fprintf(file, "10 18 4 25 7 0 6\n");
 
-    fclose(file);
-}
-
-void runDPS_DTQ(Process *processes, int n, DynamicQuantum *dtq)
-{
-    ReadyQueue ready_queue;
-    initializeQueue(&ready_queue);
+    int process_id = task != NULL ? task->id : -1;
 
-    int current_time = 0;
-    int completed_processes = 0;
-    int idle_time = 0;
-
-    while (completed_processes < n)
+    if (gantt_chart_size > 0 &&
+        gantt_chart[gantt_chart_size - 1].process_id == process_id &&
+        gantt_chart[gantt_chart_size - 1].end_time == start_time)
     {
-        for (int i = 0; i < n; i++)
-        {
-            if (processes[i].arrival_time == current_time)
-            {
-                enqueue(&ready_queue, &processes[i]);
-            }
-        }
-
-        if (isQueueEmpty(&ready_queue))
-        {
-            current_time++;
-            idle_time++;
-            if (idle_time == 1)
-            {
-                addToGanttChart(-1, current_time - 1, current_time);
-            }
-            else
-            {
-                gantt_chart[gantt_chart_size - 1].end_time = current_time;
-            }
-            continue;
-        }
-        else
-        {
-            idle_time = 0;
-        }
-
-        dtq->load_factor = (double)ready_queue.size / n;
-
-        sortQueueByPriority(&ready_queue, current_time, dtq);
-
-        Process *current_process = dequeue(&ready_queue);
-
-        if (!current_process->executed)
-        {
-            current_process->first_execution_time = current_time;
-            current_process->executed = true;
-        }
-
-        calculateDynamicPriority(current_process, current_time, dtq);
-        int time_quantum = (int)dtq->current;
-        if (time_quantum < 1)
-            time_quantum = 1;
-        int execution_time = (current_process->remaining_burst < time_quantum) ? current_process->remaining_burst : time_quantum;
-
-        addToGanttChart(current_process->id, current_time, current_time + execution_time);
-
-        current_process->remaining_burst -= execution_time;
-        current_time += execution_time;
-
-        if (current_process->remaining_burst == 0)
-        {
-            current_process->completed = true;
-            current_process->completion_time = current_time;
-            current_process->turnaround_time = current_process->completion_time - current_process->arrival_time;
-            current_process->waiting_time = current_process->turnaround_time - current_process->burst_time;
-            current_process->response_time = current_process->first_execution_time - current_process->arrival_time;
-            completed_processes++;
-        }
-        else
-        {
-            enqueue(&ready_queue, current_process);
-        }
-
-        for (int i = 0; i < n; i++)
-        {
-            if (!processes[i].executed &&
-                processes[i].arrival_time > current_time - execution_time &&
-                processes[i].arrival_time <= current_time)
-            {
-                enqueue(&ready_queue, &processes[i]);
-            }
-        }
-    }
-
-    calculateMetrics(processes, n, current_time);
-}
-
-void calculateMetrics(Process *processes, int n, int total_time)
-{
-    double total_turnaround_time = 0.0;
-    double total_waiting_time = 0.0;
-    double total_response_time = 0.0;
-    double sum_of_squares = 0.0;
-    double sum = 0.0;
-    int starvation_threshold = 20;
-    int starved_count = 0;
-
-    for (int i = 0; i < n; i++)
-    {
-        total_turnaround_time += processes[i].turnaround_time;
-        total_waiting_time += processes[i].waiting_time;
-        total_response_time += processes[i].response_time;
-
-        sum += processes[i].turnaround_time;
-        sum_of_squares += (double)processes[i].turnaround_time * processes[i].turnaround_time;
-
-        if (processes[i].waiting_time > starvation_threshold)
-        {
-            starved_count++;
-        }
-    }
-
-    metrics.avg_turnaround_time = total_turnaround_time / n;
-    metrics.avg_waiting_time = total_waiting_time / n;
-    metrics.avg_response_time = total_response_time / n;
-
-    metrics.throughput = (double)n / total_time;
-
-    metrics.fairness_index = (sum * sum) / (n * sum_of_squares);
-
-    metrics.starvation_count = starved_count;
-
-    double mean_waiting_time = total_waiting_time / n;
-    double variance = 0.0;
-
-    for (int i = 0; i < n; i++)
-    {
-        variance += pow(processes[i].waiting_time - mean_waiting_time, 2);
+        gantt_chart[gantt_chart_size - 1].end_time = end_time;
+        return;
     }
 
-    double std_dev = sqrt(variance / n);
-    double coefficient_of_variation = std_dev / mean_waiting_time;
-
-    metrics.load_balancing_efficiency = 1.0 / (1.0 + coefficient_of_variation);
+    // Periodic runs can outgrow the chart; keep the start of the schedule
+    if (gantt_chart_size < MAX_GANTT_CHART_SIZE)
+        addToGanttChart(process_id, start_time, end_time);
 }
 
 void displayGanttChart()
@@ -514,69 +124,88 @@ void displayGanttChart()
     printf("%2d\n", gantt_chart[gantt_chart_size - 1].end_time);
 }
 
-void displayProcessDetails(Process *processes, int n)
+// SystemPriority is the dynamic priority the policy last gave the process
+void displayProcessDetails(const SchedTask *tasks, int n)
 {
     printf("ProcessID,ArrivalTime,BurstTime,CompletionTime,TurnaroundTime,WaitingTime,ResponseTime,Deadline,Criticality,Period,SystemPriority\n");
 
     for (int i = 0; i < n; i++)
     {
         printf("%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
-               processes[i].id,
-               processes[i].arrival_time,
-               processes[i].burst_time,
-               processes[i].completion_time,
-               processes[i].turnaround_time,
-               processes[i].waiting_time,
-               processes[i].response_time,
-               processes[i].deadline,
-               processes[i].criticality,
-               processes[i].period,
-               processes[i].system_priority);
+               tasks[i].id,
+               tasks[i].arrival_time,
+               tasks[i].burst_time,
+               tasks[i].completion_time,
+               tasks[i].turnaround_time,
+               tasks[i].waiting_time,
+               tasks[i].response_time,
+               tasks[i].deadline,
+               tasks[i].criticality,
+               tasks[i].period,
+               tasks[i].dynamic_priority);
     }
 }
 
-void displayMetrics()
-{
-    printf("Metric,Value\n");
-    printf("Average Turnaround Time,%.2f\n", metrics.avg_turnaround_time);
-    printf("Average Waiting Time,%.2f\n", metrics.avg_waiting_time);
-    printf("Average Response Time,%.2f\n", metrics.avg_response_time);
-    printf("Throughput,%.2f\n", metrics.throughput);
-    printf("Fairness Index,%.2f\n", metrics.fairness_index);
-    printf("Starvation Count,%d\n", metrics.starvation_count);
-    printf("Load Balancing Efficiency,%.2f\n", metrics.load_balancing_efficiency);
-}
-
-int main(int argc, char *argv[])
+// Applies the DPS-DTQ options, and the shared ones through the front end
+void parseArguments(int argc, char *argv[])
 {
-    int n;
-    DynamicQuantum dtq;
-    char filename[MAX_FILENAME_LENGTH];
-
-    dtq.base = 4.0;
-    dtq.current = dtq.base;
-    dtq.load_factor = 0.0;
-    dtq.criticality_weight = 0.35;
-    dtq.deadline_weight = 0.30;
-    dtq.aging_weight = 0.25;
-    dtq.priority_weight = 0.10;
+    SchedConfig *config = &frontend.config;
+    sched_frontend_init(&frontend, SCHED_POLICY_DPS_DTQ);
+    frontend.sample_input = true;
 
-    if (argc > 1)
+    for (int i = 1; i < argc; i++)
     {
-        strncpy(filename, argv[1], MAX_FILENAME_LENGTH - 1);
-        filename[MAX_FILENAME_LENGTH - 1] = '\0';
+        if (strcmp(argv[i], "--preempt") == 0)
+            config->preempt_on_arrival = true;
+        else if (strcmp(argv[i], "--locking=none") == 0)
+            config->lock_protocol = SCHED_LOCK_NONE;
+        else if (strcmp(argv[i], "--locking=inherit") == 0)
+            config->lock_protocol = SCHED_LOCK_INHERIT;
+        else if (strcmp(argv[i], "--locking=ceiling") == 0)
+            config->lock_protocol = SCHED_LOCK_CEILING;
+        else if (strncmp(argv[i], "--critical-path=", 16) == 0)
+            config->critical_path_weight = atof(argv[i] + 16);
+        else if (strncmp(argv[i], "--target-p99=", 13) == 0)
+        {
+            config->quantum_target = SCHED_QUANTUM_RESPONSE;
+            config->quantum_setpoint = atof(argv[i] + 13);
+        }
+        else if (strncmp(argv[i], "--target-switch-rate=", 21) == 0)
+        {
+            config->quantum_target = SCHED_QUANTUM_SWITCHES;
+            config->quantum_setpoint = atof(argv[i] + 21);
+        }
+        else if (!sched_frontend_option(&frontend, argv[i]))
+        {
+            printf("Unknown option %s\n", argv[i]);
+            exit(1);
+        }
     }
-    else
+
+    if (config->quantum_target != SCHED_QUANTUM_FIXED && config->quantum_setpoint <= 0)
     {
-        strcpy(filename, "input.txt");
-        printf("No input file specified. Using default: %s\n", filename);
+        printf("The quantum target must be positive\n");
+        exit(1);
     }
+}
 
-    n = readProcessesFromFile(processes, filename);
-
-    runDPS_DTQ(processes, n, &dtq);
+// The dynamic priority and quantum policy lives in libscheduler; the front
+// end runs it on the event-driven simulator.
+int main(int argc, char *argv[])
+{
+    parseArguments(argc, argv);
+    if (!sched_frontend_check(&frontend))
+    {
+        printf("Usage: %s [--preempt] [--locking=none|inherit|ceiling] [--critical-path=W] "
+               "[--target-p99=T | --target-switch-rate=R] " SCHED_FRONTEND_USAGE "\n", argv[0]);
+        return 1;
+    }
 
-    displayMetrics();
+    Scheduler *sched = sched_frontend_create(&frontend);
+    SchedSimHooks hooks = {recordSlice, NULL, NULL, NULL};
+    sched_frontend_run(&frontend, sched, &hooks);
+    sched_destroy(sched);
 
+    sched_frontend_report(&frontend);
     return 0;
 }
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "scheduler.h"
+#include "sched_frontend.h"
+
+SchedFrontend frontend;
+
+void parseArguments(int argc, char *argv[]);
+
+// Applies the EDF options, and the shared ones through the front end
+void parseArguments(int argc, char *argv[])
+{
+    sched_frontend_init(&frontend, SCHED_POLICY_EDF);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--admission=all") == 0)
+            frontend.config.admission = SCHED_ADMIT_ALL;
+        else if (strcmp(argv[i], "--admission=reject") == 0)
+            frontend.config.admission = SCHED_ADMIT_REJECT;
+        else if (strcmp(argv[i], "--admission=demote") == 0)
+            frontend.config.admission = SCHED_ADMIT_DEMOTE;
+        else if (strncmp(argv[i], "--bound=", 8) == 0)
+            frontend.config.utilization_bound = atof(argv[i] + 8);
+        else if (!sched_frontend_option(&frontend, argv[i]))
+        {
+            printf("Unknown option %s\n", argv[i]);
+            exit(1);
+        }
+    }
+}
+
+// The deadline heap and admission test live in libscheduler; the front end
+// runs them on the event-driven simulator.
+int main(int argc, char *argv[])
+{
+    parseArguments(argc, argv);
+    if (!sched_frontend_check(&frontend))
+    {
+        printf("Usage: %s [--admission=all|reject|demote] [--bound=U] " SCHED_FRONTEND_USAGE "\n", argv[0]);
+        return 1;
+    }
+
+    Scheduler *sched = sched_frontend_create(&frontend);
+    sched_frontend_run(&frontend, sched, NULL);
+    sched_destroy(sched);
+
+    sched_frontend_report(&frontend);
+    return 0;
+}
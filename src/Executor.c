@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "scheduler.h"
+#include "sched_pool.h"
+
+#define MAX_FILENAME_LENGTH 256
+#define DEFAULT_WORKERS 4
+#define DEFAULT_UNIT_US 1000
+#define CLOCK_CHECK_INTERVAL 1024
+
+// Synthetic CPU-bound work item: spins for burst_time scheduler units
+typedef struct
+{
+    SchedTask task;
+    long remaining_ns;
+    volatile unsigned long sink;
+} WorkItem;
+
+long monotonicNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+bool spinWork(void *arg, long budget_ns)
+{
+    WorkItem *item = arg;
+    long start = monotonicNs();
+    long elapsed = 0;
+    unsigned long x = item->sink;
+
+    while (elapsed < budget_ns && elapsed < item->remaining_ns)
+    {
+        for (int i = 0; i < CLOCK_CHECK_INTERVAL; i++)
+        {
+            x = x * 6364136223846793005UL + 1442695040888963407UL;
+        }
+        elapsed = monotonicNs() - start;
+    }
+
+    item->sink = x;
+    item->remaining_ns -= elapsed;
+    return item->remaining_ns <= 0;
+}
+
+void sleepUntil(long target_ns)
+{
+    long now = monotonicNs();
+    if (target_ns <= now)
+        return;
+
+    struct timespec ts;
+    ts.tv_sec = (target_ns - now) / 1000000000L;
+    ts.tv_nsec = (target_ns - now) % 1000000000L;
+    nanosleep(&ts, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    char filename[MAX_FILENAME_LENGTH];
+    int workers = DEFAULT_WORKERS;
+    long unit_us = DEFAULT_UNIT_US;
+    SchedPolicy policy = SCHED_POLICY_DPS_DTQ;
+
+    if (argc < 2)
+    {
+        printf("Usage: %s <input_file> [workers] [unit_us] [dps|cfs]\n", argv[0]);
+        return 1;
+    }
+
+    strncpy(filename, argv[1], MAX_FILENAME_LENGTH - 1);
+    filename[MAX_FILENAME_LENGTH - 1] = '\0';
+    if (argc > 2)
+        workers = atoi(argv[2]);
+    if (argc > 3)
+        unit_us = atol(argv[3]);
+    if (argc > 4 && strcmp(argv[4], "cfs") == 0)
+        policy = SCHED_POLICY_CFS;
+
+    if (workers < 1 || unit_us < 1)
+    {
+        printf("Workers and unit_us must be positive\n");
+        return 1;
+    }
+
+    FILE *file = strcmp(filename, "-") == 0 ? stdin : fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("Error opening file: %s\n", filename);
+        return 1;
+    }
+
+    SchedPool *pool = sched_pool_create(policy, NULL, workers, unit_us * 1000);
+    if (pool == NULL)
+    {
+        printf("Failed to start the worker pool\n");
+        return 1;
+    }
+
+    // Replay arrivals in real time; items stay allocated until the pool is idle
+    long start_ns = monotonicNs();
+    int line_number = 0;
+    int capacity = 64;
+    int count = 0;
+    bool failed = false;
+    WorkItem **items = malloc(sizeof(WorkItem *) * capacity);
+    if (items == NULL)
+    {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    for (;;)
+    {
+        WorkItem *item = calloc(1, sizeof(WorkItem));
+        if (item == NULL)
+        {
+            printf("Out of memory\n");
+            failed = true;
+            break;
+        }
+        int status = sched_read_task(file, &item->task, &line_number);
+        if (status <= 0)
+        {
+            free(item);
+            if (status == SCHED_LINE_TOO_LONG)
+                printf("Over-long line %d\n", line_number);
+            else if (status < 0)
+                printf("Malformed record on line %d\n", line_number);
+            failed = status < 0;
+            break;
+        }
+
+        if (count == capacity)
+        {
+            WorkItem **grown = realloc(items, sizeof(WorkItem *) * capacity * 2);
+            if (grown == NULL)
+            {
+                printf("Out of memory\n");
+                free(item);
+                failed = true;
+                break;
+            }
+            items = grown;
+            capacity *= 2;
+        }
+
+        item->remaining_ns = item->task.burst_time * unit_us * 1000;
+        sleepUntil(start_ns + item->task.arrival_time * unit_us * 1000);
+        if (sched_pool_submit(pool, &item->task, spinWork, item) != 0)
+        {
+            printf("Failed to submit process %d\n", item->task.id);
+            free(item);
+            failed = true;
+            break;
+        }
+        items[count++] = item;
+    }
+
+    if (file != stdin)
+        fclose(file);
+
+    sched_pool_wait(pool);
+
+    SchedPoolStats stats;
+    SchedMetrics metrics;
+    sched_pool_stats(pool, &stats);
+    sched_pool_metrics(pool, &metrics);
+    sched_pool_destroy(pool);
+
+    printf("Metric,Value\n");
+    printf("Average Turnaround Time,%.2f\n", metrics.avg_turnaround_time);
+    printf("Average Waiting Time,%.2f\n", metrics.avg_waiting_time);
+    printf("Average Response Time,%.2f\n", metrics.avg_response_time);
+    printf("Throughput,%.2f\n", metrics.throughput);
+    printf("Fairness Index,%.2f\n", metrics.fairness_index);
+    printf("Starvation Count,%d\n", metrics.starvation_count);
+    printf("Load Balancing Efficiency,%.2f\n", metrics.load_balancing_efficiency);
+    printf("Workers,%d\n", workers);
+    if (stats.rejected > 0)
+        printf("Rejected,%ld\n", stats.rejected);
+    printf("Dispatches,%ld\n", stats.dispatches);
+    printf("Wall Time (s),%.3f\n", stats.wall_seconds);
+    printf("Real Throughput (jobs/s),%.2f\n", stats.throughput);
+    printf("Average Latency (ms),%.3f\n", stats.avg_latency_ms);
+    printf("P99 Latency (ms),%.3f\n", stats.p99_latency_ms);
+    printf("Max Latency (ms),%.3f\n", stats.max_latency_ms);
+    printf("Average Lock Wait (us),%.3f\n", stats.avg_lock_wait_us);
+    printf("Scheduler Overhead,%.4f\n", stats.scheduler_overhead);
+
+    for (int i = 0; i < count; i++)
+        free(items[i]);
+    free(items);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "scheduler.h"
+#include "sched_intake.h"
+
+#define DEFAULT_MAX_PRODUCERS 64
+#define DEFAULT_TASKS_PER_PRODUCER 20000
+#define INTAKE_CAPACITY 65536
+#define DRAIN_BATCH 512
+
+// Measures per-submit latency as the number of producer threads grows, for
+// the lock-free intake ring against a mutex around sched_submit.
+
+typedef struct
+{
+    SchedIntake *intake;
+    Scheduler *sched;
+    pthread_mutex_t lock;
+    atomic_bool done;
+    bool use_lock;
+} BenchState;
+
+typedef struct
+{
+    BenchState *state;
+    SchedTask *tasks;
+    int count;
+    double total_ns;
+} ProducerArgs;
+
+long monotonicNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+void *producerMain(void *data)
+{
+    ProducerArgs *args = data;
+    BenchState *state = args->state;
+
+    for (int i = 0; i < args->count; i++)
+    {
+        SchedTask *task = &args->tasks[i];
+        long start = monotonicNs();
+
+        if (state->use_lock)
+        {
+            pthread_mutex_lock(&state->lock);
+            sched_submit(state->sched, task);
+            pthread_mutex_unlock(&state->lock);
+        }
+        else
+        {
+            while (!sched_intake_push(state->intake, task))
+                sched_yield(); // Ring full, give the consumer the core
+        }
+
+        args->total_ns += monotonicNs() - start;
+    }
+
+    return NULL;
+}
+
+// Plays the scheduler thread: drains submissions and retires picked tasks
+void *consumerMain(void *data)
+{
+    BenchState *state = data;
+
+    while (!atomic_load(&state->done))
+    {
+        if (state->use_lock)
+            pthread_mutex_lock(&state->lock);
+        else
+            sched_intake_drain(state->intake, state->sched, DRAIN_BATCH, NULL, NULL);
+
+        SchedTask *task;
+        while ((task = sched_pick_next(state->sched, 0)) != NULL)
+        {
+            sched_charge(state->sched, task, task->remaining_burst);
+            sched_complete(state->sched, task, 0);
+        }
+
+        if (state->use_lock)
+            pthread_mutex_unlock(&state->lock);
+    }
+
+    return NULL;
+}
+
+double runRound(int producers, int per_producer, bool use_lock)
+{
+    BenchState state;
+    state.intake = sched_intake_create(INTAKE_CAPACITY);
+    state.sched = sched_create(SCHED_POLICY_CFS, NULL);
+    pthread_mutex_init(&state.lock, NULL);
+    atomic_init(&state.done, false);
+    state.use_lock = use_lock;
+
+    pthread_t *threads = malloc(sizeof(pthread_t) * producers);
+    ProducerArgs *args = calloc(producers, sizeof(ProducerArgs));
+
+    for (int p = 0; p < producers; p++)
+    {
+        args[p].state = &state;
+        args[p].count = per_producer;
+        args[p].tasks = calloc(per_producer, sizeof(SchedTask));
+        for (int i = 0; i < per_producer; i++)
+        {
+            args[p].tasks[i].id = p * per_producer + i;
+            args[p].tasks[i].burst_time = 1;
+            args[p].tasks[i].criticality = 1 + i % 10;
+        }
+    }
+
+    pthread_t consumer;
+    pthread_create(&consumer, NULL, consumerMain, &state);
+    for (int p = 0; p < producers; p++)
+        pthread_create(&threads[p], NULL, producerMain, &args[p]);
+
+    double total_ns = 0;
+    for (int p = 0; p < producers; p++)
+    {
+        pthread_join(threads[p], NULL);
+        total_ns += args[p].total_ns;
+    }
+
+    atomic_store(&state.done, true);
+    pthread_join(consumer, NULL);
+
+    for (int p = 0; p < producers; p++)
+        free(args[p].tasks);
+
+    sched_destroy(state.sched);
+    sched_intake_destroy(state.intake);
+    pthread_mutex_destroy(&state.lock);
+    free(threads);
+    free(args);
+
+    return total_ns / ((double)producers * per_producer);
+}
+
+int main(int argc, char *argv[])
+{
+    int max_producers = argc > 1 ? atoi(argv[1]) : DEFAULT_MAX_PRODUCERS;
+    int per_producer = argc > 2 ? atoi(argv[2]) : DEFAULT_TASKS_PER_PRODUCER;
+
+    if (max_producers < 1 || per_producer < 1)
+    {
+        printf("Usage: %s [max_producers] [tasks_per_producer]\n", argv[0]);
+        return 1;
+    }
+
+    printf("Producers,LockFreeSubmitNs,MutexSubmitNs\n");
+    for (int producers = 1; producers <= max_producers; producers *= 2)
+    {
+        double lock_free = runRound(producers, per_producer, false);
+        double locked = runRound(producers, per_producer, true);
+        printf("%d,%.1f,%.1f\n", producers, lock_free, locked);
+    }
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include "scheduler.h"
+#include "sched_frontend.h"
+
+SchedFrontend frontend;
+
+int parseQuanta(const char *list);
+void parseArguments(int argc, char *argv[]);
+
+// Reads "--quanta=2,4,8" into the per-level quanta and returns how many were
+// given, or -1 if the list is malformed. Levels past the list keep doubling
+// the last quantum.
+int parseQuanta(const char *list)
+{
+    int *quanta = frontend.config.mlfq_quantum;
+    int count = 0;
+    char *end;
+
+    for (;;)
+    {
+        long quantum = strtol(list, &end, 10);
+        if (end == list || quantum < 1 || quantum > INT_MAX || count == SCHED_MLFQ_MAX_LEVELS)
+            return -1;
+        quanta[count++] = (int)quantum;
+        if (*end != ',')
+            break;
+        list = end + 1;
+    }
+    if (*end != '\0')
+        return -1;
+
+    for (int i = count; i < SCHED_MLFQ_MAX_LEVELS; i++)
+    {
+        int previous = quanta[i - 1];
+        quanta[i] = previous < INT_MAX / 2 ? previous * 2 : previous;
+    }
+    return count;
+}
+
+// Applies the MLFQ options, and the shared ones through the front end
+void parseArguments(int argc, char *argv[])
+{
+    int levels = 0;
+    int quanta = 0;
+    sched_frontend_init(&frontend, SCHED_POLICY_MLFQ);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--levels=", 9) == 0)
+            levels = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--quanta=", 9) == 0)
+        {
+            quanta = parseQuanta(argv[i] + 9);
+            if (quanta < 0)
+            {
+                printf("Invalid quanta %s\n", argv[i] + 9);
+                exit(1);
+            }
+        }
+        else if (strncmp(argv[i], "--boost=", 8) == 0)
+            frontend.config.mlfq_boost_period = atoi(argv[i] + 8);
+        else if (!sched_frontend_option(&frontend, argv[i]))
+        {
+            printf("Unknown option %s\n", argv[i]);
+            exit(1);
+        }
+    }
+
+    // Without --levels there is one level per quantum given
+    if (levels == 0 && quanta > 0)
+        levels = quanta;
+    if (levels != 0)
+    {
+        if (levels < 1 || levels > SCHED_MLFQ_MAX_LEVELS)
+        {
+            printf("Invalid number of levels: %d (must be between 1 and %d)\n", levels, SCHED_MLFQ_MAX_LEVELS);
+            exit(1);
+        }
+        frontend.config.mlfq_levels = levels;
+    }
+}
+
+// The level queues live in libscheduler; the front end runs them on the
+// event-driven simulator.
+int main(int argc, char *argv[])
+{
+    parseArguments(argc, argv);
+    if (!sched_frontend_check(&frontend))
+    {
+        printf("Usage: %s [--levels=N] [--quanta=Q0,Q1,...] [--boost=N] " SCHED_FRONTEND_USAGE "\n", argv[0]);
+        return 1;
+    }
+
+    Scheduler *sched = sched_frontend_create(&frontend);
+    sched_frontend_run(&frontend, sched, NULL);
+    sched_destroy(sched);
+
+    sched_frontend_report(&frontend);
+    return 0;
+}
@@ -0,0 +1,486 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "scheduler.h"
+#include "sched_sim.h"
+#include "sched_workload.h"
+
+#define DEFAULT_REPLICAS 100
+#define MAX_THREADS 64
+#define SLOTS_PER_THREAD 4
+
+// Runs every engine on K random instances of a workload distribution and
+// reports each metric's mean with a 95% confidence interval, and the paired
+// difference from a baseline engine on the same instances.
+
+typedef struct
+{
+    const char *name;
+    SchedPolicy policy;
+} Engine;
+
+static const Engine engines[] = {
+    {"DPS-DTQ", SCHED_POLICY_DPS_DTQ},
+    {"CFS", SCHED_POLICY_CFS},
+    {"Reference", SCHED_POLICY_REFERENCE},
+    {"EDF", SCHED_POLICY_EDF},
+    {"MLFQ", SCHED_POLICY_MLFQ},
+    {"Stride", SCHED_POLICY_STRIDE},
+    {"Lottery", SCHED_POLICY_LOTTERY},
+};
+
+#define ENGINE_COUNT (int)(sizeof(engines) / sizeof(engines[0]))
+
+static const char *metric_names[] = {
+    "Average Turnaround Time",
+    "Average Waiting Time",
+    "Average Response Time",
+    "Throughput",
+    "Fairness Index",
+    "Starvation Count",
+    "Load Balancing Efficiency",
+    "Deadline Misses",
+    "CPU Utilization",
+    "Context Switches",
+    "Makespan",
+};
+
+#define METRIC_COUNT (int)(sizeof(metric_names) / sizeof(metric_names[0]))
+
+typedef double MetricRow[ENGINE_COUNT][METRIC_COUNT];
+
+// Running mean and sum of squared deviations (Welford)
+typedef struct
+{
+    long n;
+    double mean;
+    double m2;
+} RunningStats;
+
+typedef struct
+{
+    // Set before the workers start
+    SchedWorkload workload;
+    SchedSimOptions options;
+    unsigned long seed;
+    long replicas;
+    bool selected[ENGINE_COUNT];
+    int baseline;
+    int window; // Replicas that may be finished but not yet merged
+
+    // Guarded by lock. Rows are merged in replica order whatever order the
+    // workers finish in, so the output does not depend on the thread count.
+    pthread_mutex_t lock;
+    pthread_cond_t merged_one;
+    long next;
+    long merged;
+    int status;
+    long failed; // Replica that set status
+    MetricRow *slots;
+    bool *ready;
+    RunningStats stats[ENGINE_COUNT][METRIC_COUNT];
+    RunningStats diff[ENGINE_COUNT][METRIC_COUNT];
+} Replication;
+
+long monotonicNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+void addSample(RunningStats *stats, double value)
+{
+    stats->n++;
+    double delta = value - stats->mean;
+    stats->mean += delta / stats->n;
+    stats->m2 += delta * (value - stats->mean);
+}
+
+// Two-sided 95% quantile of Student's t with `df` degrees of freedom
+double tQuantile(long df)
+{
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (df <= 30)
+        return table[df - 1];
+
+    // Cornish-Fisher expansion around the normal quantile
+    double z = 1.959964;
+    return z + (z * z * z + z) / (4.0 * df) + (5 * pow(z, 5) + 16 * z * z * z + 3 * z) / (96.0 * df * df);
+}
+
+double halfWidth(const RunningStats *stats)
+{
+    if (stats->n < 2)
+        return 0.0;
+    return tQuantile(stats->n - 1) * sqrt(stats->m2 / (stats->n - 1) / stats->n);
+}
+
+int runEngine(const Replication *rep, int engine, unsigned long seed, SchedTask *tasks, double *row)
+{
+    SchedConfig config;
+    sched_default_config(engines[engine].policy, &config);
+    config.lottery_seed = seed != 0 ? seed : 1;
+
+    Scheduler *sched = sched_create(engines[engine].policy, &config);
+    if (sched == NULL)
+        return -1;
+
+    SchedSimResult sim;
+    SchedMetrics metrics;
+    int status = sched_sim_run_tasks(sched, tasks, rep->workload.processes, NULL, &rep->options, &sim);
+    if (status == 0)
+        sched_metrics(sched, sim.total_time, &metrics);
+    sched_destroy(sched);
+    if (status != 0)
+        return status;
+
+    double values[] = {
+        metrics.avg_turnaround_time,
+        metrics.avg_waiting_time,
+        metrics.avg_response_time,
+        metrics.throughput,
+        metrics.fairness_index,
+        metrics.starvation_count,
+        metrics.load_balancing_efficiency,
+        sim.deadline_misses,
+        sched_sim_utilization(&sim),
+        sim.switches,
+        sim.total_time,
+    };
+    memcpy(row, values, sizeof(values));
+    return 0;
+}
+
+// One instance through every selected engine. `instance` holds the
+// generated tasks and `tasks` a fresh copy for each run.
+int runReplica(const Replication *rep, long replica, SchedTask *instance, SchedTask *tasks, MetricRow row)
+{
+    unsigned long seed = (rep->seed << 32) ^ (unsigned long)replica;
+    int n = rep->workload.processes;
+
+    if (sched_workload_generate(&rep->workload, seed, instance) != 0)
+        return -1;
+
+    for (int e = 0; e < ENGINE_COUNT; e++)
+    {
+        if (!rep->selected[e])
+            continue;
+        memcpy(tasks, instance, sizeof(SchedTask) * n);
+        int status = runEngine(rep, e, seed, tasks, row[e]);
+        if (status != 0)
+            return status;
+    }
+    return 0;
+}
+
+// Called with the lock held
+void mergeRow(Replication *rep, MetricRow row)
+{
+    for (int e = 0; e < ENGINE_COUNT; e++)
+    {
+        if (!rep->selected[e])
+            continue;
+        for (int m = 0; m < METRIC_COUNT; m++)
+        {
+            addSample(&rep->stats[e][m], row[e][m]);
+            if (e != rep->baseline)
+                addSample(&rep->diff[e][m], row[e][m] - row[rep->baseline][m]);
+        }
+    }
+}
+
+void *workerMain(void *data)
+{
+    Replication *rep = data;
+    int n = rep->workload.processes;
+    SchedTask *instance = malloc(sizeof(SchedTask) * n);
+    SchedTask *tasks = malloc(sizeof(SchedTask) * n);
+    int status = instance != NULL && tasks != NULL ? 0 : -1;
+    long replica = -1;
+
+    while (status == 0)
+    {
+        // Wait for room in the window so a slow replica cannot let the
+        // finished ones pile up
+        pthread_mutex_lock(&rep->lock);
+        while (rep->status == 0 && rep->next < rep->replicas && rep->next >= rep->merged + rep->window)
+            pthread_cond_wait(&rep->merged_one, &rep->lock);
+        if (rep->status != 0 || rep->next >= rep->replicas)
+        {
+            pthread_mutex_unlock(&rep->lock);
+            break;
+        }
+        replica = rep->next++;
+        pthread_mutex_unlock(&rep->lock);
+
+        MetricRow row;
+        status = runReplica(rep, replica, instance, tasks, row);
+
+        pthread_mutex_lock(&rep->lock);
+        if (status == 0)
+        {
+            int slot = replica % rep->window;
+            memcpy(rep->slots[slot], row, sizeof(MetricRow));
+            rep->ready[slot] = true;
+            while (rep->ready[rep->merged % rep->window])
+            {
+                slot = rep->merged % rep->window;
+                mergeRow(rep, rep->slots[slot]);
+                rep->ready[slot] = false;
+                rep->merged++;
+            }
+        }
+        pthread_cond_broadcast(&rep->merged_one);
+        pthread_mutex_unlock(&rep->lock);
+    }
+
+    if (status != 0)
+    {
+        pthread_mutex_lock(&rep->lock);
+        if (rep->status == 0)
+        {
+            rep->status = status;
+            rep->failed = replica;
+        }
+        pthread_cond_broadcast(&rep->merged_one);
+        pthread_mutex_unlock(&rep->lock);
+    }
+    free(instance);
+    free(tasks);
+    return NULL;
+}
+
+void displayResults(const Replication *rep)
+{
+    const char *baseline = engines[rep->baseline].name;
+    printf("Engine,Metric,Mean,CI95 Low,CI95 High,Diff vs %s,Diff CI95 Low,Diff CI95 High\n", baseline);
+
+    for (int e = 0; e < ENGINE_COUNT; e++)
+    {
+        if (!rep->selected[e])
+            continue;
+        for (int m = 0; m < METRIC_COUNT; m++)
+        {
+            const RunningStats *stats = &rep->stats[e][m];
+            double half = halfWidth(stats);
+            printf("%s,%s,%.4f,%.4f,%.4f", engines[e].name, metric_names[m],
+                   stats->mean, stats->mean - half, stats->mean + half);
+
+            if (e == rep->baseline)
+            {
+                printf(",,,\n");
+                continue;
+            }
+            const RunningStats *diff = &rep->diff[e][m];
+            half = halfWidth(diff);
+            printf(",%.4f,%.4f,%.4f\n", diff->mean, diff->mean - half, diff->mean + half);
+        }
+    }
+}
+
+int findEngine(const char *name, size_t length)
+{
+    for (int e = 0; e < ENGINE_COUNT; e++)
+    {
+        if (strlen(engines[e].name) == length && strncmp(engines[e].name, name, length) == 0)
+            return e;
+    }
+    return -1;
+}
+
+// --engines=NAME[,NAME...]
+bool parseEngines(const char *list, bool *selected)
+{
+    memset(selected, 0, sizeof(bool) * ENGINE_COUNT);
+    for (;;)
+    {
+        size_t length = strcspn(list, ",");
+        int e = findEngine(list, length);
+        if (e < 0)
+            return false;
+        selected[e] = true;
+        if (list[length] == '\0')
+            return true;
+        list += length + 1;
+    }
+}
+
+void loadTopology(const char *filename, SchedTopology *topology)
+{
+    FILE *file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("Error opening topology file %s\n", filename);
+        exit(1);
+    }
+
+    int line_number;
+    if (sched_topology_read(file, topology, &line_number) != 0)
+    {
+        if (line_number > 0)
+            printf("Invalid topology line %d in %s\n", line_number, filename);
+        else
+            printf("Topology %s must list CPUs 0 to n-1\n", filename);
+        fclose(file);
+        exit(1);
+    }
+    fclose(file);
+}
+
+int main(int argc, char *argv[])
+{
+    static Replication rep;
+    static SchedTopology topology;
+    const char *input = NULL;
+    const char *baseline = "DPS-DTQ";
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    sched_sim_default_options(&rep.options);
+    rep.replicas = DEFAULT_REPLICAS;
+    rep.seed = 1;
+    for (int e = 0; e < ENGINE_COUNT; e++)
+        rep.selected[e] = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--replicas=", 11) == 0)
+            rep.replicas = atol(argv[i] + 11);
+        else if (strncmp(argv[i], "--threads=", 10) == 0)
+            threads = atol(argv[i] + 10);
+        else if (strncmp(argv[i], "--seed=", 7) == 0)
+            rep.seed = strtoul(argv[i] + 7, NULL, 10);
+        else if (strncmp(argv[i], "--engines=", 10) == 0)
+        {
+            if (!parseEngines(argv[i] + 10, rep.selected))
+            {
+                printf("Unknown engine in %s\n", argv[i] + 10);
+                return 1;
+            }
+        }
+        else if (strncmp(argv[i], "--baseline=", 11) == 0)
+            baseline = argv[i] + 11;
+        else if (strncmp(argv[i], "--switch-cost=", 14) == 0)
+            rep.options.switch_cost = atoi(argv[i] + 14);
+        else if (strncmp(argv[i], "--cache-penalty=", 16) == 0)
+            rep.options.cache_penalty = atoi(argv[i] + 16);
+        else if (strncmp(argv[i], "--cache-decay=", 14) == 0)
+            rep.options.cache_decay = atoi(argv[i] + 14);
+        else if (strncmp(argv[i], "--topology=", 11) == 0)
+        {
+            loadTopology(argv[i] + 11, &topology);
+            rep.options.topology = &topology;
+        }
+        else if (strncmp(argv[i], "--", 2) == 0)
+        {
+            printf("Unknown option %s\n", argv[i]);
+            return 1;
+        }
+        else
+            input = argv[i];
+    }
+
+    if (input == NULL)
+    {
+        printf("Usage: %s [--replicas=K] [--threads=N] [--seed=S] [--engines=A,B,...] [--baseline=ENGINE] "
+               "[--switch-cost=N] [--cache-penalty=N] [--cache-decay=N] [--topology=FILE] <workload_spec>\n",
+               argv[0]);
+        return 1;
+    }
+    if (rep.replicas < 2)
+    {
+        printf("A confidence interval needs at least 2 replicas\n");
+        return 1;
+    }
+    rep.baseline = findEngine(baseline, strlen(baseline));
+    if (rep.baseline < 0 || !rep.selected[rep.baseline])
+    {
+        printf("The baseline %s must be one of the engines run\n", baseline);
+        return 1;
+    }
+    if (threads < 1)
+        threads = 1;
+    if (threads > MAX_THREADS)
+        threads = MAX_THREADS;
+    if (threads > rep.replicas)
+        threads = rep.replicas;
+
+    FILE *file = fopen(input, "r");
+    if (file == NULL)
+    {
+        printf("Error opening file %s\n", input);
+        return 1;
+    }
+    int line_number;
+    if (sched_workload_read(file, &rep.workload, &line_number) != 0)
+    {
+        printf("Invalid workload line %d in %s\n", line_number, input);
+        fclose(file);
+        return 1;
+    }
+    fclose(file);
+
+    // Memory is threads * (2 instances + SLOTS_PER_THREAD rows), whatever K is
+    rep.window = threads * SLOTS_PER_THREAD;
+    rep.slots = calloc(rep.window, sizeof(MetricRow));
+    rep.ready = calloc(rep.window, sizeof(bool));
+    pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+    if (rep.slots == NULL || rep.ready == NULL || workers == NULL)
+    {
+        printf("Out of memory\n");
+        return 1;
+    }
+    pthread_mutex_init(&rep.lock, NULL);
+    pthread_cond_init(&rep.merged_one, NULL);
+
+    long start_ns = monotonicNs();
+    int started = 0;
+    for (; started < threads; started++)
+    {
+        if (pthread_create(&workers[started], NULL, workerMain, &rep) != 0)
+            break;
+    }
+    if (started == 0)
+    {
+        rep.status = -1;
+        rep.failed = -1;
+    }
+    for (int i = 0; i < started; i++)
+        pthread_join(workers[i], NULL);
+    long elapsed_ns = monotonicNs() - start_ns;
+
+    int status = 0;
+    if (rep.status != 0)
+    {
+        if (rep.failed >= 0)
+            printf("Replica %ld failed: the workload is too long to simulate, or memory ran out\n", rep.failed);
+        else
+            printf("Out of memory\n");
+        status = 1;
+    }
+    else
+    {
+        displayResults(&rep);
+        fprintf(stderr, "Replicas,%ld\n", rep.replicas);
+        fprintf(stderr, "Processes per Replica,%d\n", rep.workload.processes);
+        fprintf(stderr, "Threads,%d\n", started);
+        fprintf(stderr, "Wall Time (s),%.3f\n", elapsed_ns / 1e9);
+    }
+
+    pthread_cond_destroy(&rep.merged_one);
+    pthread_mutex_destroy(&rep.lock);
+    free(workers);
+    free(rep.slots);
+    free(rep.ready);
+    return status;
+}
@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "scheduler.h"
+#include "sched_intake.h"
+#include "sched_pool.h"
+
+#define DEFAULT_ROUNDS 200
+#define SMALL_INTAKE 8
+#define DRAIN_BATCH 4
+#define ROUND_TIMEOUT_S 20
+
+// Stress test for the intake ring and the thread pool. Every round checks
+// that each task comes out exactly once, and a round that does not finish
+// within ROUND_TIMEOUT_S, such as a pool waiting on a lost wakeup, fails the
+// run. Exits 1 on the first failure.
+
+typedef struct
+{
+    SchedIntake *intake;
+    SchedTask *tasks;
+    int first;
+    int count;
+} IntakeProducer;
+
+typedef struct
+{
+    SchedIntake *intake;
+    Scheduler *sched;
+    atomic_int producers_left;
+    long completed;
+} IntakeConsumer;
+
+typedef struct
+{
+    SchedPool *pool;
+    SchedTask *tasks;
+    struct PoolItemState *items;
+    int first;
+    int count;
+    int failed_submits;
+} PoolProducer;
+
+typedef struct PoolItemState
+{
+    int calls_needed;
+    atomic_int calls;
+    atomic_int finished;
+} PoolItemState;
+
+void onTimeout(int signal)
+{
+    (void)signal;
+    static const char message[] = "Round timed out: a task was lost or a worker never woke\n";
+    write(STDOUT_FILENO, message, sizeof(message) - 1);
+    _exit(1);
+}
+
+void *intakeProducerMain(void *data)
+{
+    IntakeProducer *args = data;
+
+    for (int i = args->first; i < args->first + args->count; i++)
+    {
+        while (!sched_intake_push(args->intake, &args->tasks[i]))
+            sched_yield();
+    }
+    return NULL;
+}
+
+void *intakeConsumerMain(void *data)
+{
+    IntakeConsumer *state = data;
+
+    for (;;)
+    {
+        // Read before draining, so the last pushes are drained after it
+        bool last = atomic_load(&state->producers_left) == 0;
+        if (sched_intake_drain(state->intake, state->sched, DRAIN_BATCH, NULL, NULL) == 0)
+            sched_yield();
+
+        SchedTask *task;
+        while ((task = sched_pick_next(state->sched, 0)) != NULL)
+        {
+            int requeued = sched_charge(state->sched, task, task->slice);
+            if (requeued < 0)
+            {
+                printf("Intake: failed to requeue task %d\n", task->id);
+                exit(1);
+            }
+            if (requeued == 0)
+            {
+                sched_complete(state->sched, task, 0);
+                state->completed++;
+            }
+        }
+
+        if (last && sched_intake_empty(state->intake))
+            break;
+    }
+    return NULL;
+}
+
+// Producers push through a ring far smaller than the round, so they keep
+// wrapping it and waiting on the consumer
+bool intakeRound(int producers, int per_producer)
+{
+    int total = producers * per_producer;
+    SchedTask *tasks = calloc(total, sizeof(SchedTask));
+    IntakeProducer *args = calloc(producers, sizeof(IntakeProducer));
+    pthread_t *threads = malloc(sizeof(pthread_t) * producers);
+    IntakeConsumer state;
+    state.intake = sched_intake_create(SMALL_INTAKE);
+    state.sched = sched_create(SCHED_POLICY_CFS, NULL);
+    state.completed = 0;
+    atomic_init(&state.producers_left, producers);
+    if (tasks == NULL || args == NULL || threads == NULL || state.intake == NULL || state.sched == NULL)
+    {
+        printf("Out of memory\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < total; i++)
+    {
+        tasks[i].id = i + 1;
+        tasks[i].burst_time = 1 + i % 3;
+        tasks[i].criticality = 1 + i % 10;
+    }
+
+    pthread_t consumer;
+    pthread_create(&consumer, NULL, intakeConsumerMain, &state);
+    for (int p = 0; p < producers; p++)
+    {
+        args[p].intake = state.intake;
+        args[p].tasks = tasks;
+        args[p].first = p * per_producer;
+        args[p].count = per_producer;
+        pthread_create(&threads[p], NULL, intakeProducerMain, &args[p]);
+    }
+    for (int p = 0; p < producers; p++)
+    {
+        pthread_join(threads[p], NULL);
+        atomic_fetch_sub(&state.producers_left, 1);
+    }
+    pthread_join(consumer, NULL);
+
+    bool ok = state.completed == total;
+    for (int i = 0; i < total && ok; i++)
+        ok = tasks[i].completed;
+    if (!ok)
+        printf("Intake: %ld of %d tasks came out, or one came out twice\n", state.completed, total);
+
+    sched_destroy(state.sched);
+    sched_intake_destroy(state.intake);
+    free(tasks);
+    free(args);
+    free(threads);
+    return ok;
+}
+
+bool stressWork(void *arg, long budget_ns)
+{
+    PoolItemState *item = arg;
+    (void)budget_ns;
+
+    if (atomic_fetch_add(&item->calls, 1) + 1 < item->calls_needed)
+        return false;
+    atomic_fetch_add(&item->finished, 1);
+    return true;
+}
+
+void *poolProducerMain(void *data)
+{
+    PoolProducer *args = data;
+
+    for (int i = args->first; i < args->first + args->count; i++)
+    {
+        if (sched_pool_submit(args->pool, &args->tasks[i], stressWork, &args->items[i]) != 0)
+            args->failed_submits++;
+    }
+    return NULL;
+}
+
+// One submit-and-wait cycle on a fresh pool. Small rounds leave the workers
+// parked between submits, which is where a lost wakeup would hang the wait.
+// Under EDF with admission control some tasks are refused, and those must
+// still count as done.
+bool poolRound(int workers, int producers, int per_producer, bool edf)
+{
+    int total = producers * per_producer;
+    SchedTask *tasks = calloc(total, sizeof(SchedTask));
+    PoolItemState *items = calloc(total, sizeof(PoolItemState));
+    PoolProducer *args = calloc(producers, sizeof(PoolProducer));
+    pthread_t *threads = malloc(sizeof(pthread_t) * producers);
+
+    SchedConfig config;
+    SchedPolicy policy = edf ? SCHED_POLICY_EDF : SCHED_POLICY_DPS_DTQ;
+    sched_default_config(policy, &config);
+    config.admission = SCHED_ADMIT_REJECT;
+    SchedPool *pool = sched_pool_create(policy, &config, workers, 1000);
+    if (tasks == NULL || items == NULL || args == NULL || threads == NULL || pool == NULL)
+    {
+        printf("Out of memory\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < total; i++)
+    {
+        tasks[i].id = i + 1;
+        tasks[i].burst_time = 1 + i % 4;
+        tasks[i].criticality = 1 + i % 10;
+        tasks[i].system_priority = 1 + i % 10;
+        if (edf)
+            tasks[i].deadline = 2 + i % 5;
+        items[i].calls_needed = 1 + i % 3;
+        atomic_init(&items[i].calls, 0);
+        atomic_init(&items[i].finished, 0);
+    }
+
+    for (int p = 0; p < producers; p++)
+    {
+        args[p].pool = pool;
+        args[p].tasks = tasks;
+        args[p].items = items;
+        args[p].first = p * per_producer;
+        args[p].count = per_producer;
+        pthread_create(&threads[p], NULL, poolProducerMain, &args[p]);
+    }
+
+    int failed_submits = 0;
+    for (int p = 0; p < producers; p++)
+    {
+        pthread_join(threads[p], NULL);
+        failed_submits += args[p].failed_submits;
+    }
+    sched_pool_wait(pool);
+
+    SchedPoolStats stats;
+    sched_pool_stats(pool, &stats);
+    sched_pool_destroy(pool);
+
+    long finished = 0;
+    bool ok = failed_submits == 0 && stats.completed + stats.rejected == total;
+    for (int i = 0; i < total; i++)
+    {
+        int times = atomic_load(&items[i].finished);
+        finished += times;
+        if (times > 1 || (times == 1) == tasks[i].rejected)
+            ok = false;
+    }
+    ok = ok && finished == stats.completed;
+    if (!ok)
+        printf("Pool: %ld completed and %ld rejected of %d, %ld finished, %d failed submits\n",
+               stats.completed, stats.rejected, total, finished, failed_submits);
+
+    free(tasks);
+    free(items);
+    free(args);
+    free(threads);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : DEFAULT_ROUNDS;
+    if (rounds < 1)
+    {
+        printf("Usage: %s [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    signal(SIGALRM, onTimeout);
+
+    printf("Test,Rounds\n");
+    for (int round = 0; round < rounds; round++)
+    {
+        alarm(ROUND_TIMEOUT_S);
+        if (!intakeRound(1 + round % 4, 500))
+            return 1;
+    }
+    printf("Intake,%d\n", rounds);
+
+    for (int round = 0; round < rounds; round++)
+    {
+        alarm(ROUND_TIMEOUT_S);
+        int workers = 1 + round % 4;
+        bool edf = round % 2 == 1;
+        // Mostly tiny rounds, so workers park and wake between them
+        int per_producer = round % 8 == 0 ? 200 : 1 + round % 3;
+        if (!poolRound(workers, 1 + round % 3, per_producer, edf))
+            return 1;
+    }
+    alarm(0);
+    printf("Pool,%d\n", rounds);
+
+    return 0;
+}
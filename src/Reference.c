@@ -4,6 +4,11 @@
 #include <math.h>
 #include <time.h>
 
+#include "scheduler.h"
+#include "sched_sim.h"
+
+#define MAX_LINE_LENGTH 256
+
 typedef struct
 {
     int pid;
@@ -18,102 +23,12 @@ typedef struct
     int start_time;
     int completion_time;
     int in_ready_queue;
+    int group;
+    SchedIoPhases io;
+    SchedCriticalSections sections;
+    SchedPredecessors after;
 } Process;
 
-typedef struct
-{
-    Process *processes;
-    int size;
-    int capacity;
-} ReadyQueue;
-
-ReadyQueue *createReadyQueue(int capacity)
-{
-    ReadyQueue *queue = (ReadyQueue *)malloc(sizeof(ReadyQueue));
-    queue->processes = (Process *)malloc(sizeof(Process) * capacity);
-    queue->size = 0;
-    queue->capacity = capacity;
-    return queue;
-}
-
-void addToReadyQueue(ReadyQueue *queue, Process process)
-{
-    if (queue->size < queue->capacity)
-    {
-        queue->processes[queue->size] = process;
-        queue->size++;
-    }
-    else
-    {
-        printf("Ready queue is full\n");
-    }
-}
-
-Process removeFromReadyQueue(ReadyQueue *queue, int index)
-{
-    Process process = queue->processes[index];
-
-    for (int i = index; i < queue->size - 1; i++)
-    {
-        queue->processes[i] = queue->processes[i + 1];
-    }
-
-    queue->size--;
-    return process;
-}
-
-int compareRemainingTime(const void *a, const void *b)
-{
-    Process *p1 = (Process *)a;
-    Process *p2 = (Process *)b;
-    return p1->remaining_time - p2->remaining_time;
-}
-
-float median(int arr[], int n)
-{
-    int *temp = (int *)malloc(sizeof(int) * n);
-    for (int i = 0; i < n; i++)
-    {
-        temp[i] = arr[i];
-    }
-
-    for (int i = 0; i < n; i++)
-    {
-        for (int j = i + 1; j < n; j++)
-        {
-            if (temp[i] > temp[j])
-            {
-                int t = temp[i];
-                temp[i] = temp[j];
-                temp[j] = t;
-            }
-        }
-    }
-
-    float med;
-    if (n % 2 == 0)
-    {
-        med = (temp[n / 2] + temp[n / 2 - 1]) / 2.0;
-    }
-    else
-    {
-        med = temp[n / 2];
-    }
-
-    free(temp);
-    return med;
-}
-
-float mean(int arr[], int n)
-{
-    int sum = 0;
-    for (int i = 0; i < n; i++)
-    {
-        sum += arr[i];
-    }
-    return (float)sum / n;
-}
-
 float calculateFairnessIndex(Process processes[], int n)
 {
     float sum_squared = 0;
@@ -121,7 +36,8 @@ float calculateFairnessIndex(Process processes[], int n)
 
     for (int i = 0; i < n; i++)
     {
-        int waiting_time = processes[i].completion_time - processes[i].arrival_time - processes[i].burst_time;
+        int waiting_time = processes[i].completion_time - processes[i].arrival_time -
+                           processes[i].burst_time - sched_io_time(&processes[i].io);
         float normalized_wait = (float)(waiting_time + 1) / (processes[i].burst_time + 1);
         sum_squared += normalized_wait;
         squared_sum += normalized_wait * normalized_wait;
@@ -155,18 +71,111 @@ float calculateLoadBalancingEfficiency(Process processes[], int n, int total_tim
     return (float)total_busy_time / total_time;
 }
 
+// Completed jobs of periodic tasks, which take the place of the task itself
+// in the metrics
+typedef struct
+{
+    Process *jobs;
+    int size;
+    int capacity;
+} JobLog;
+
+void logJob(void *ctx, SchedTask *task)
+{
+    JobLog *log = (JobLog *)ctx;
+    if (task->origin == NULL)
+        return;
+
+    if (log->size == log->capacity)
+    {
+        int capacity = log->capacity ? log->capacity * 2 : 64;
+        Process *jobs = (Process *)realloc(log->jobs, sizeof(Process) * capacity);
+        if (jobs == NULL)
+        {
+            printf("Out of memory\n");
+            exit(1);
+        }
+        log->jobs = jobs;
+        log->capacity = capacity;
+    }
+
+    Process *job = &log->jobs[log->size++];
+    job->pid = task->id;
+    job->arrival_time = task->arrival_time;
+    job->burst_time = task->burst_time;
+    job->deadline = task->deadline;
+    job->criticality = task->criticality;
+    job->period = task->period;
+    job->nice = task->system_priority;
+    job->remaining_time = task->remaining_burst;
+    job->completed = task->completed;
+    job->start_time = task->first_execution_time;
+    job->completion_time = task->completion_time;
+    job->in_ready_queue = 0;
+    job->group = task->group;
+    job->io = task->io;
+    job->sections = task->sections;
+}
+
 int main(int argc, char *argv[])
 {
-    if (argc != 2)
+    SchedSimOptions options;
+    SchedConfig config;
+    const char *input = NULL;
+    int bad_arguments = 0;
+    bool show_job_stats = false;
+    sched_sim_default_options(&options);
+    sched_default_config(SCHED_POLICY_REFERENCE, &config);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--horizon=", 10) == 0)
+            options.horizon = atoi(argv[i] + 10);
+        else if (strcmp(argv[i], "--one-shot") == 0)
+            options.release_periodic = false;
+        else if (strcmp(argv[i], "--job-stats") == 0)
+            show_job_stats = true;
+        else if (strcmp(argv[i], "--class-stats") == 0)
+            config.class_metrics = true;
+        else if (strncmp(argv[i], "--switch-cost=", 14) == 0)
+            options.switch_cost = atoi(argv[i] + 14);
+        else if (strncmp(argv[i], "--cache-penalty=", 16) == 0)
+            options.cache_penalty = atoi(argv[i] + 16);
+        else if (strncmp(argv[i], "--cache-decay=", 14) == 0)
+            options.cache_decay = atoi(argv[i] + 14);
+        else if (strncmp(argv[i], "--decision-log=", 15) == 0)
+        {
+            options.decision_log = fopen(argv[i] + 15, "wb");
+            if (options.decision_log == NULL)
+            {
+                printf("Error creating decision log %s\n", argv[i] + 15);
+                return 1;
+            }
+        }
+        else if (strncmp(argv[i], "--checkpoint", 12) == 0 || strncmp(argv[i], "--resume=", 9) == 0 ||
+                 strncmp(argv[i], "--what-if=", 10) == 0)
+        {
+            // The metrics below need every job's record, and a resumed run
+            // would lack those of the jobs done before the checkpoint
+            printf("%s: the reference engine does not take checkpoints\n", argv[i]);
+            return 1;
+        }
+        else if (strncmp(argv[i], "--", 2) == 0 || input != NULL)
+            bad_arguments = 1;
+        else
+            input = argv[i];
+    }
+
+    if (input == NULL || bad_arguments)
     {
-        printf("Usage: %s <input_file>\n", argv[0]);
+        printf("Usage: %s [--horizon=N] [--one-shot] [--job-stats] [--class-stats] [--switch-cost=N] [--cache-penalty=N] [--cache-decay=N] [--decision-log=FILE] <input_file>\n", argv[0]);
         return 1;
     }
 
-    FILE *file = fopen(argv[1], "r");
+    FILE *file = fopen(input, "r");
     if (file == NULL)
     {
-        printf("Error opening file: %s\n", argv[1]);
+        printf("Error opening file: %s\n", input);
         return 1;
     }
 
@@ -197,6 +206,28 @@ int main(int argc, char *argv[])
             return 1;
         }
 
+        char phases[MAX_LINE_LENGTH];
+        int status = sched_read_line(file, phases, sizeof(phases));
+        if (status == SCHED_LINE_TOO_LONG)
+        {
+            printf("Over-long line for process %d\n", i + 1);
+            fclose(file);
+            free(processes);
+            return 1;
+        }
+        if (status == 0)
+            phases[0] = '\0';
+        int io_work = sched_parse_extensions(phases, &processes[i].io, &processes[i].group, &processes[i].sections,
+                                             &processes[i].after);
+        if (io_work < 0)
+        {
+            printf("Error reading process information\n");
+            fclose(file);
+            free(processes);
+            return 1;
+        }
+        processes[i].burst_time += io_work;
+
         processes[i].remaining_time = processes[i].burst_time;
         processes[i].completed = 0;
         processes[i].start_time = -1;
@@ -206,91 +237,101 @@ int main(int argc, char *argv[])
 
     fclose(file);
 
-    ReadyQueue *ready_queue = createReadyQueue(n);
-
-    int current_time = 0;
-    int completed_processes = 0;
-
-    while (completed_processes < n)
+    // SRPT with the mean/median quantum now lives in libscheduler and runs
+    // on the event-driven simulator
+    Scheduler *sched = sched_create(SCHED_POLICY_REFERENCE, &config);
+    SchedTask *tasks = (SchedTask *)calloc(n, sizeof(SchedTask));
+    if (sched == NULL || tasks == NULL)
     {
-        for (int i = 0; i < n; i++)
-        {
-            if (processes[i].arrival_time <= current_time &&
-                !processes[i].in_ready_queue &&
-                !processes[i].completed)
-            {
-                addToReadyQueue(ready_queue, processes[i]);
-                processes[i].in_ready_queue = 1;
-
-                Process *proc = &processes[i];
-                proc->in_ready_queue = 1;
-            }
-        }
-
-        if (ready_queue->size > 0)
-        {
-            qsort(ready_queue->processes, ready_queue->size, sizeof(Process), compareRemainingTime);
-
-            int bt_list[ready_queue->size];
-            for (int i = 0; i < ready_queue->size; i++)
-            {
-                bt_list[i] = ready_queue->processes[i].remaining_time;
-            }
-
-            float mean_bt = mean(bt_list, ready_queue->size);
-            float median_bt = median(bt_list, ready_queue->size);
-            int time_quantum = (int)((mean_bt + median_bt) / 2);
-
-            if (time_quantum < 1)
-                time_quantum = 1;
-
-            Process current_process = removeFromReadyQueue(ready_queue, 0);
+        printf("Failed to create scheduler\n");
+        free(processes);
+        return 1;
+    }
 
-            int idx = -1;
-            for (int i = 0; i < n; i++)
-            {
-                if (processes[i].pid == current_process.pid)
-                {
-                    idx = i;
-                    break;
-                }
-            }
+    for (int i = 0; i < n; i++)
+    {
+        tasks[i].id = processes[i].pid;
+        tasks[i].arrival_time = processes[i].arrival_time;
+        tasks[i].burst_time = processes[i].burst_time;
+        tasks[i].deadline = processes[i].deadline;
+        tasks[i].criticality = processes[i].criticality;
+        tasks[i].period = processes[i].period;
+        tasks[i].system_priority = processes[i].nice;
+        tasks[i].group = processes[i].group;
+        tasks[i].io = processes[i].io;
+        tasks[i].sections = processes[i].sections;
+        tasks[i].after = processes[i].after;
+    }
 
-            if (idx == -1)
-            {
-                printf("Error: Process not found in original array\n");
-                continue;
-            }
+    JobLog log = {NULL, 0, 0};
+    SchedSimHooks hooks = {NULL, logJob, NULL, &log};
+    SchedSimResult result;
+    int status = sched_sim_run_tasks(sched, tasks, n, &hooks, &options, &result);
+    if (status != 0)
+    {
+        if (status == SCHED_SIM_BAD_PRECEDENCE)
+            printf("Predecessors must name other aperiodic processes by a unique id, without cycles\n");
+        else
+            printf("Simulation failed\n");
+        free(processes);
+        free(tasks);
+        free(log.jobs);
+        sched_destroy(sched);
+        return 1;
+    }
 
-            if (processes[idx].start_time == -1)
-            {
-                processes[idx].start_time = current_time;
-            }
+    // Aperiodic processes keep their input order; periodic ones are replaced
+    // by their jobs in completion order
+    int current_time = result.total_time;
+    int kept = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (options.release_periodic && processes[i].period > 0)
+            continue;
+
+        processes[kept] = processes[i];
+        processes[kept].arrival_time = tasks[i].arrival_time;
+        processes[kept].remaining_time = tasks[i].remaining_burst;
+        processes[kept].completed = tasks[i].completed;
+        processes[kept].start_time = tasks[i].first_execution_time;
+        processes[kept].completion_time = tasks[i].completion_time;
+        kept++;
+    }
 
-            if (current_process.remaining_time <= time_quantum)
-            {
-                current_time += current_process.remaining_time;
-                processes[idx].remaining_time = 0;
-                processes[idx].completed = 1;
-                processes[idx].completion_time = current_time;
-                processes[idx].in_ready_queue = 0;
-                completed_processes++;
-            }
-            else
-            {
-                current_time += time_quantum;
-                processes[idx].remaining_time -= time_quantum;
+    // The class and job tables use the shared definitions, as the other
+    // engines print them
+    SchedMetrics lock_metrics;
+    sched_metrics(sched, current_time, &lock_metrics);
+    SchedClassStats *classes;
+    int class_count = sched_class_table(sched, &classes);
+    sched_destroy(sched);
+
+    int task_count = n;
+    n = kept + log.size;
+    if (n == 0 || class_count < 0)
+    {
+        printf(class_count < 0 ? "Out of memory\n" : "No jobs were released before the horizon\n");
+        free(processes);
+        free(tasks);
+        free(classes);
+        free(log.jobs);
+        return 1;
+    }
 
-                processes[idx].in_ready_queue = 0;
-                addToReadyQueue(ready_queue, processes[idx]);
-                processes[idx].in_ready_queue = 1;
-            }
-        }
-        else
-        {
-            current_time++;
-        }
+    Process *all = (Process *)realloc(processes, sizeof(Process) * n);
+    if (all == NULL)
+    {
+        printf("Out of memory\n");
+        free(processes);
+        free(tasks);
+        free(classes);
+        free(log.jobs);
+        return 1;
     }
+    processes = all;
+    if (log.size > 0)
+        memcpy(&processes[kept], log.jobs, sizeof(Process) * log.size);
+    free(log.jobs);
 
     float total_turnaround_time = 0;
     float total_waiting_time = 0;
@@ -299,7 +340,7 @@ int main(int argc, char *argv[])
     for (int i = 0; i < n; i++)
     {
         int turnaround_time = processes[i].completion_time - processes[i].arrival_time;
-        int waiting_time = turnaround_time - processes[i].burst_time;
+        int waiting_time = turnaround_time - processes[i].burst_time - sched_io_time(&processes[i].io);
         int response_time = processes[i].start_time - processes[i].arrival_time;
 
         total_turnaround_time += turnaround_time;
@@ -323,10 +364,45 @@ int main(int argc, char *argv[])
     printf("Fairness Index,%.2f\n", fairness_index);
     printf("Starvation Count,%d\n", starvation_count);
     printf("Load Balancing Efficiency,%.2f\n", load_balancing_efficiency);
+    printf("Deadline Misses,%ld\n", result.deadline_misses);
+    bool cost_model = options.switch_cost > 0 || options.cache_penalty > 0;
+    if (cost_model)
+    {
+        printf("Context Switches,%ld\n", result.switches);
+        printf("Switch Overhead,%ld\n", result.switch_time);
+    }
+    if (cost_model || result.io_waits > 0)
+        printf("CPU Utilization,%.2f\n", sched_sim_utilization(&result));
+    if (result.io_waits > 0)
+        printf("I/O Waits,%ld\n", result.io_waits);
+    if (lock_metrics.locks_taken > 0)
+    {
+        printf("Locks Taken,%ld\n", lock_metrics.locks_taken);
+        printf("Lock Waits,%ld\n", lock_metrics.lock_waits);
+        printf("Lock Wait Time,%ld\n", lock_metrics.lock_wait_time);
+        printf("Priority Inversion Time,%ld\n", lock_metrics.inversion_time);
+        printf("Longest Priority Inversion,%d\n", lock_metrics.max_inversion);
+        printf("High-Criticality Avg Turnaround Time,%.2f\n", lock_metrics.avg_critical_turnaround);
+    }
+    if (result.edges > 0)
+    {
+        printf("Precedence Edges,%ld\n", result.edges);
+        printf("Makespan,%d\n", result.total_time);
+    }
+    if (config.class_metrics)
+    {
+        printf("\n");
+        sched_write_class_stats(stdout, classes, class_count);
+    }
+    if (show_job_stats)
+    {
+        printf("\n");
+        sched_write_job_stats(stdout, tasks, task_count, false);
+    }
 
     free(processes);
-    free(ready_queue->processes);
-    free(ready_queue);
+    free(tasks);
+    free(classes);
 
     return 0;
 }
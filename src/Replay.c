@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "scheduler.h"
+#include "sched_log.h"
+
+// Sums over the completions of one log, in the order the simulator made them
+typedef struct
+{
+    long completed;
+    long rejected;
+    long missed;
+    long starved;
+    double sum_turnaround;
+    double sum_sq_turnaround;
+    double sum_waiting;
+    double sum_sq_waiting;
+    double sum_response;
+    double sum_slowdown;
+    int max_waiting;
+    long critical_completed;
+    double sum_critical_turnaround;
+
+    long slices;
+    long busy_time;
+    int total_time;
+    int cpus;
+    bool ended;
+
+    // Percentiles from fixed histograms, so memory does not grow with the
+    // logs
+    SchedHistogram response;
+    SchedHistogram turnaround;
+} Replay;
+
+long monotonicNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+void addCompletion(Replay *replay, const SchedLogRecord *record)
+{
+    // The same sums, in the same order, as the scheduler's own metrics
+    int turnaround = record->turnaround_time;
+    int waiting = turnaround - record->burst_time - record->blocked_time;
+    sched_histogram_add(&replay->response, record->response_time);
+    sched_histogram_add(&replay->turnaround, turnaround);
+    replay->completed++;
+    replay->sum_turnaround += turnaround;
+    replay->sum_sq_turnaround += (double)turnaround * turnaround;
+    replay->sum_waiting += waiting;
+    replay->sum_sq_waiting += (double)waiting * waiting;
+    replay->sum_response += record->response_time;
+    if (waiting > SCHED_STARVATION_THRESHOLD)
+        replay->starved++;
+    if (record->criticality >= SCHED_HIGH_CRITICALITY)
+    {
+        replay->critical_completed++;
+        replay->sum_critical_turnaround += turnaround;
+    }
+
+    if (replay->completed == 1 || waiting > replay->max_waiting)
+        replay->max_waiting = waiting;
+    if (record->burst_time > 0)
+        replay->sum_slowdown += (double)turnaround / record->burst_time;
+    if (record->missed)
+        replay->missed++;
+}
+
+// Scans one log. Returns 0, or -1 with a message printed.
+int replayLog(FILE *file, const char *path, Replay *replay)
+{
+    SchedLog log;
+    SchedLogRecord record;
+    int status;
+
+    if (sched_log_open(&log, file) != 0)
+    {
+        printf("%s is not a decision log\n", path);
+        return -1;
+    }
+
+    while ((status = sched_log_read(&log, &record)) > 0)
+    {
+        switch (record.type)
+        {
+        case SCHED_LOG_SLICE:
+            replay->slices++;
+            replay->busy_time += record.length;
+            break;
+        case SCHED_LOG_COMPLETE:
+            addCompletion(replay, &record);
+            break;
+        case SCHED_LOG_REJECT:
+            replay->rejected++;
+            break;
+        case SCHED_LOG_END:
+            replay->total_time = record.time;
+            replay->cpus = record.cpus;
+            replay->ended = true;
+            break;
+        }
+    }
+
+    if (status < 0 || !replay->ended)
+    {
+        printf("%s is truncated or corrupt\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+void displayReplay(Replay *replay, long elapsed_ns)
+{
+    double n = (double)replay->completed;
+    long capacity = (long)replay->total_time * (replay->cpus > 0 ? replay->cpus : 1);
+
+    printf("Metric,Value\n");
+    if (replay->completed > 0)
+    {
+        double mean_waiting_time = replay->sum_waiting / n;
+        double variance = replay->sum_sq_waiting / n - mean_waiting_time * mean_waiting_time;
+        if (variance < 0.0)
+            variance = 0.0;
+        double coefficient_of_variation = mean_waiting_time > 0.0 ? sqrt(variance) / mean_waiting_time : 0.0;
+
+        printf("Average Turnaround Time,%.2f\n", replay->sum_turnaround / n);
+        printf("Average Waiting Time,%.2f\n", mean_waiting_time);
+        printf("Average Response Time,%.2f\n", replay->sum_response / n);
+        printf("Throughput,%.2f\n", replay->total_time > 0 ? n / replay->total_time : 0.0);
+        printf("Fairness Index,%.2f\n",
+               (replay->sum_turnaround * replay->sum_turnaround) / (n * replay->sum_sq_turnaround));
+        printf("Starvation Count,%ld\n", replay->starved);
+        printf("Load Balancing Efficiency,%.2f\n", 1.0 / (1.0 + coefficient_of_variation));
+    }
+    printf("Deadline Misses,%ld\n", replay->missed);
+    printf("CPU Utilization,%.2f\n", capacity > 0 ? (double)replay->busy_time / capacity : 0.0);
+    if (replay->critical_completed > 0)
+        printf("High-Criticality Avg Turnaround Time,%.2f\n",
+               replay->sum_critical_turnaround / replay->critical_completed);
+
+    // Not tracked by the engines themselves
+    printf("Completed,%ld\n", replay->completed);
+    printf("Rejected,%ld\n", replay->rejected);
+    printf("Slices,%ld\n", replay->slices);
+    printf("Average Slice Length,%.2f\n", replay->slices > 0 ? (double)replay->busy_time / replay->slices : 0.0);
+    printf("Makespan,%d\n", replay->total_time);
+    if (replay->completed > 0)
+    {
+        printf("P50 Response Time,%d\n", sched_histogram_percentile(&replay->response, 50));
+        printf("P95 Response Time,%d\n", sched_histogram_percentile(&replay->response, 95));
+        printf("P99 Response Time,%d\n", sched_histogram_percentile(&replay->response, 99));
+        printf("P99 Turnaround Time,%d\n", sched_histogram_percentile(&replay->turnaround, 99));
+        printf("Max Waiting Time,%d\n", replay->max_waiting);
+        printf("Average Slowdown,%.2f\n", replay->sum_slowdown / n);
+    }
+    printf("Replay Time (ms),%.3f\n", elapsed_ns / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+    int inputs = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--", 2) == 0)
+        {
+            printf("Unknown option %s\n", argv[i]);
+            return 1;
+        }
+        inputs++;
+    }
+
+    if (inputs == 0)
+    {
+        printf("Usage: %s <decision_log>...\n", argv[0]);
+        return 1;
+    }
+
+    int status = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        FILE *file = fopen(argv[i], "rb");
+        if (file == NULL)
+        {
+            printf("Error opening file %s\n", argv[i]);
+            status = 1;
+            continue;
+        }
+
+        Replay replay;
+        memset(&replay, 0, sizeof(Replay));
+        long start_ns = monotonicNs();
+        int replayed = replayLog(file, argv[i], &replay);
+        long elapsed_ns = monotonicNs() - start_ns;
+        fclose(file);
+
+        if (replayed == 0)
+        {
+            if (inputs > 1)
+                printf("%sLog,%s\n", i > 1 ? "\n" : "", argv[i]);
+            displayReplay(&replay, elapsed_ns);
+        }
+        else
+        {
+            status = 1;
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "scheduler.h"
+#include "sched_analysis.h"
+
+long monotonicNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+// Reads every record of the input; aperiodic processes are kept out of the
+// analysis. Returns the number of periodic tasks, or -1 on error.
+int readPeriodicTasks(FILE *file, SchedTask **out)
+{
+    int line_number = 0;
+    int capacity = 64;
+    int count = 0;
+    SchedTask *tasks = malloc(sizeof(SchedTask) * capacity);
+    SchedTask task;
+    int status;
+
+    while ((status = sched_read_task(file, &task, &line_number)) > 0)
+    {
+        if (task.period <= 0)
+            continue;
+        // Self-suspension is analysed as if the task kept the CPU, which is
+        // safe but pessimistic
+        task.burst_time += sched_io_time(&task.io);
+        if (task.burst_time <= 0)
+        {
+            printf("Process %d on line %d has no burst time\n", task.id, line_number);
+            free(tasks);
+            return -1;
+        }
+
+        if (count == capacity)
+        {
+            capacity *= 2;
+            tasks = realloc(tasks, sizeof(SchedTask) * capacity);
+        }
+        tasks[count++] = task;
+    }
+
+    if (status < 0)
+    {
+        if (status == SCHED_LINE_TOO_LONG)
+            printf("Over-long line %d\n", line_number);
+        else
+            printf("Malformed record on line %d\n", line_number);
+        free(tasks);
+        return -1;
+    }
+
+    *out = tasks;
+    return count;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *input = NULL;
+    SchedPriorityOrder order = SCHED_PRIORITY_DEADLINE_MONOTONIC;
+    bool summary_only = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--priority=dm") == 0)
+            order = SCHED_PRIORITY_DEADLINE_MONOTONIC;
+        else if (strcmp(argv[i], "--priority=system") == 0)
+            order = SCHED_PRIORITY_SYSTEM;
+        else if (strcmp(argv[i], "--summary") == 0)
+            summary_only = true;
+        else if (strncmp(argv[i], "--", 2) == 0)
+        {
+            printf("Unknown option %s\n", argv[i]);
+            return 1;
+        }
+        else
+            input = argv[i];
+    }
+
+    if (input == NULL)
+    {
+        printf("Usage: %s [--priority=dm|system] [--summary] <input_file|->\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = strcmp(input, "-") == 0 ? stdin : fopen(input, "r");
+    if (file == NULL)
+    {
+        printf("Error opening file %s\n", input);
+        return 1;
+    }
+
+    SchedTask *tasks = NULL;
+    int n = readPeriodicTasks(file, &tasks);
+    if (file != stdin)
+        fclose(file);
+    if (n < 0)
+        return 1;
+
+    long *response = malloc(sizeof(long) * (n > 0 ? n : 1));
+    int *priority = malloc(sizeof(int) * (n > 0 ? n : 1));
+    SchedRtaResult rta;
+    SchedDemandResult demand;
+
+    long start_ns = monotonicNs();
+    if (response == NULL || priority == NULL ||
+        sched_rta(tasks, n, order, response, priority, &rta) != 0)
+    {
+        printf("Out of memory\n");
+        return 1;
+    }
+    sched_edf_demand(tasks, n, &demand);
+    long elapsed_ns = monotonicNs() - start_ns;
+
+    // Response -1 means the worst case runs past the deadline
+    if (!summary_only)
+    {
+        printf("ProcessID,Period,Deadline,BurstTime,Priority,WorstCaseResponseTime,Schedulable\n");
+        for (int i = 0; i < n; i++)
+        {
+            printf("%d,%d,%d,%d,%d,%ld,%s\n",
+                   tasks[i].id,
+                   tasks[i].period,
+                   tasks[i].deadline > 0 ? tasks[i].deadline : tasks[i].period,
+                   tasks[i].burst_time,
+                   priority[i],
+                   response[i],
+                   response[i] >= 0 ? "Yes" : "No");
+        }
+        printf("\n");
+    }
+
+    printf("Metric,Value\n");
+    printf("Periodic Tasks,%d\n", n);
+    printf("Utilization,%.4f\n", rta.utilization);
+    printf("Fixed Priority Schedulable,%s\n", rta.unschedulable == 0 ? "Yes" : "No");
+    printf("Unschedulable Tasks,%d\n", rta.unschedulable);
+    printf("EDF Schedulable,%s\n", demand.schedulable ? "Yes" : "No");
+    if (demand.bound > 0)
+        printf("EDF Demand Bound,%ld\n", demand.bound);
+    if (!demand.schedulable && demand.failure_time > 0)
+        printf("EDF Overload Interval,%ld\n", demand.failure_time);
+    printf("Analysis Time (ms),%.3f\n", elapsed_ns / 1e6);
+
+    free(response);
+    free(priority);
+    free(tasks);
+    return 0;
+}
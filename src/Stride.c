@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "scheduler.h"
+#include "sched_frontend.h"
+
+SchedFrontend frontend;
+
+void parseArguments(int argc, char *argv[]);
+
+// Applies the stride and lottery options, and the shared ones through the
+// front end
+void parseArguments(int argc, char *argv[])
+{
+    sched_frontend_init(&frontend, SCHED_POLICY_STRIDE);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--lottery") == 0)
+            frontend.policy = SCHED_POLICY_LOTTERY;
+        else if (strncmp(argv[i], "--seed=", 7) == 0)
+            frontend.config.lottery_seed = strtoul(argv[i] + 7, NULL, 10);
+        else if (strncmp(argv[i], "--quantum=", 10) == 0)
+            frontend.config.share_quantum = atoi(argv[i] + 10);
+        else if (!sched_frontend_option(&frontend, argv[i]))
+        {
+            printf("Unknown option %s\n", argv[i]);
+            exit(1);
+        }
+    }
+}
+
+// The pass heap and ticket tree live in libscheduler; the front end runs
+// them on the event-driven simulator.
+int main(int argc, char *argv[])
+{
+    parseArguments(argc, argv);
+    if (!sched_frontend_check(&frontend))
+    {
+        printf("Usage: %s [--lottery] [--seed=N] [--quantum=N] " SCHED_FRONTEND_USAGE "\n", argv[0]);
+        return 1;
+    }
+
+    Scheduler *sched = sched_frontend_create(&frontend);
+    sched_frontend_run(&frontend, sched, NULL);
+    sched_destroy(sched);
+
+    sched_frontend_report(&frontend);
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sched_trace.h"
+
+// Converts a text dump of Linux scheduler events into a process trace for the
+// streaming mode of the engines. The trace goes to stdout, or to the output
+// file, and the summary to stderr.
+int main(int argc, char *argv[])
+{
+    SchedTraceOptions options;
+    const char *input = NULL;
+    const char *output = NULL;
+    int bad_arguments = 0;
+    sched_trace_default_options(&options);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--unit=ns") == 0)
+            options.unit_ns = 1;
+        else if (strcmp(argv[i], "--unit=us") == 0)
+            options.unit_ns = 1000;
+        else if (strcmp(argv[i], "--unit=ms") == 0)
+            options.unit_ns = 1000000;
+        else if (strncmp(argv[i], "--window=", 9) == 0)
+            options.window_ns = atol(argv[i] + 9) * 1000000L;
+        else if (strncmp(argv[i], "--", 2) == 0 || output != NULL)
+            bad_arguments = 1;
+        else if (input == NULL)
+            input = argv[i];
+        else
+            output = argv[i];
+    }
+
+    if (input == NULL || bad_arguments || options.window_ns <= 0)
+    {
+        printf("Usage: %s [--unit=ns|us|ms] [--window=MS] <perf_sched_script_or_ftrace_dump|-> [output_file]\n", argv[0]);
+        return 1;
+    }
+
+    FILE *in = strcmp(input, "-") == 0 ? stdin : fopen(input, "r");
+    if (in == NULL)
+    {
+        fprintf(stderr, "Error opening file %s\n", input);
+        return 1;
+    }
+    FILE *out = output != NULL ? fopen(output, "w") : stdout;
+    if (out == NULL)
+    {
+        fprintf(stderr, "Error creating file %s\n", output);
+        return 1;
+    }
+
+    SchedTraceStats stats;
+    int status = sched_trace_import(in, out, &options, &stats);
+    if (in != stdin)
+        fclose(in);
+    if (out != stdout && fclose(out) != 0)
+        status = -1;
+
+    if (status == SCHED_TRACE_TOO_LONG)
+    {
+        fprintf(stderr, "The trace is too long to count in this unit; try a coarser --unit\n");
+        return 1;
+    }
+    if (status != 0)
+    {
+        fprintf(stderr, "Import failed after %ld lines: out of memory or the output could not be written\n",
+                stats.lines);
+        return 1;
+    }
+
+    fprintf(stderr, "Lines,%ld\n", stats.lines);
+    fprintf(stderr, "Scheduler Events,%ld\n", stats.events);
+    fprintf(stderr, "Malformed Events,%ld\n", stats.malformed);
+    fprintf(stderr, "Out-of-Order Events,%ld\n", stats.reordered);
+    fprintf(stderr, "Tasks,%ld\n", stats.tasks);
+    fprintf(stderr, "Processes Written,%ld\n", stats.records);
+    fprintf(stderr, "CPU Time,%ld\n", stats.cpu_time);
+    return 0;
+}
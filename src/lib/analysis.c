@@ -0,0 +1,445 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sched_analysis.h"
+
+// Sort key for priority order; ties go to the shorter deadline, then the
+// shorter period, then input order
+typedef struct
+{
+    long system_rank; // -system_priority, or 0 for deadline monotonic
+    long deadline;
+    long period;
+    int index;
+} PriorityKey;
+
+static long relativeDeadline(const SchedTask *task)
+{
+    return task->deadline > 0 ? task->deadline : task->period;
+}
+
+static long ceilDiv(long a, long b)
+{
+    return (a + b - 1) / b;
+}
+
+static int comparePriority(const void *a, const void *b)
+{
+    const PriorityKey *x = a;
+    const PriorityKey *y = b;
+
+    if (x->system_rank != y->system_rank)
+        return x->system_rank < y->system_rank ? -1 : 1;
+    if (x->deadline != y->deadline)
+        return x->deadline < y->deadline ? -1 : 1;
+    if (x->period != y->period)
+        return x->period < y->period ? -1 : 1;
+    return x->index - y->index;
+}
+
+static int compareLong(const void *a, const void *b)
+{
+    long x = *(const long *)a;
+    long y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+// All higher-priority tasks that share a period are released together, so
+// they are tracked as one bucket: `releases` jobs of total cost `sum_c` so
+// far, with the next release boundary crossed once t passes `boundary`.
+typedef struct
+{
+    long period;
+    long sum_c;
+    long releases;
+    long boundary;
+} PeriodBucket;
+
+// Interference of the higher-priority set at the current window length t.
+// Windows only ever grow during the analysis, so moving t forward just adds
+// the releases whose boundary it crosses. Buckets are filed in bins by
+// boundary; every bin behind t has been crossed in full, so only the bin
+// holding t needs its boundaries compared.
+typedef struct
+{
+    PeriodBucket *buckets;
+    int *bin_head;
+    int *next; // Next bucket in the same bin, or -1
+    int bins;
+    long width;
+    long cursor; // Bins before this one are empty
+    long t;
+    long interference;
+    long steps;
+} Interference;
+
+static void fileBucket(Interference *in, int index)
+{
+    long bin = in->buckets[index].boundary / in->width;
+    in->next[index] = in->bin_head[bin];
+    in->bin_head[bin] = index;
+}
+
+static void advanceTo(Interference *in, long t)
+{
+    long last = t / in->width;
+
+    in->t = t;
+    for (long bin = in->cursor; bin <= last; bin++)
+    {
+        int index = in->bin_head[bin];
+        in->bin_head[bin] = -1;
+
+        while (index >= 0)
+        {
+            PeriodBucket *bucket = &in->buckets[index];
+            int next = in->next[index];
+
+            if (bucket->boundary < t)
+            {
+                long crossed = ceilDiv(t, bucket->period) - bucket->releases;
+                in->interference += crossed * bucket->sum_c;
+                bucket->releases += crossed;
+                bucket->boundary = bucket->releases * bucket->period;
+            }
+            fileBucket(in, index);
+            index = next;
+        }
+    }
+    in->cursor = last;
+}
+
+static void addTask(Interference *in, int bucket_index, long c)
+{
+    PeriodBucket *bucket = &in->buckets[bucket_index];
+
+    if (bucket->sum_c == 0)
+    {
+        bucket->releases = ceilDiv(in->t, bucket->period);
+        bucket->boundary = bucket->releases * bucket->period;
+        fileBucket(in, bucket_index);
+    }
+
+    bucket->sum_c += c;
+    in->interference += bucket->releases * c;
+}
+
+static long gcd(long a, long b)
+{
+    while (b != 0)
+    {
+        long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Adds c/period to the utilization num/den, kept exact over the lcm of the
+// periods. Returns false if the lcm would pass the range of a long. Only
+// whether the sum passes 1 matters, so once it does it is left just past 1.
+static bool addUtilization(long *num, long *den, long c, long period)
+{
+    if (*num > *den)
+        return true;
+    if (c > period)
+    {
+        *num = *den + 1;
+        return true;
+    }
+
+    // num <= den and c <= period, so each term is at most the new den
+    long scale = *den / gcd(*den, period);
+    if (scale > LONG_MAX / 2 / period)
+        return false;
+    *num = *num * (period / (*den / scale)) + c * scale;
+    *den = scale * period;
+    return true;
+}
+
+// Direct evaluation for a task whose level-i busy period spans several of its
+// own jobs (deadline > period); rare, so an O(n) scan per step is fine.
+static long multiJobResponse(const SchedTask *tasks, const int *order, int rank,
+                             long first_window, long *steps)
+{
+    const SchedTask *task = &tasks[order[rank]];
+    long c = task->burst_time;
+    long period = task->period;
+    long deadline = relativeDeadline(task);
+    long worst = first_window;
+    long w = first_window;
+
+    for (long q = 1;; q++)
+    {
+        w += c;
+        for (;;)
+        {
+            long demand = (q + 1) * c;
+            for (int k = 0; k < rank; k++)
+                demand += ceilDiv(w, tasks[order[k]].period) * tasks[order[k]].burst_time;
+            (*steps)++;
+
+            if (demand == w)
+                break;
+            w = demand;
+            if (w - q * period > deadline)
+                return -1;
+        }
+
+        if (w - q * period > worst)
+            worst = w - q * period;
+        if (w <= (q + 1) * period)
+            return worst;
+    }
+}
+
+int sched_rta(const SchedTask *tasks, int n, SchedPriorityOrder order,
+              long *response, int *priority, SchedRtaResult *result)
+{
+    int size = n > 0 ? n : 1;
+    PriorityKey *keys = malloc(sizeof(PriorityKey) * size);
+    int *rank_order = malloc(sizeof(int) * size);
+    long *periods = malloc(sizeof(long) * size);
+    int *bucket_of = malloc(sizeof(int) * size);
+    Interference in;
+    in.bins = 2 * size;
+    in.buckets = calloc(size, sizeof(PeriodBucket));
+    in.next = malloc(sizeof(int) * size);
+    in.bin_head = malloc(sizeof(int) * in.bins);
+
+    if (keys == NULL || rank_order == NULL || periods == NULL || bucket_of == NULL ||
+        in.buckets == NULL || in.next == NULL || in.bin_head == NULL)
+    {
+        free(keys);
+        free(rank_order);
+        free(periods);
+        free(bucket_of);
+        free(in.buckets);
+        free(in.next);
+        free(in.bin_head);
+        return -1;
+    }
+
+    memset(result, 0, sizeof(SchedRtaResult));
+
+    long max_deadline = 0;
+    long max_period = 0;
+    for (int i = 0; i < n; i++)
+    {
+        keys[i].system_rank = order == SCHED_PRIORITY_SYSTEM ? -(long)tasks[i].system_priority : 0;
+        keys[i].deadline = relativeDeadline(&tasks[i]);
+        keys[i].period = tasks[i].period;
+        keys[i].index = i;
+        periods[i] = tasks[i].period;
+        result->utilization += (double)tasks[i].burst_time / tasks[i].period;
+        if (keys[i].deadline > max_deadline)
+            max_deadline = keys[i].deadline;
+        if (tasks[i].period > max_period)
+            max_period = tasks[i].period;
+    }
+
+    qsort(keys, n, sizeof(PriorityKey), comparePriority);
+    for (int i = 0; i < n; i++)
+        rank_order[i] = keys[i].index;
+    free(keys);
+
+    qsort(periods, n, sizeof(long), compareLong);
+    int distinct = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (distinct == 0 || periods[distinct - 1] != periods[i])
+            periods[distinct++] = periods[i];
+    }
+    for (int i = 0; i < distinct; i++)
+        in.buckets[i].period = periods[i];
+    for (int i = 0; i < n; i++)
+    {
+        long *found = bsearch(&(long){tasks[i].period}, periods, distinct, sizeof(long), compareLong);
+        bucket_of[i] = (int)(found - periods);
+    }
+
+    // t never passes the longest deadline, so no boundary reaches a period
+    // beyond it
+    for (int i = 0; i < in.bins; i++)
+        in.bin_head[i] = -1;
+    in.width = (max_deadline + max_period) / in.bins + 1;
+    in.cursor = 0;
+    in.t = 0;
+    in.interference = 0;
+    in.steps = 0;
+
+    // R(i) >= R(i-1) + C(i) in priority order, so each search starts where
+    // the previous one stopped and the window never shrinks
+    long level_num = 0;
+    long level_den = 1;
+    bool exact = true;
+    double level_utilization = 0.0; // Only once the exact sum is out of range
+    for (int rank = 0; rank < n; rank++)
+    {
+        int i = rank_order[rank];
+        const SchedTask *task = &tasks[i];
+        long c = task->burst_time;
+        long deadline = relativeDeadline(task);
+        long w = in.t + c;
+        bool converged = false;
+
+        if (priority != NULL)
+            priority[i] = rank;
+        level_utilization += (double)c / task->period;
+        if (exact)
+            exact = addUtilization(&level_num, &level_den, c, task->period);
+        bool overloaded = exact ? level_num > level_den : level_utilization > 1.0;
+
+        // A window past the deadline is left where it was; it is still a
+        // lower bound for the next task
+        while (w <= deadline)
+        {
+            advanceTo(&in, w);
+            w = c + in.interference;
+            in.steps++;
+            if (w == in.t)
+            {
+                converged = true;
+                break;
+            }
+        }
+
+        if (!converged)
+            response[i] = -1;
+        else if (in.t <= task->period)
+            response[i] = in.t;
+        else if (overloaded)
+            response[i] = -1; // The busy period never ends
+        else
+            response[i] = multiJobResponse(tasks, rank_order, rank, in.t, &in.steps);
+
+        if (response[i] < 0)
+            result->unschedulable++;
+
+        addTask(&in, bucket_of[i], c);
+    }
+
+    result->steps = in.steps;
+
+    free(rank_order);
+    free(periods);
+    free(bucket_of);
+    free(in.buckets);
+    free(in.next);
+    free(in.bin_head);
+    return 0;
+}
+
+// h(t): execution demand of every job with release and deadline in [0, t]
+static long demandBound(const SchedTask *tasks, int n, long t)
+{
+    long demand = 0;
+    for (int i = 0; i < n; i++)
+    {
+        long deadline = relativeDeadline(&tasks[i]);
+        if (t >= deadline)
+            demand += ((t - deadline) / tasks[i].period + 1) * tasks[i].burst_time;
+    }
+    return demand;
+}
+
+// Latest absolute deadline strictly before t, or 0 if there is none
+static long deadlineBefore(const SchedTask *tasks, int n, long t)
+{
+    long latest = 0;
+    for (int i = 0; i < n; i++)
+    {
+        long deadline = relativeDeadline(&tasks[i]);
+        if (deadline >= t)
+            continue;
+        long d = deadline + (t - deadline - 1) / tasks[i].period * tasks[i].period;
+        if (d > latest)
+            latest = d;
+    }
+    return latest;
+}
+
+// Length of the synchronous busy period
+static long busyPeriod(const SchedTask *tasks, int n, long *steps)
+{
+    long w = 0;
+    for (int i = 0; i < n; i++)
+        w += tasks[i].burst_time;
+
+    for (;;)
+    {
+        long next = 0;
+        for (int i = 0; i < n; i++)
+            next += ceilDiv(w, tasks[i].period) * tasks[i].burst_time;
+        (*steps)++;
+        if (next == w)
+            return w;
+        w = next;
+    }
+}
+
+void sched_edf_demand(const SchedTask *tasks, int n, SchedDemandResult *result)
+{
+    memset(result, 0, sizeof(SchedDemandResult));
+    if (n == 0)
+    {
+        result->schedulable = true;
+        return;
+    }
+
+    bool implicit = true;
+    long min_deadline = relativeDeadline(&tasks[0]);
+    long max_deadline = 0;
+    double slack = 0.0;
+    for (int i = 0; i < n; i++)
+    {
+        long deadline = relativeDeadline(&tasks[i]);
+        double utilization = (double)tasks[i].burst_time / tasks[i].period;
+
+        result->utilization += utilization;
+        if (deadline < tasks[i].period)
+            implicit = false;
+        if (deadline < min_deadline)
+            min_deadline = deadline;
+        if (deadline > max_deadline)
+            max_deadline = deadline;
+        slack += (tasks[i].period - deadline) * utilization;
+    }
+
+    if (result->utilization > 1.0)
+        return;
+
+    // Deadlines no shorter than periods: the utilization bound is exact
+    if (implicit)
+    {
+        result->schedulable = true;
+        return;
+    }
+
+    long bound = busyPeriod(tasks, n, &result->steps);
+    if (result->utilization < 1.0)
+    {
+        double la = slack / (1.0 - result->utilization);
+        long la_bound = la > max_deadline ? (long)la + 1 : max_deadline;
+        if (la_bound < bound)
+            bound = la_bound;
+    }
+    result->bound = bound;
+
+    // QPA: walk back from the bound, jumping straight to h(t) whenever the
+    // demand leaves slack, until the demand drops below the first deadline
+    long t = deadlineBefore(tasks, n, bound + 1);
+    long h = demandBound(tasks, n, t);
+    result->steps++;
+    while (h <= t && h > min_deadline)
+    {
+        t = h < t ? h : deadlineBefore(tasks, n, t);
+        h = demandBound(tasks, n, t);
+        result->steps++;
+    }
+
+    result->schedulable = h <= min_deadline;
+    if (!result->schedulable)
+        result->failure_time = t;
+}
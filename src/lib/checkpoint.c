@@ -0,0 +1,243 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "sched_internal.h"
+
+void checkpointPut(Checkpoint *ckpt, const void *value, size_t size)
+{
+    if (ckpt->failed)
+        return;
+
+    if (ckpt->size + size > ckpt->capacity)
+    {
+        size_t capacity = ckpt->capacity > 0 ? ckpt->capacity : 4096;
+        while (capacity < ckpt->size + size)
+            capacity *= 2;
+        unsigned char *data = realloc(ckpt->data, capacity);
+        if (data == NULL)
+        {
+            ckpt->failed = true;
+            return;
+        }
+        ckpt->data = data;
+        ckpt->capacity = capacity;
+    }
+
+    memcpy(ckpt->data + ckpt->size, value, size);
+    ckpt->size += size;
+}
+
+void checkpointGet(Checkpoint *ckpt, void *value, size_t size)
+{
+    if (ckpt->failed || ckpt->size - ckpt->pos < size)
+    {
+        ckpt->failed = true;
+        memset(value, 0, size);
+        return;
+    }
+
+    memcpy(value, ckpt->data + ckpt->pos, size);
+    ckpt->pos += size;
+}
+
+void checkpointPutTask(Checkpoint *ckpt, const SchedTask *task)
+{
+    int number = -1;
+    if (task != NULL)
+    {
+        bool in_array = task >= ckpt->tasks && task < ckpt->tasks + ckpt->n;
+        number = in_array ? (int)(task - ckpt->tasks) : ckpt->n + task->job_slot;
+    }
+    checkpointPut(ckpt, &number, sizeof(number));
+}
+
+SchedTask *checkpointGetTask(Checkpoint *ckpt)
+{
+    int number;
+    checkpointGet(ckpt, &number, sizeof(number));
+    if (number < 0 || ckpt->failed)
+        return NULL;
+
+    if (number < ckpt->n)
+        return &ckpt->tasks[number];
+    if (number - ckpt->n < ckpt->job_count)
+        return ckpt->jobs[number - ckpt->n];
+
+    ckpt->failed = true;
+    return NULL;
+}
+
+void checkpointPutTasks(Checkpoint *ckpt, SchedTask *const *tasks, int count)
+{
+    checkpointPut(ckpt, &count, sizeof(count));
+    for (int i = 0; i < count; i++)
+        checkpointPutTask(ckpt, tasks[i]);
+}
+
+int checkpointGetTasks(Checkpoint *ckpt, SchedTask ***tasks, int *capacity)
+{
+    int count;
+    checkpointGet(ckpt, &count, sizeof(count));
+    if (ckpt->failed || count < 0 || (size_t)count > ckpt->size - ckpt->pos)
+        return -1;
+
+    if (count > *capacity)
+    {
+        SchedTask **grown = realloc(*tasks, sizeof(SchedTask *) * count);
+        if (grown == NULL)
+            return -1;
+        *tasks = grown;
+        *capacity = count;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        (*tasks)[i] = checkpointGetTask(ckpt);
+        if ((*tasks)[i] == NULL)
+            return -1;
+    }
+    return count;
+}
+
+uint64_t checkpointHash(uint64_t hash, const void *value, size_t size)
+{
+    const unsigned char *bytes = value;
+
+    if (hash == 0)
+        hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    return hash;
+}
+
+#define HASH_FIELD(hash, field) checkpointHash(hash, &(field), sizeof(field))
+
+uint64_t schedulerConfigHash(const Scheduler *sched)
+{
+    const SchedConfig *config = &sched->config;
+    uint64_t hash = HASH_FIELD(0, sched->policy);
+
+    hash = HASH_FIELD(hash, config->base_quantum);
+    hash = HASH_FIELD(hash, config->criticality_weight);
+    hash = HASH_FIELD(hash, config->deadline_weight);
+    hash = HASH_FIELD(hash, config->aging_weight);
+    hash = HASH_FIELD(hash, config->priority_weight);
+    hash = HASH_FIELD(hash, config->critical_path_weight);
+    hash = HASH_FIELD(hash, config->preempt_on_arrival);
+    hash = HASH_FIELD(hash, config->lock_protocol);
+    hash = HASH_FIELD(hash, config->quantum_target);
+    hash = HASH_FIELD(hash, config->quantum_setpoint);
+    hash = HASH_FIELD(hash, config->min_granularity);
+    hash = HASH_FIELD(hash, config->latency);
+    hash = HASH_FIELD(hash, config->group_scheduling);
+    hash = HASH_FIELD(hash, config->admission);
+    hash = HASH_FIELD(hash, config->utilization_bound);
+    hash = HASH_FIELD(hash, config->mlfq_levels);
+    hash = HASH_FIELD(hash, config->mlfq_quantum);
+    hash = HASH_FIELD(hash, config->mlfq_boost_period);
+    hash = HASH_FIELD(hash, config->share_quantum);
+    hash = HASH_FIELD(hash, config->lottery_seed);
+    hash = HASH_FIELD(hash, config->affinity_wait);
+    return HASH_FIELD(hash, config->class_metrics);
+}
+
+void schedulerSave(const Scheduler *sched, Checkpoint *ckpt)
+{
+    checkpointPut(ckpt, &sched->policy, sizeof(sched->policy));
+    checkpointPut(ckpt, &sched->submitted, sizeof(sched->submitted));
+    checkpointPut(ckpt, &sched->live, sizeof(sched->live));
+    checkpointPut(ckpt, &sched->blocked, sizeof(sched->blocked));
+    checkpointPut(ckpt, &sched->acc, sizeof(sched->acc));
+
+    for (int i = 0; i < SCHED_MAX_RESOURCES; i++)
+    {
+        const SchedResource *resource = &sched->resources[i];
+        int waiting = 0;
+        for (const SchedTask *waiter = resource->waiters; waiter != NULL; waiter = waiter->waiter_next)
+            waiting++;
+
+        checkpointPutTask(ckpt, resource->holder);
+        checkpointPut(ckpt, &waiting, sizeof(waiting));
+        for (const SchedTask *waiter = resource->waiters; waiter != NULL; waiter = waiter->waiter_next)
+            checkpointPutTask(ckpt, waiter);
+    }
+
+    classesSave(sched, ckpt);
+    sched->ops->save(sched, ckpt);
+}
+
+int schedulerRestore(Scheduler *sched, Checkpoint *ckpt)
+{
+    SchedPolicy policy;
+    checkpointGet(ckpt, &policy, sizeof(policy));
+    if (policy != sched->policy || sched->submitted != 0)
+        return -1;
+
+    checkpointGet(ckpt, &sched->submitted, sizeof(sched->submitted));
+    checkpointGet(ckpt, &sched->live, sizeof(sched->live));
+    checkpointGet(ckpt, &sched->blocked, sizeof(sched->blocked));
+    checkpointGet(ckpt, &sched->acc, sizeof(sched->acc));
+
+    for (int i = 0; i < SCHED_MAX_RESOURCES; i++)
+    {
+        SchedResource *resource = &sched->resources[i];
+        int waiting;
+        resource->holder = checkpointGetTask(ckpt);
+        checkpointGet(ckpt, &waiting, sizeof(waiting));
+
+        SchedTask **link = &resource->waiters;
+        for (int k = 0; k < waiting && !ckpt->failed; k++)
+        {
+            *link = checkpointGetTask(ckpt);
+            if (*link == NULL)
+                return -1;
+            link = &(*link)->waiter_next;
+        }
+        *link = NULL;
+    }
+    if (ckpt->failed || classesRestore(sched, ckpt) != 0)
+        return -1;
+
+    return sched->ops->restore(sched, ckpt);
+}
+
+int checkpointWrite(const Checkpoint *ckpt, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return -1;
+
+    size_t written = fwrite(ckpt->data, 1, ckpt->size, file);
+    if (fclose(file) != 0 || written != ckpt->size)
+        return -1;
+    return 0;
+}
+
+int checkpointRead(Checkpoint *ckpt, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return -1;
+
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0)
+        size = ftell(file);
+    if (size <= 0 || fseek(file, 0, SEEK_SET) != 0)
+    {
+        fclose(file);
+        return -1;
+    }
+
+    ckpt->data = malloc(size);
+    if (ckpt->data == NULL || fread(ckpt->data, 1, size, file) != (size_t)size)
+    {
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+
+    ckpt->size = size;
+    ckpt->capacity = size;
+    ckpt->pos = 0;
+    return 0;
+}
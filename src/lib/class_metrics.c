@@ -0,0 +1,340 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "sched_internal.h"
+
+static int bucketOf(int value)
+{
+    if (value < CLASS_EXACT_LIMIT)
+        return value > 0 ? value : 0;
+
+    int exponent = 0;
+    while ((value >> exponent) >= 2 * CLASS_SUB_BUCKETS)
+        exponent++;
+    // value >> exponent is now in [16, 32): the top five bits
+    return CLASS_EXACT_LIMIT + (exponent - 2) * CLASS_SUB_BUCKETS + ((value >> exponent) - CLASS_SUB_BUCKETS);
+}
+
+// Largest value that falls in a bucket
+static long bucketTop(int bucket)
+{
+    if (bucket < CLASS_EXACT_LIMIT)
+        return bucket;
+
+    int exponent = (bucket - CLASS_EXACT_LIMIT) / CLASS_SUB_BUCKETS + 2;
+    long top = CLASS_SUB_BUCKETS + (bucket - CLASS_EXACT_LIMIT) % CLASS_SUB_BUCKETS + 1;
+    return (top << exponent) - 1;
+}
+
+// Nearest-rank percentile, capped at the largest value seen
+static int percentile(const long *histogram, long n, int p, int max)
+{
+    long rank = (p * n + 99) / 100;
+    long seen = 0;
+
+    for (int i = 0; i < CLASS_BUCKETS; i++)
+    {
+        seen += histogram[i];
+        if (seen >= rank)
+            return bucketTop(i) < max ? (int)bucketTop(i) : max;
+    }
+    return max;
+}
+
+static void resetClass(ClassAccumulator *cls, SchedClassKind kind, int key)
+{
+    memset(cls, 0, sizeof(ClassAccumulator));
+    cls->kind = kind;
+    cls->key = key;
+}
+
+static bool growClasses(Scheduler *sched, int capacity)
+{
+    if (capacity <= sched->class_capacity)
+        return true;
+
+    ClassAccumulator *classes = realloc(sched->classes, sizeof(ClassAccumulator) * capacity);
+    if (classes == NULL)
+        return false;
+    sched->classes = classes;
+    sched->class_capacity = capacity;
+    return true;
+}
+
+// Rebuilds the group class hash with `size` buckets
+static bool rehashClasses(Scheduler *sched, int size)
+{
+    int *hash = malloc(sizeof(int) * size);
+    if (hash == NULL)
+        return false;
+    for (int i = 0; i < size; i++)
+        hash[i] = -1;
+
+    for (int i = CLASS_FIXED; i < sched->class_count; i++)
+    {
+        unsigned int bucket = hashGroup(sched->classes[i].key, size);
+        sched->classes[i].hash_next = hash[bucket];
+        hash[bucket] = i;
+    }
+
+    free(sched->class_hash);
+    sched->class_hash = hash;
+    sched->class_hash_size = size;
+    return true;
+}
+
+int classesInit(Scheduler *sched)
+{
+    if (!sched->config.class_metrics)
+        return 0;
+    if (!growClasses(sched, CLASS_FIXED + 4))
+        return -1;
+
+    for (int i = 0; i <= 10; i++)
+        resetClass(&sched->classes[i], SCHED_CLASS_CRITICALITY, i);
+    for (int i = 0; i < SCHED_PRIORITY_BANDS; i++)
+        resetClass(&sched->classes[11 + i], SCHED_CLASS_PRIORITY, i);
+    sched->class_count = CLASS_FIXED;
+    return rehashClasses(sched, 16) ? 0 : -1;
+}
+
+static ClassAccumulator *findGroupClass(Scheduler *sched, int group)
+{
+    int i = sched->class_hash[hashGroup(group, sched->class_hash_size)];
+    while (i >= 0 && sched->classes[i].key != group)
+        i = sched->classes[i].hash_next;
+    return i >= 0 ? &sched->classes[i] : NULL;
+}
+
+int classesSubmit(Scheduler *sched, const SchedTask *task)
+{
+    if (sched->classes == NULL || findGroupClass(sched, task->group) != NULL)
+        return 0;
+
+    if (sched->class_count == sched->class_capacity && !growClasses(sched, sched->class_capacity * 2))
+        return -1;
+    if (sched->class_count - CLASS_FIXED >= sched->class_hash_size &&
+        !rehashClasses(sched, sched->class_hash_size * 2))
+        return -1;
+
+    int index = sched->class_count++;
+    unsigned int bucket = hashGroup(task->group, sched->class_hash_size);
+    resetClass(&sched->classes[index], SCHED_CLASS_GROUP, task->group);
+    sched->classes[index].hash_next = sched->class_hash[bucket];
+    sched->class_hash[bucket] = index;
+    return 0;
+}
+
+// The criticality, priority band and group classes of a task
+static int classesOf(Scheduler *sched, const SchedTask *task, ClassAccumulator **classes)
+{
+    int criticality = task->criticality < 0 ? 0 : task->criticality > 10 ? 10 : task->criticality;
+    int band = task->system_priority <= 3 ? 0 : task->system_priority <= 7 ? 1 : 2;
+
+    classes[0] = &sched->classes[criticality];
+    classes[1] = &sched->classes[11 + band];
+    classes[2] = findGroupClass(sched, task->group);
+    return classes[2] != NULL ? 3 : 2;
+}
+
+void classesComplete(Scheduler *sched, const SchedTask *task)
+{
+    if (sched->classes == NULL)
+        return;
+
+    ClassAccumulator *classes[3];
+    int count = classesOf(sched, task, classes);
+    int response = bucketOf(task->response_time);
+    int turnaround = bucketOf(task->turnaround_time);
+
+    for (int i = 0; i < count; i++)
+    {
+        ClassAccumulator *cls = classes[i];
+        cls->completed++;
+        cls->sum_turnaround += task->turnaround_time;
+        cls->sum_waiting += task->waiting_time;
+        cls->sum_response += task->response_time;
+        if (task->waiting_time > SCHED_STARVATION_THRESHOLD)
+            cls->starved++;
+        if (cls->completed == 1 || task->response_time > cls->max_response)
+            cls->max_response = task->response_time;
+        if (cls->completed == 1 || task->turnaround_time > cls->max_turnaround)
+            cls->max_turnaround = task->turnaround_time;
+        cls->response[response]++;
+        cls->turnaround[turnaround]++;
+    }
+}
+
+void classesDeadlinePassed(Scheduler *sched, const SchedTask *task)
+{
+    if (sched->classes == NULL)
+        return;
+
+    ClassAccumulator *classes[3];
+    int count = classesOf(sched, task, classes);
+    for (int i = 0; i < count; i++)
+        classes[i]->deadline_misses++;
+}
+
+int sched_class_stats(const Scheduler *sched, SchedClassStats *stats, int max)
+{
+    int total = 0;
+
+    for (int i = 0; i < sched->class_count; i++)
+    {
+        const ClassAccumulator *cls = &sched->classes[i];
+        if (cls->completed == 0 && cls->deadline_misses == 0)
+            continue;
+
+        if (total < max)
+        {
+            SchedClassStats *out = &stats[total];
+            double n = cls->completed > 0 ? (double)cls->completed : 1.0;
+
+            memset(out, 0, sizeof(SchedClassStats));
+            out->kind = cls->kind;
+            out->key = cls->key;
+            out->completed = cls->completed;
+            out->deadline_misses = cls->deadline_misses;
+            out->starvation_count = cls->starved;
+            out->avg_turnaround_time = cls->sum_turnaround / n;
+            out->avg_waiting_time = cls->sum_waiting / n;
+            out->avg_response_time = cls->sum_response / n;
+            if (cls->completed > 0)
+            {
+                out->p50_response_time = percentile(cls->response, cls->completed, 50, cls->max_response);
+                out->p95_response_time = percentile(cls->response, cls->completed, 95, cls->max_response);
+                out->p99_response_time = percentile(cls->response, cls->completed, 99, cls->max_response);
+                out->max_response_time = cls->max_response;
+                out->p99_turnaround_time = percentile(cls->turnaround, cls->completed, 99, cls->max_turnaround);
+            }
+        }
+        total++;
+    }
+
+    return total;
+}
+
+int sched_class_table(const Scheduler *sched, SchedClassStats **stats)
+{
+    int count = sched_class_stats(sched, NULL, 0);
+
+    *stats = malloc(sizeof(SchedClassStats) * (count > 0 ? count : 1));
+    if (*stats == NULL)
+        return -1;
+    return sched_class_stats(sched, *stats, count);
+}
+
+void sched_write_class_stats(FILE *out, const SchedClassStats *stats, int count)
+{
+    static const char *bands[SCHED_PRIORITY_BANDS] = {"1-3", "4-7", "8-10"};
+    bool tenants = false;
+    for (int i = 0; i < count; i++)
+    {
+        if (stats[i].kind == SCHED_CLASS_GROUP && stats[i].key != 0)
+            tenants = true;
+    }
+
+    fprintf(out, "Class,Key,Completed,DeadlineMisses,StarvationCount,AvgTurnaroundTime,AvgWaitingTime,AvgResponseTime,P50ResponseTime,P95ResponseTime,P99ResponseTime,MaxResponseTime,P99TurnaroundTime\n");
+    for (int i = 0; i < count; i++)
+    {
+        const SchedClassStats *cls = &stats[i];
+        if (cls->kind == SCHED_CLASS_CRITICALITY)
+            fprintf(out, "Criticality,%d", cls->key);
+        else if (cls->kind == SCHED_CLASS_PRIORITY)
+            fprintf(out, "Priority,%s", bands[cls->key]);
+        else if (tenants)
+            fprintf(out, "Group,%d", cls->key);
+        else
+            continue;
+
+        fprintf(out, ",%ld,%ld,%d,%.2f,%.2f,%.2f,%d,%d,%d,%d,%d\n",
+                cls->completed,
+                cls->deadline_misses,
+                cls->starvation_count,
+                cls->avg_turnaround_time,
+                cls->avg_waiting_time,
+                cls->avg_response_time,
+                cls->p50_response_time,
+                cls->p95_response_time,
+                cls->p99_response_time,
+                cls->max_response_time,
+                cls->p99_turnaround_time);
+    }
+}
+
+void sched_write_job_stats(FILE *out, const SchedTask *tasks, int n, bool rejected)
+{
+    fprintf(out, "ProcessID,Period,Jobs,DeadlineMisses,%sMinResponseTime,AvgResponseTime,MaxResponseTime,ResponseJitter,StartJitter\n",
+            rejected ? "RejectedJobs," : "");
+
+    for (int i = 0; i < n; i++)
+    {
+        const SchedTask *task = &tasks[i];
+        const SchedJobStats *jobs = &task->jobs;
+        if (jobs->released == 0)
+            continue;
+
+        double avg_response = jobs->completed > 0 ? jobs->sum_response / jobs->completed : 0.0;
+        fprintf(out, "%d,%d,%ld,%ld,", task->id, task->period, jobs->released, jobs->missed);
+        if (rejected)
+            fprintf(out, "%ld,", jobs->rejected);
+        fprintf(out, "%d,%.2f,%d,%d,%d\n",
+                jobs->min_response,
+                avg_response,
+                jobs->max_response,
+                jobs->max_response - jobs->min_response,
+                jobs->max_start - jobs->min_start);
+    }
+}
+
+void sched_histogram_add(SchedHistogram *histogram, int value)
+{
+    histogram->buckets[bucketOf(value)]++;
+    if (histogram->count == 0 || value > histogram->max)
+        histogram->max = value;
+    histogram->count++;
+}
+
+int sched_histogram_percentile(const SchedHistogram *histogram, int p)
+{
+    if (histogram->count == 0)
+        return 0;
+    return percentile(histogram->buckets, histogram->count, p, histogram->max);
+}
+
+void classesSave(const Scheduler *sched, Checkpoint *ckpt)
+{
+    checkpointPut(ckpt, &sched->class_count, sizeof(sched->class_count));
+    for (int i = 0; i < sched->class_count; i++)
+        checkpointPut(ckpt, &sched->classes[i], sizeof(ClassAccumulator));
+}
+
+// The checkpoint's classes replace the fresh ones, so a resumed run reports
+// over the whole run. Without class_metrics they are read past.
+int classesRestore(Scheduler *sched, Checkpoint *ckpt)
+{
+    int count;
+    checkpointGet(ckpt, &count, sizeof(count));
+    if (ckpt->failed || count < 0 || (size_t)count > (ckpt->size - ckpt->pos) / sizeof(ClassAccumulator))
+        return -1;
+
+    if (sched->classes == NULL || count == 0)
+    {
+        ckpt->pos += count * sizeof(ClassAccumulator);
+        return 0;
+    }
+    if (count < CLASS_FIXED || !growClasses(sched, count))
+        return -1;
+
+    for (int i = 0; i < count; i++)
+        checkpointGet(ckpt, &sched->classes[i], sizeof(ClassAccumulator));
+    sched->class_count = count;
+    if (ckpt->failed)
+        return -1;
+
+    int size = sched->class_hash_size;
+    while (count - CLASS_FIXED >= size)
+        size *= 2;
+    return rehashClasses(sched, size) ? 0 : -1;
+}
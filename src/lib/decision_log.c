@@ -0,0 +1,191 @@
+#include <limits.h>
+#include <string.h>
+
+#include "sched_log.h"
+
+#define LOG_MAGIC "SDLG"
+#define LOG_VERSION 1
+
+static void putVarint(FILE *out, unsigned long value)
+{
+    while (value >= 0x80)
+    {
+        putc((int)(value & 0x7f) | 0x80, out);
+        value >>= 7;
+    }
+    putc((int)value, out);
+}
+
+// Zigzag keeps small negative deltas as short as small positive ones
+static void putSigned(FILE *out, long value)
+{
+    putVarint(out, value < 0 ? ((unsigned long)(-(value + 1)) << 1) | 1 : (unsigned long)value << 1);
+}
+
+// Returns 1, 0 at the end of the file and -1 on a truncated or overlong varint
+static int getVarint(FILE *in, unsigned long *value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = getc(in);
+        if (byte == EOF)
+            return shift == 0 ? 0 : -1;
+        *value |= (unsigned long)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return 1;
+    }
+    return -1;
+}
+
+static int getInt(FILE *in, int *value)
+{
+    unsigned long raw;
+    if (getVarint(in, &raw) != 1 || raw > INT_MAX)
+        return -1;
+    *value = (int)raw;
+    return 0;
+}
+
+static int getSigned(FILE *in, long *value)
+{
+    unsigned long raw;
+    if (getVarint(in, &raw) != 1)
+        return -1;
+    *value = (raw & 1) ? -(long)(raw >> 1) - 1 : (long)(raw >> 1);
+    return 0;
+}
+
+static int getSignedInt(FILE *in, int *value)
+{
+    long wide;
+    if (getSigned(in, &wide) != 0 || wide < INT_MIN || wide > INT_MAX)
+        return -1;
+    *value = (int)wide;
+    return 0;
+}
+
+// Applies a delta to the previous time or id
+static int getDelta(FILE *in, int base, int *value)
+{
+    long delta;
+    if (getSigned(in, &delta) != 0)
+        return -1;
+    long sum = base + delta;
+    if (sum < INT_MIN || sum > INT_MAX)
+        return -1;
+    *value = (int)sum;
+    return 0;
+}
+
+int sched_log_start(SchedLog *log, FILE *out)
+{
+    log->file = out;
+    log->time = 0;
+    log->id = 0;
+
+    fwrite(LOG_MAGIC, 1, 4, out);
+    putVarint(out, LOG_VERSION);
+    return ferror(out) ? -1 : 0;
+}
+
+void sched_log_write(SchedLog *log, const SchedLogRecord *record)
+{
+    FILE *out = log->file;
+    unsigned long tag = record->type;
+    if (record->type == SCHED_LOG_SLICE)
+        tag |= (unsigned long)record->cpu << 2;
+
+    putVarint(out, tag);
+    putSigned(out, (long)record->time - log->time);
+    log->time = record->time;
+
+    switch (record->type)
+    {
+    case SCHED_LOG_SLICE:
+    case SCHED_LOG_COMPLETE:
+    case SCHED_LOG_REJECT:
+        putSigned(out, (long)record->id - log->id);
+        log->id = record->id;
+        break;
+    case SCHED_LOG_END:
+        putVarint(out, record->cpus);
+        break;
+    }
+
+    if (record->type == SCHED_LOG_SLICE)
+    {
+        putVarint(out, record->length);
+    }
+    else if (record->type == SCHED_LOG_COMPLETE)
+    {
+        putSigned(out, record->turnaround_time);
+        putSigned(out, record->response_time);
+        putSigned(out, record->burst_time);
+        putSigned(out, record->blocked_time);
+        putSigned(out, record->criticality);
+        putVarint(out, record->missed);
+    }
+}
+
+int sched_log_open(SchedLog *log, FILE *in)
+{
+    char magic[4];
+    unsigned long version;
+
+    log->file = in;
+    log->time = 0;
+    log->id = 0;
+
+    if (fread(magic, 1, 4, in) != 4 || memcmp(magic, LOG_MAGIC, 4) != 0)
+        return -1;
+    if (getVarint(in, &version) != 1 || version != LOG_VERSION)
+        return -1;
+    return 0;
+}
+
+int sched_log_read(SchedLog *log, SchedLogRecord *record)
+{
+    FILE *in = log->file;
+    unsigned long tag;
+
+    int status = getVarint(in, &tag);
+    if (status <= 0)
+        return status;
+
+    memset(record, 0, sizeof(SchedLogRecord));
+    record->type = (SchedLogType)(tag & 3);
+    if (record->type != SCHED_LOG_SLICE && tag > 3)
+        return -1;
+    if ((tag >> 2) > INT_MAX)
+        return -1;
+    record->cpu = (int)(tag >> 2);
+
+    if (getDelta(in, log->time, &record->time) != 0)
+        return -1;
+    log->time = record->time;
+
+    if (record->type == SCHED_LOG_END)
+        return getInt(in, &record->cpus) == 0 ? 1 : -1;
+
+    if (getDelta(in, log->id, &record->id) != 0)
+        return -1;
+    log->id = record->id;
+
+    if (record->type == SCHED_LOG_SLICE)
+        return getInt(in, &record->length) == 0 ? 1 : -1;
+
+    if (record->type == SCHED_LOG_COMPLETE)
+    {
+        int missed;
+        if (getSignedInt(in, &record->turnaround_time) != 0 ||
+            getSignedInt(in, &record->response_time) != 0 ||
+            getSignedInt(in, &record->burst_time) != 0 ||
+            getSignedInt(in, &record->blocked_time) != 0 ||
+            getSignedInt(in, &record->criticality) != 0 ||
+            getInt(in, &missed) != 0 || missed > 1)
+            return -1;
+        record->missed = missed;
+    }
+    return 1;
+}
@@ -0,0 +1,313 @@
+#include <stdlib.h>
+
+#include "event_queue.h"
+
+#define INITIAL_BUCKETS 2
+#define WIDTH_SAMPLE_SIZE 25
+
+static bool eventBefore(const SimEvent *a, const SimEvent *b)
+{
+    if (a->time != b->time)
+        return a->time < b->time;
+    if (a->type != b->type)
+        return a->type < b->type;
+    return a->seq < b->seq;
+}
+
+static int bucketOf(const EventQueue *queue, int time)
+{
+    return (int)((time / queue->width) % queue->bucket_count);
+}
+
+// Points the search cursor at the day containing `time`
+static void seekTo(EventQueue *queue, int time)
+{
+    queue->last_time = time;
+    queue->last_bucket = bucketOf(queue, time);
+    queue->bucket_top = ((long)time / queue->width + 1) * queue->width;
+}
+
+// Sorted insert, scanning back from the tail since new events are usually
+// the latest in their bucket
+static void linkEvent(EventQueue *queue, SimEvent *event)
+{
+    int b = bucketOf(queue, event->time);
+    SimEvent *prev = queue->tails[b];
+
+    while (prev != NULL && eventBefore(event, prev))
+        prev = prev->prev;
+
+    SimEvent *next = prev != NULL ? prev->next : queue->buckets[b];
+    event->prev = prev;
+    event->next = next;
+
+    if (prev != NULL)
+        prev->next = event;
+    else
+        queue->buckets[b] = event;
+
+    if (next != NULL)
+        next->prev = event;
+    else
+        queue->tails[b] = event;
+}
+
+static void unlinkEvent(EventQueue *queue, SimEvent *event)
+{
+    int b = bucketOf(queue, event->time);
+
+    if (event->prev != NULL)
+        event->prev->next = event->next;
+    else
+        queue->buckets[b] = event->next;
+
+    if (event->next != NULL)
+        event->next->prev = event->prev;
+    else
+        queue->tails[b] = event->prev;
+}
+
+static int setBuckets(EventQueue *queue, int bucket_count, int width)
+{
+    SimEvent **buckets = calloc(bucket_count, sizeof(SimEvent *));
+    SimEvent **tails = calloc(bucket_count, sizeof(SimEvent *));
+    if (buckets == NULL || tails == NULL)
+    {
+        free(buckets);
+        free(tails);
+        return -1;
+    }
+
+    queue->buckets = buckets;
+    queue->tails = tails;
+    queue->bucket_count = bucket_count;
+    queue->width = width;
+    queue->grow_threshold = bucket_count * 2;
+    queue->shrink_threshold = bucket_count / 2 - 2;
+    seekTo(queue, queue->last_time);
+    return 0;
+}
+
+// Finds the earliest event and leaves the cursor on its bucket
+static SimEvent *findMin(EventQueue *queue)
+{
+    if (queue->size == 0)
+        return NULL;
+
+    int i = queue->last_bucket;
+    long top = queue->bucket_top;
+
+    for (int pass = 0; pass < queue->bucket_count; pass++)
+    {
+        SimEvent *event = queue->buckets[i];
+        if (event != NULL && event->time < top)
+        {
+            queue->last_bucket = i;
+            queue->bucket_top = top;
+            queue->last_time = event->time;
+            return event;
+        }
+
+        i = (i + 1) % queue->bucket_count;
+        top += queue->width;
+    }
+
+    // Sparse calendar: nothing within a year, fall back to a direct search
+    SimEvent *min = NULL;
+    for (int b = 0; b < queue->bucket_count; b++)
+    {
+        SimEvent *event = queue->buckets[b];
+        if (event != NULL && (min == NULL || eventBefore(event, min)))
+            min = event;
+    }
+
+    seekTo(queue, min->time);
+    return min;
+}
+
+// Estimates a day width from the spacing of the next few events
+static int sampleWidth(EventQueue *queue)
+{
+    SimEvent *sample[WIDTH_SAMPLE_SIZE];
+    int count = 0;
+    int saved_time = queue->last_time;
+
+    while (count < WIDTH_SAMPLE_SIZE && queue->size > 0)
+    {
+        SimEvent *event = findMin(queue);
+        unlinkEvent(queue, event);
+        queue->size--;
+        sample[count++] = event;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        linkEvent(queue, sample[i]);
+        queue->size++;
+    }
+    seekTo(queue, saved_time);
+
+    if (count < 2)
+        return queue->width;
+
+    double average = (double)(sample[count - 1]->time - sample[0]->time) / (count - 1);
+    double total = 0.0;
+    int used = 0;
+    for (int i = 1; i < count; i++)
+    {
+        int gap = sample[i]->time - sample[i - 1]->time;
+        if (gap <= 2.0 * average)
+        {
+            total += gap;
+            used++;
+        }
+    }
+
+    int width = used > 0 ? (int)(3.0 * total / used) : 1;
+    return width > 0 ? width : 1;
+}
+
+static void resize(EventQueue *queue, int bucket_count)
+{
+    if (queue->resizing)
+        return;
+    queue->resizing = true;
+
+    int width = sampleWidth(queue);
+    SimEvent **old_buckets = queue->buckets;
+    SimEvent **old_tails = queue->tails;
+    int old_count = queue->bucket_count;
+
+    if (setBuckets(queue, bucket_count, width) != 0)
+    {
+        queue->resizing = false;
+        return; // Keep the old calendar, it still works, just slower
+    }
+
+    for (int b = 0; b < old_count; b++)
+    {
+        SimEvent *event = old_buckets[b];
+        while (event != NULL)
+        {
+            SimEvent *next = event->next;
+            linkEvent(queue, event);
+            event = next;
+        }
+    }
+
+    free(old_buckets);
+    free(old_tails);
+    queue->resizing = false;
+}
+
+int eventQueueInit(EventQueue *queue)
+{
+    queue->buckets = NULL;
+    queue->tails = NULL;
+    queue->size = 0;
+    queue->last_time = 0;
+    queue->resizing = false;
+    queue->next_seq = 0;
+    queue->free_list = NULL;
+    return setBuckets(queue, INITIAL_BUCKETS, 1);
+}
+
+void eventQueueFree(EventQueue *queue)
+{
+    for (int b = 0; b < queue->bucket_count; b++)
+    {
+        SimEvent *event = queue->buckets[b];
+        while (event != NULL)
+        {
+            SimEvent *next = event->next;
+            free(event);
+            event = next;
+        }
+    }
+
+    while (queue->free_list != NULL)
+    {
+        SimEvent *next = queue->free_list->next;
+        free(queue->free_list);
+        queue->free_list = next;
+    }
+
+    free(queue->buckets);
+    free(queue->tails);
+    queue->buckets = NULL;
+    queue->tails = NULL;
+    queue->size = 0;
+}
+
+SimEvent *eventQueuePush(EventQueue *queue, int time, int type, void *data)
+{
+    SimEvent *event = queue->free_list;
+    if (event != NULL)
+        queue->free_list = event->next;
+    else if ((event = malloc(sizeof(SimEvent))) == NULL)
+        return NULL;
+
+    event->time = time;
+    event->type = type;
+    event->seq = queue->next_seq++;
+    event->data = data;
+
+    if (time < queue->last_time)
+        seekTo(queue, time);
+
+    linkEvent(queue, event);
+    queue->size++;
+
+    if (queue->size > queue->grow_threshold)
+        resize(queue, queue->bucket_count * 2);
+
+    return event;
+}
+
+const SimEvent *eventQueuePeek(EventQueue *queue)
+{
+    return findMin(queue);
+}
+
+SimEvent *eventQueuePop(EventQueue *queue)
+{
+    SimEvent *event = findMin(queue);
+    if (event == NULL)
+        return NULL;
+
+    unlinkEvent(queue, event);
+    queue->size--;
+
+    if (queue->size < queue->shrink_threshold)
+        resize(queue, queue->bucket_count / 2);
+
+    return event;
+}
+
+void eventQueueCancel(EventQueue *queue, SimEvent *event)
+{
+    unlinkEvent(queue, event);
+    queue->size--;
+    eventQueueRelease(queue, event);
+}
+
+void eventQueueRelease(EventQueue *queue, SimEvent *event)
+{
+    event->next = queue->free_list;
+    queue->free_list = event;
+}
+
+void eventQueueVisit(const EventQueue *queue, void (*visit)(void *ctx, const SimEvent *event), void *ctx)
+{
+    for (int b = 0; b < queue->bucket_count; b++)
+    {
+        for (const SimEvent *event = queue->buckets[b]; event != NULL; event = event->next)
+            visit(ctx, event);
+    }
+}
+
+SimEvent *eventQueueRestore(EventQueue *queue, int time, int type, unsigned long seq, void *data)
+{
+    queue->next_seq = seq;
+    return eventQueuePush(queue, time, type, data);
+}
@@ -0,0 +1,68 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdbool.h>
+
+// Event types, in the order they are handled when they share a timestamp:
+// a finishing slice is requeued before tasks back from I/O and same-time
+// arrivals join the queue, and arrivals come before releases so they can
+// still extend the horizon.
+typedef enum
+{
+    SIM_EVENT_SLICE_END,
+    SIM_EVENT_WAKEUP,
+    SIM_EVENT_ARRIVAL,
+    SIM_EVENT_RELEASE,
+    SIM_EVENT_DEADLINE
+} SimEventType;
+
+typedef struct SimEvent
+{
+    int time;
+    int type;
+    unsigned long seq; // FIFO among events with the same time and type
+    void *data;
+    struct SimEvent *prev;
+    struct SimEvent *next;
+} SimEvent;
+
+// Calendar queue (Brown, 1988): an array of day buckets, each holding a short
+// sorted list, whose count and width are resized as the population changes so
+// that enqueue and dequeue are O(1) amortized.
+typedef struct
+{
+    SimEvent **buckets;
+    SimEvent **tails; // Most inserts land at the end of their day
+    int bucket_count;
+    int width;
+    int last_bucket;
+    long bucket_top; // End of the current day of last_bucket
+    int last_time;
+    int size;
+    int grow_threshold;
+    int shrink_threshold;
+    bool resizing;
+    unsigned long next_seq;
+    SimEvent *free_list;
+} EventQueue;
+
+int eventQueueInit(EventQueue *queue);
+void eventQueueFree(EventQueue *queue);
+
+// Returns the queued event so it can later be cancelled, or NULL on failure
+SimEvent *eventQueuePush(EventQueue *queue, int time, int type, void *data);
+
+// Removes the earliest event; the caller hands it back with eventQueueRelease
+SimEvent *eventQueuePop(EventQueue *queue);
+const SimEvent *eventQueuePeek(EventQueue *queue);
+void eventQueueCancel(EventQueue *queue, SimEvent *event);
+void eventQueueRelease(EventQueue *queue, SimEvent *event);
+
+// Calls visit on every queued event, in no particular order
+void eventQueueVisit(const EventQueue *queue, void (*visit)(void *ctx, const SimEvent *event), void *ctx);
+
+// eventQueuePush for an event saved with sequence number `seq`. Saved events
+// must be pushed in increasing seq; later pushes are numbered after them.
+SimEvent *eventQueueRestore(EventQueue *queue, int time, int type, unsigned long seq, void *data);
+
+#endif
@@ -0,0 +1,481 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sched_frontend.h"
+
+#define MAX_LINE_LENGTH 256
+#define SAMPLE_INPUT "input.txt"
+
+void sched_frontend_init(SchedFrontend *fe, SchedPolicy policy)
+{
+    memset(fe, 0, sizeof(SchedFrontend));
+    fe->policy = policy;
+    sched_default_config(policy, &fe->config);
+    sched_sim_default_options(&fe->sim);
+    fe->what_if_divergence = -1;
+}
+
+// --checkpoint=T:FILE
+static void parseCheckpoint(SchedFrontend *fe, const char *arg)
+{
+    int time, consumed = 0;
+    if (sscanf(arg, "%d:%n", &time, &consumed) != 1 || consumed == 0 || time < 0 || arg[consumed] == '\0')
+    {
+        printf("Invalid checkpoint %s, expected TIME:FILE\n", arg);
+        exit(1);
+    }
+    fe->sim.checkpoint_at = time;
+    fe->sim.checkpoint_path = arg + consumed;
+}
+
+// --checkpoint-every=N:PREFIX
+static void parseCheckpointEvery(SchedFrontend *fe, const char *arg)
+{
+    int every, consumed = 0;
+    if (sscanf(arg, "%d:%n", &every, &consumed) != 1 || consumed == 0 || every <= 0 || arg[consumed] == '\0')
+    {
+        printf("Invalid checkpoint interval %s, expected INTERVAL:PREFIX\n", arg);
+        exit(1);
+    }
+    fe->sim.checkpoint_every = every;
+    fe->sim.checkpoint_path = arg + consumed;
+}
+
+static void loadTopology(SchedFrontend *fe, const char *filename)
+{
+    FILE *file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("Error opening topology file %s\n", filename);
+        exit(1);
+    }
+
+    int line_number;
+    if (sched_topology_read(file, &fe->topology, &line_number) != 0)
+    {
+        if (line_number > 0)
+            printf("Invalid topology line %d in %s\n", line_number, filename);
+        else
+            printf("Topology %s must list CPUs 0 to n-1\n", filename);
+        fclose(file);
+        exit(1);
+    }
+
+    fclose(file);
+    fe->sim.topology = &fe->topology;
+}
+
+// The simulator appends to it as the run goes; see sched_log.h
+static void openDecisionLog(SchedFrontend *fe, const char *filename)
+{
+    fe->sim.decision_log = fopen(filename, "wb");
+    if (fe->sim.decision_log == NULL)
+    {
+        printf("Error creating decision log %s\n", filename);
+        exit(1);
+    }
+}
+
+bool sched_frontend_option(SchedFrontend *fe, const char *arg)
+{
+    if (strncmp(arg, "--horizon=", 10) == 0)
+        fe->sim.horizon = atoi(arg + 10);
+    else if (strcmp(arg, "--one-shot") == 0)
+        fe->sim.release_periodic = false;
+    else if (strcmp(arg, "--job-stats") == 0)
+        fe->job_stats = true;
+    else if (strcmp(arg, "--class-stats") == 0)
+        fe->config.class_metrics = true;
+    else if (strncmp(arg, "--switch-cost=", 14) == 0)
+        fe->sim.switch_cost = atoi(arg + 14);
+    else if (strncmp(arg, "--cache-penalty=", 16) == 0)
+        fe->sim.cache_penalty = atoi(arg + 16);
+    else if (strncmp(arg, "--cache-decay=", 14) == 0)
+        fe->sim.cache_decay = atoi(arg + 14);
+    else if (strncmp(arg, "--topology=", 11) == 0)
+        loadTopology(fe, arg + 11);
+    else if (strncmp(arg, "--affinity-wait=", 16) == 0)
+        fe->config.affinity_wait = atoi(arg + 16);
+    else if (strncmp(arg, "--checkpoint=", 13) == 0)
+        parseCheckpoint(fe, arg + 13);
+    else if (strncmp(arg, "--resume=", 9) == 0)
+        fe->resume_path = arg + 9;
+    else if (strncmp(arg, "--checkpoint-every=", 19) == 0)
+        parseCheckpointEvery(fe, arg + 19);
+    else if (strncmp(arg, "--what-if=", 10) == 0)
+        fe->what_if_path = arg + 10;
+    else if (strncmp(arg, "--decision-log=", 15) == 0)
+        openDecisionLog(fe, arg + 15);
+    else if (strncmp(arg, "--", 2) == 0)
+        return false;
+    else
+        fe->input = arg;
+    return true;
+}
+
+bool sched_frontend_check(SchedFrontend *fe)
+{
+    if (fe->sim.checkpoint_every > 0 && fe->sim.checkpoint_at >= 0)
+    {
+        printf("Use either --checkpoint or --checkpoint-every\n");
+        exit(1);
+    }
+    if (fe->what_if_path != NULL && (fe->sim.checkpoint_every <= 0 || fe->resume_path != NULL))
+    {
+        printf("--what-if needs the --checkpoint-every of the baseline run, and no --resume\n");
+        exit(1);
+    }
+
+    if (fe->input == NULL)
+    {
+        if (!fe->sample_input)
+            return false;
+        fe->input = SAMPLE_INPUT;
+        printf("No input file specified. Using default: %s\n", fe->input);
+    }
+
+    if (strcmp(fe->input, "-") == 0 && (fe->sim.checkpoint_path != NULL || fe->resume_path != NULL))
+    {
+        printf("Checkpoints need a process file rather than standard input\n");
+        exit(1);
+    }
+    return true;
+}
+
+Scheduler *sched_frontend_create(SchedFrontend *fe)
+{
+    Scheduler *sched = sched_create(fe->policy, &fe->config);
+    if (sched == NULL)
+    {
+        printf("Failed to create scheduler.\n");
+        exit(1);
+    }
+    return sched;
+}
+
+static void writeSampleInput(const char *filename)
+{
+    FILE *file = fopen(filename, "w");
+    if (file == NULL)
+    {
+        printf("Error creating default input file.\n");
+        return;
+    }
+
+    int n = 10;
+    fprintf(file, "%d\n", n);
+
+    fprintf(file, "1 0 8 20 7 0 5\n");
+    fprintf(file, "2 2 4 15 9 0 8\n");
+    fprintf(file, "3 4 2 10 6 10 3\n");
+    fprintf(file, "4 6 6 25 3 0 4\n");
+    fprintf(file, "5 8 5 0 5 12 6\n");
+    fprintf(file, "6 10 3 18 8 0 7\n");
+    fprintf(file, "7 12 7 30 4 15 5\n");
+    fprintf(file, "8 14 1 17 10 0 9\n");
+    fprintf(file, "9 16 9 0 2 20 2\n");
+    fprintf(file, "10 18 4 25 7 0 6\n");
+
+    fclose(file);
+}
+
+// Reads a process count and that many records into a new array of fresh
+// tasks. With `sample` set, a missing file is first written with a small
+// sample workload.
+static int readProcesses(SchedTask **tasks, const char *filename, bool sample)
+{
+    FILE *file = fopen(filename, "r");
+    if (file == NULL && sample)
+    {
+        printf("Error opening file %s. Creating a default input file...\n", filename);
+        writeSampleInput(filename);
+
+        file = fopen(filename, "r");
+        if (file == NULL)
+        {
+            printf("Failed to create default input file. Exiting...\n");
+            exit(1);
+        }
+        printf("Default input file created successfully.\n");
+    }
+    if (file == NULL)
+    {
+        printf("Error opening file %s\n", filename);
+        exit(1);
+    }
+
+    int n;
+    if (fscanf(file, "%d", &n) != 1)
+    {
+        printf("Error reading number of processes from file.\n");
+        fclose(file);
+        exit(1);
+    }
+
+    if (n <= 0 || n > SCHED_FRONTEND_MAX_PROCESSES)
+    {
+        printf("Invalid number of processes: %d (must be between 1 and %d)\n", n, SCHED_FRONTEND_MAX_PROCESSES);
+        fclose(file);
+        exit(1);
+    }
+
+    *tasks = calloc(n, sizeof(SchedTask));
+    if (*tasks == NULL)
+    {
+        printf("Failed to create scheduler.\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        SchedTask *task = &(*tasks)[i];
+        if (fscanf(file, "%d %d %d %d %d %d %d",
+                   &task->id,
+                   &task->arrival_time,
+                   &task->burst_time,
+                   &task->deadline,
+                   &task->criticality,
+                   &task->period,
+                   &task->system_priority) != 7)
+        {
+            printf("Error reading data for process %d\n", i + 1);
+            fclose(file);
+            exit(1);
+        }
+
+        char phases[MAX_LINE_LENGTH];
+        int status = sched_read_line(file, phases, sizeof(phases));
+        if (status == SCHED_LINE_TOO_LONG)
+        {
+            printf("Over-long line for process %d\n", i + 1);
+            fclose(file);
+            exit(1);
+        }
+        if (status == 0)
+            phases[0] = '\0';
+        int io_work = sched_parse_extensions(phases, &task->io, &task->group, &task->sections, &task->after);
+        if (io_work < 0)
+        {
+            printf("Error reading I/O phases for process %d\n", i + 1);
+            fclose(file);
+            exit(1);
+        }
+        task->burst_time += io_work;
+    }
+
+    fclose(file);
+    return n;
+}
+
+// A what-if run skips the stretch before the first change, which the
+// baseline run already simulated and checkpointed
+static void findDivergence(SchedFrontend *fe)
+{
+    // Never fall back to a sample input for the baseline
+    SchedTask *baseline;
+    int baseline_count = readProcesses(&baseline, fe->what_if_path, false);
+
+    fe->what_if_divergence = baseline_count == fe->n ? sched_sim_divergence(baseline, fe->tasks, fe->n) : -1;
+    free(baseline);
+    if (fe->what_if_divergence < 0)
+    {
+        printf("%s does not list the same processes in the same order.\n", fe->what_if_path);
+        exit(1);
+    }
+}
+
+static void runTasks(SchedFrontend *fe, Scheduler *sched, const SchedSimHooks *hooks)
+{
+    fe->n = readProcesses(&fe->tasks, fe->input, fe->sample_input);
+    if (fe->what_if_path != NULL)
+        findDivergence(fe);
+
+    int status;
+    if (fe->what_if_path != NULL)
+    {
+        status = sched_sim_resume_before(sched, fe->tasks, fe->n, hooks, &fe->sim, fe->what_if_divergence,
+                                         &fe->result);
+        fe->what_if_divergence = fe->result.divergence; // 0 if the baseline ran with other options
+    }
+    else if (fe->resume_path != NULL)
+        status = sched_sim_resume_tasks(sched, fe->tasks, fe->n, hooks, &fe->sim, fe->resume_path, &fe->result);
+    else
+        status = sched_sim_run_tasks(sched, fe->tasks, fe->n, hooks, &fe->sim, &fe->result);
+
+    if (status == SCHED_SIM_BAD_CHECKPOINT)
+    {
+        if (fe->what_if_path != NULL)
+            printf("Cannot resume from %s: not a checkpoint of %s by this program.\n", fe->sim.checkpoint_path,
+                   fe->what_if_path);
+        else if (fe->resume_path != NULL)
+            printf("Cannot resume from %s: not a checkpoint of this input by this program.\n", fe->resume_path);
+        else
+            printf("Cannot write checkpoint %s.\n", fe->sim.checkpoint_path);
+        exit(1);
+    }
+    if (status == SCHED_SIM_BAD_PRECEDENCE)
+    {
+        printf("Predecessors must name other aperiodic processes by a unique id, without cycles.\n");
+        exit(1);
+    }
+    if (status != 0)
+    {
+        printf("Simulation failed.\n");
+        exit(1);
+    }
+}
+
+void sched_frontend_run(SchedFrontend *fe, Scheduler *sched, const SchedSimHooks *hooks)
+{
+    // Streaming prints completion records as jobs finish, and leaves out
+    // rejected jobs
+    if (strcmp(fe->input, "-") == 0)
+    {
+        if (sched_run_stream(sched, stdin, stdout, &fe->sim, &fe->result) != 0)
+        {
+            sched_destroy(sched);
+            exit(1);
+        }
+    }
+    else
+        runTasks(fe, sched, hooks);
+
+    // Metrics cover every job, so they come from the scheduler rather than
+    // the per-process results
+    sched_metrics(sched, fe->result.total_time, &fe->metrics);
+    fe->adaptive_quantum = sched_quantum_stats(sched, &fe->quantum);
+    fe->class_count = sched_class_table(sched, &fe->classes);
+    if (fe->class_count < 0)
+    {
+        printf("Failed to collect class metrics.\n");
+        exit(1);
+    }
+
+    if (fe->config.group_scheduling)
+    {
+        fe->group_count = sched_group_stats(sched, NULL, 0);
+        fe->groups = malloc(sizeof(SchedGroupStats) * (fe->group_count > 0 ? fe->group_count : 1));
+        if (fe->groups == NULL)
+        {
+            printf("Failed to collect group metrics.\n");
+            exit(1);
+        }
+        sched_group_stats(sched, fe->groups, fe->group_count);
+    }
+}
+
+static void writeMetrics(const SchedFrontend *fe)
+{
+    const SchedMetrics *metrics = &fe->metrics;
+    const SchedSimResult *result = &fe->result;
+    const SchedSimOptions *sim = &fe->sim;
+
+    printf("Metric,Value\n");
+    printf("Average Turnaround Time,%.2f\n", metrics->avg_turnaround_time);
+    printf("Average Waiting Time,%.2f\n", metrics->avg_waiting_time);
+    printf("Average Response Time,%.2f\n", metrics->avg_response_time);
+    printf("Throughput,%.2f\n", metrics->throughput);
+    printf("Fairness Index,%.2f\n", metrics->fairness_index);
+    printf("Starvation Count,%d\n", metrics->starvation_count);
+    printf("Load Balancing Efficiency,%.2f\n", metrics->load_balancing_efficiency);
+    printf("Deadline Misses,%ld\n", result->deadline_misses);
+    // Admission control is EDF's
+    if (fe->policy == SCHED_POLICY_EDF)
+        printf("Rejected Jobs,%ld\n", result->rejected);
+    bool cost_model = sim->switch_cost > 0 || sim->cache_penalty > 0;
+    if (cost_model)
+    {
+        printf("Context Switches,%ld\n", result->switches);
+        printf("Switch Overhead,%ld\n", result->switch_time);
+    }
+    if (cost_model || sim->topology != NULL || result->io_waits > 0)
+        printf("CPU Utilization,%.2f\n", sched_sim_utilization(result));
+    if (sim->topology != NULL)
+    {
+        printf("CPUs,%d\n", fe->topology.cpus);
+        printf("Migrations,%ld\n", result->migrations);
+    }
+    if (result->io_waits > 0)
+        printf("I/O Waits,%ld\n", result->io_waits);
+    if (metrics->locks_taken > 0)
+    {
+        printf("Locks Taken,%ld\n", metrics->locks_taken);
+        printf("Lock Waits,%ld\n", metrics->lock_waits);
+        printf("Lock Wait Time,%ld\n", metrics->lock_wait_time);
+        printf("Priority Inversion Time,%ld\n", metrics->inversion_time);
+        printf("Longest Priority Inversion,%d\n", metrics->max_inversion);
+        printf("High-Criticality Avg Turnaround Time,%.2f\n", metrics->avg_critical_turnaround);
+    }
+    if (result->edges > 0)
+    {
+        printf("Precedence Edges,%ld\n", result->edges);
+        printf("Makespan,%d\n", result->total_time);
+    }
+    if (fe->config.preempt_on_arrival)
+        printf("Preemptions,%ld\n", result->preemptions);
+    if (fe->adaptive_quantum)
+    {
+        printf("Controller Steps,%ld\n", fe->quantum.steps);
+        printf("Final Base Quantum,%.2f\n", fe->quantum.base);
+        printf("Base Quantum Range,%.2f-%.2f\n", fe->quantum.min_base, fe->quantum.max_base);
+        if (fe->config.quantum_target == SCHED_QUANTUM_RESPONSE)
+            printf("Windowed P99 Response Time,%.2f\n", fe->quantum.measured);
+        else
+            printf("Windowed Dispatch Rate,%.2f\n", fe->quantum.measured);
+    }
+    if (fe->what_if_path != NULL)
+    {
+        printf("What-If Divergence,%d\n", fe->what_if_divergence);
+        if (result->checkpoint_time >= 0)
+            printf("Resumed From,%d\n", result->checkpoint_time);
+        else
+            printf("Resumed From,Start\n");
+    }
+    else if (sim->checkpoint_path != NULL || fe->resume_path != NULL)
+    {
+        if (result->checkpoint_time >= 0)
+            printf("Checkpoint Time,%d\n", result->checkpoint_time);
+        else
+            printf("Checkpoint Time,Not Reached\n");
+    }
+}
+
+// CPUShare is the group's part of all the CPU time given out
+static void writeGroupStats(const SchedFrontend *fe)
+{
+    long total_cpu = 0;
+    for (int i = 0; i < fe->group_count; i++)
+        total_cpu += fe->groups[i].cpu_time;
+
+    printf("\nGroupID,Shares,CompletedJobs,CPUTime,CPUShare,AvgTurnaroundTime\n");
+    for (int i = 0; i < fe->group_count; i++)
+    {
+        const SchedGroupStats *group = &fe->groups[i];
+        printf("%d,%d,%ld,%ld,%.3f,%.2f\n",
+               group->group,
+               group->shares,
+               group->completed,
+               group->cpu_time,
+               total_cpu > 0 ? (double)group->cpu_time / total_cpu : 0.0,
+               group->completed > 0 ? group->sum_turnaround / group->completed : 0.0);
+    }
+}
+
+void sched_frontend_report(const SchedFrontend *fe)
+{
+    writeMetrics(fe);
+    if (fe->config.class_metrics)
+    {
+        printf("\n");
+        sched_write_class_stats(stdout, fe->classes, fe->class_count);
+    }
+    // Streaming keeps no per-process results
+    if (fe->job_stats && fe->tasks != NULL)
+    {
+        printf("\n");
+        sched_write_job_stats(stdout, fe->tasks, fe->n, fe->policy == SCHED_POLICY_EDF);
+    }
+    if (fe->config.group_scheduling)
+        writeGroupStats(fe);
+}
@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "sched_intake.h"
+
+#define CACHE_LINE_SIZE 64
+
+// Each slot carries a sequence number telling producers and the consumer
+// whose turn it is, so a push is a single CAS on the tail and the consumer
+// never needs one.
+typedef struct
+{
+    atomic_ulong sequence;
+    SchedTask *task;
+} IntakeSlot;
+
+struct SchedIntake
+{
+    _Alignas(CACHE_LINE_SIZE) atomic_ulong tail; // Next slot producers claim
+    _Alignas(CACHE_LINE_SIZE) unsigned long head; // Next slot the consumer reads
+    _Alignas(CACHE_LINE_SIZE) unsigned long mask;
+    IntakeSlot *slots;
+};
+
+SchedIntake *sched_intake_create(int capacity)
+{
+    unsigned long size = 2;
+    while (size < (unsigned long)capacity)
+        size <<= 1;
+
+    SchedIntake *intake = aligned_alloc(CACHE_LINE_SIZE, sizeof(SchedIntake));
+    if (intake == NULL)
+        return NULL;
+
+    intake->slots = malloc(sizeof(IntakeSlot) * size);
+    if (intake->slots == NULL)
+    {
+        free(intake);
+        return NULL;
+    }
+
+    for (unsigned long i = 0; i < size; i++)
+        atomic_init(&intake->slots[i].sequence, i);
+
+    atomic_init(&intake->tail, 0);
+    intake->head = 0;
+    intake->mask = size - 1;
+    return intake;
+}
+
+void sched_intake_destroy(SchedIntake *intake)
+{
+    if (intake == NULL)
+        return;
+
+    free(intake->slots);
+    free(intake);
+}
+
+bool sched_intake_push(SchedIntake *intake, SchedTask *task)
+{
+    unsigned long pos = atomic_load_explicit(&intake->tail, memory_order_relaxed);
+
+    for (;;)
+    {
+        IntakeSlot *slot = &intake->slots[pos & intake->mask];
+        unsigned long sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        long diff = (long)sequence - (long)pos;
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&intake->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                slot->task = task;
+                atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; // Consumer has not freed this slot yet
+        }
+        else
+        {
+            pos = atomic_load_explicit(&intake->tail, memory_order_relaxed);
+        }
+    }
+}
+
+int sched_intake_drain(SchedIntake *intake, Scheduler *sched, int max, SchedRefusedFn refused, void *ctx)
+{
+    int moved = 0;
+
+    while (moved < max)
+    {
+        IntakeSlot *slot = &intake->slots[intake->head & intake->mask];
+        unsigned long sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (sequence != intake->head + 1)
+            break; // Empty, or a producer has claimed the slot but not filled it
+
+        SchedTask *task = slot->task;
+        atomic_store_explicit(&slot->sequence, intake->head + intake->mask + 1, memory_order_release);
+        intake->head++;
+
+        int status = sched_submit(sched, task);
+        if (status != 0 && refused != NULL)
+            refused(ctx, task, status);
+        moved++;
+    }
+
+    return moved;
+}
+
+bool sched_intake_empty(const SchedIntake *intake)
+{
+    const IntakeSlot *slot = &intake->slots[intake->head & intake->mask];
+    return atomic_load_explicit(&slot->sequence, memory_order_acquire) != intake->head + 1;
+}
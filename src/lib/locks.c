@@ -0,0 +1,115 @@
+#include "sched_internal.h"
+
+static int workDone(const SchedTask *task)
+{
+    return task->burst_time - task->remaining_burst;
+}
+
+static int sectionEnd(const SchedCriticalSections *sections, int index)
+{
+    return sections->start[index] + sections->length[index];
+}
+
+// Queues the task behind every waiter at least as critical
+static void addWaiter(SchedResource *resource, SchedTask *task)
+{
+    SchedTask **link = &resource->waiters;
+    while (*link != NULL && (*link)->criticality >= task->criticality)
+        link = &(*link)->waiter_next;
+
+    task->waiter_next = *link;
+    *link = task;
+}
+
+bool acquireSection(Scheduler *sched, SchedTask *task, int now)
+{
+    const SchedCriticalSections *sections = &task->sections;
+    if (task->holding || task->section_next == sections->count ||
+        sections->start[task->section_next] > workDone(task))
+        return true;
+
+    SchedResource *resource = &sched->resources[sections->resource[task->section_next]];
+    if (resource->holder == NULL)
+    {
+        resource->holder = task;
+        task->holding = true;
+        sched->acc.locks_taken++;
+        return true;
+    }
+
+    // Waiting out a held resource is blocking, as far as the policy goes
+    task->lock_since = now;
+    task->lock_inverted = resource->holder->criticality < task->criticality;
+    addWaiter(resource, task);
+    sched->acc.lock_waits++;
+    if (sched->ops->block != NULL)
+        sched->ops->block(sched, task);
+    return false;
+}
+
+bool usesResource(const SchedTask *task, int resource)
+{
+    for (int i = task->section_next; i < task->sections.count; i++)
+    {
+        if (task->sections.resource[i] == resource)
+            return true;
+    }
+    return false;
+}
+
+// A section that runs past the end of the task's work ends with it
+int sched_unlock(Scheduler *sched, SchedTask *task, int now, SchedTask **woken)
+{
+    *woken = NULL;
+    if (!task->holding)
+        return 0;
+
+    int index = task->section_next;
+    if (workDone(task) < sectionEnd(&task->sections, index) && task->remaining_burst > 0)
+        return 0;
+
+    task->holding = false;
+    task->section_next++;
+
+    SchedResource *resource = &sched->resources[task->sections.resource[index]];
+    SchedTask *next = resource->waiters;
+    resource->holder = next;
+    if (next == NULL)
+        return 0;
+
+    resource->waiters = next->waiter_next;
+    next->waiter_next = NULL;
+    next->holding = true;
+
+    MetricAccumulator *acc = &sched->acc;
+    acc->locks_taken++;
+    int waited = now - next->lock_since;
+    acc->lock_wait_time += waited;
+    if (next->lock_inverted)
+    {
+        acc->inversion_time += waited;
+        if (waited > acc->max_inversion)
+            acc->max_inversion = waited;
+    }
+
+    next->ready_since = now;
+    if (sched->ops->wake != NULL)
+        sched->ops->wake(sched, next);
+    if (sched->ops->enqueue(sched, next) != 0)
+        return -1;
+
+    *woken = next;
+    return 0;
+}
+
+int sched_lock_distance(const SchedTask *task)
+{
+    const SchedCriticalSections *sections = &task->sections;
+    if (task->section_next == sections->count)
+        return -1;
+
+    int boundary = task->holding ? sectionEnd(sections, task->section_next)
+                                 : sections->start[task->section_next];
+    int done = workDone(task);
+    return boundary > done ? boundary - done : 0;
+}
@@ -0,0 +1,476 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "sched_internal.h"
+
+#define MIN_NICE_VALUE -20
+#define MAX_NICE_VALUE 19
+#define AFFINITY_SCAN 8 // Tasks looked at past the leftmost for a cache-hot one
+
+// Same mapping as calculateWeight in CFS.c
+static void calculateWeight(SchedTask *task)
+{
+    task->nice = MAX_NICE_VALUE - (task->criticality * 3);
+    if (task->nice < MIN_NICE_VALUE)
+        task->nice = MIN_NICE_VALUE;
+    if (task->nice > MAX_NICE_VALUE)
+        task->nice = MAX_NICE_VALUE;
+
+    task->weight = 1024.0 / (0.8 * task->nice + 1024);
+}
+
+static CfsGroup *findGroup(const Scheduler *sched, int id)
+{
+    if (sched->q.cfs.hash_size == 0)
+        return NULL;
+
+    CfsGroup *group = sched->q.cfs.hash[hashGroup(id, sched->q.cfs.hash_size)];
+    while (group != NULL && group->stats.group != id)
+        group = group->hash_next;
+    return group;
+}
+
+static bool growGroupHash(Scheduler *sched)
+{
+    int size = sched->q.cfs.hash_size > 0 ? sched->q.cfs.hash_size * 2 : 16;
+    CfsGroup **hash = calloc(size, sizeof(CfsGroup *));
+    if (hash == NULL)
+        return false;
+
+    for (int i = 0; i < sched->q.cfs.group_count; i++)
+    {
+        CfsGroup *group = sched->q.cfs.groups[i];
+        unsigned int bucket = hashGroup(group->stats.group, size);
+        group->hash_next = hash[bucket];
+        hash[bucket] = group;
+    }
+
+    free(sched->q.cfs.hash);
+    sched->q.cfs.hash = hash;
+    sched->q.cfs.hash_size = size;
+    return true;
+}
+
+// Returns NULL only when out of memory
+static CfsGroup *lookupGroup(Scheduler *sched, int id)
+{
+    CfsGroup *group = findGroup(sched, id);
+    if (group != NULL)
+        return group;
+
+    if (sched->q.cfs.group_count == sched->q.cfs.group_capacity)
+    {
+        int capacity = sched->q.cfs.group_capacity > 0 ? sched->q.cfs.group_capacity * 2 : 16;
+        CfsGroup **groups = realloc(sched->q.cfs.groups, sizeof(CfsGroup *) * capacity);
+        if (groups == NULL)
+            return NULL;
+        sched->q.cfs.groups = groups;
+        sched->q.cfs.group_capacity = capacity;
+    }
+    if (sched->q.cfs.group_count >= sched->q.cfs.hash_size && !growGroupHash(sched))
+        return NULL;
+
+    group = calloc(1, sizeof(CfsGroup));
+    if (group == NULL)
+        return NULL;
+    rbInit(&group->tree);
+    group->stats.group = id;
+    group->stats.shares = SCHED_DEFAULT_GROUP_SHARES;
+
+    unsigned int bucket = hashGroup(id, sched->q.cfs.hash_size);
+    group->hash_next = sched->q.cfs.hash[bucket];
+    sched->q.cfs.hash[bucket] = group;
+    sched->q.cfs.groups[sched->q.cfs.group_count++] = group;
+    return group;
+}
+
+static void queueGroup(Scheduler *sched, CfsGroup *group)
+{
+    rbInsert(&sched->q.cfs.tree, &group->node, group->vruntime);
+    group->queued = true;
+}
+
+static void dequeueGroup(Scheduler *sched, CfsGroup *group)
+{
+    rbErase(&sched->q.cfs.tree, &group->node);
+    group->queued = false;
+}
+
+// A group with no runnable task left drops its shares until one returns; it
+// then starts no further behind than the groups that kept running, so idle
+// time is not banked as credit
+static void activateGroup(Scheduler *sched, CfsGroup *group, const SchedTask *task)
+{
+    if (group->active++ == 0)
+    {
+        sched->q.cfs.total_weight += group->stats.shares;
+        if (group->vruntime < sched->q.cfs.group_floor)
+            group->vruntime = sched->q.cfs.group_floor;
+    }
+    group->total_weight += task->weight;
+}
+
+static void deactivateGroup(Scheduler *sched, CfsGroup *group, const SchedTask *task)
+{
+    group->total_weight -= task->weight;
+    if (--group->active == 0)
+        sched->q.cfs.total_weight -= group->stats.shares;
+}
+
+static void cfsInit(Scheduler *sched)
+{
+    rbInit(&sched->q.cfs.tree);
+    sched->q.cfs.total_weight = 0.0;
+    sched->q.cfs.groups = NULL;
+    sched->q.cfs.group_count = 0;
+    sched->q.cfs.group_capacity = 0;
+    sched->q.cfs.hash = NULL;
+    sched->q.cfs.hash_size = 0;
+    sched->q.cfs.group_floor = 0.0;
+    sched->q.cfs.ready = 0;
+}
+
+static void cfsDestroy(Scheduler *sched)
+{
+    for (int i = 0; i < sched->q.cfs.group_count; i++)
+        free(sched->q.cfs.groups[i]);
+    free(sched->q.cfs.groups);
+    free(sched->q.cfs.hash);
+}
+
+static bool cfsAdmit(Scheduler *sched, SchedTask *task)
+{
+    calculateWeight(task);
+    if (!sched->config.group_scheduling)
+    {
+        sched->q.cfs.total_weight += task->weight;
+        return true;
+    }
+
+    CfsGroup *group = lookupGroup(sched, task->group);
+    if (group == NULL)
+        return false;
+    activateGroup(sched, group, task);
+    return true;
+}
+
+static int cfsEnqueue(Scheduler *sched, SchedTask *task)
+{
+    if (!sched->config.group_scheduling)
+    {
+        rbInsert(&sched->q.cfs.tree, &task->node, task->vruntime);
+        return 0;
+    }
+
+    CfsGroup *group = findGroup(sched, task->group);
+    rbInsert(&group->tree, &task->node, task->vruntime);
+    if (!group->queued)
+        queueGroup(sched, group);
+    sched->q.cfs.ready++;
+    return 0;
+}
+
+// The leftmost group runs next, and within it the leftmost task. Its slice
+// is the group's share of the latency, split again by weight inside it.
+static SchedTask *pickGrouped(Scheduler *sched, int now)
+{
+    RBTreeNode *first = rbFirst(&sched->q.cfs.tree);
+    if (first == NULL)
+        return NULL;
+    CfsGroup *group = rbEntry(first, CfsGroup, node);
+
+    RBTreeNode *node = rbFirst(&group->tree);
+    for (int scanned = 0; node != NULL; scanned++)
+    {
+        if (scanned == AFFINITY_SCAN)
+            return NULL;
+        if (placementAllows(sched, rbEntry(node, SchedTask, node), now))
+            break;
+        node = rbNext(node);
+    }
+    if (node == NULL)
+        return NULL;
+
+    rbErase(&group->tree, node);
+    sched->q.cfs.ready--;
+    if (group->tree.size == 0)
+        dequeueGroup(sched, group);
+    if (group->vruntime > sched->q.cfs.group_floor)
+        sched->q.cfs.group_floor = group->vruntime;
+
+    SchedTask *task = rbEntry(node, SchedTask, node);
+    double target_latency = fmax(sched->config.min_granularity * sched->live, sched->config.latency);
+    double timeslice = target_latency * (group->stats.shares / sched->q.cfs.total_weight) *
+                       (task->weight / group->total_weight);
+    if (timeslice < 1)
+        timeslice = 1;
+
+    task->slice = (int)timeslice;
+    return task;
+}
+
+static SchedTask *cfsPick(Scheduler *sched, int now)
+{
+    if (sched->config.group_scheduling)
+        return pickGrouped(sched, now);
+
+    RBTreeNode *node = rbFirst(&sched->q.cfs.tree);
+    for (int scanned = 0; node != NULL; scanned++)
+    {
+        if (scanned == AFFINITY_SCAN)
+            return NULL;
+        if (placementAllows(sched, rbEntry(node, SchedTask, node), now))
+            break;
+        node = rbNext(node);
+    }
+    if (node == NULL)
+        return NULL;
+
+    rbErase(&sched->q.cfs.tree, node);
+    SchedTask *task = rbEntry(node, SchedTask, node);
+
+    double target_latency = fmax(sched->config.min_granularity * sched->live, sched->config.latency);
+    double timeslice = (task->weight / sched->q.cfs.total_weight) * target_latency;
+    if (timeslice < 1)
+        timeslice = 1;
+
+    task->slice = (int)timeslice;
+    return task;
+}
+
+static void cfsCharge(Scheduler *sched, SchedTask *task, int ran)
+{
+    task->vruntime += ran / task->weight;
+    if (!sched->config.group_scheduling)
+        return;
+
+    CfsGroup *group = findGroup(sched, task->group);
+    group->vruntime += (double)ran * SCHED_DEFAULT_GROUP_SHARES / group->stats.shares;
+    group->stats.cpu_time += ran;
+    if (group->queued)
+    {
+        dequeueGroup(sched, group);
+        queueGroup(sched, group);
+    }
+}
+
+static void cfsComplete(Scheduler *sched, SchedTask *task)
+{
+    if (!sched->config.group_scheduling)
+    {
+        sched->q.cfs.total_weight -= task->weight;
+        return;
+    }
+
+    CfsGroup *group = findGroup(sched, task->group);
+    deactivateGroup(sched, group, task);
+    group->stats.completed++;
+    group->stats.sum_turnaround += task->turnaround_time;
+}
+
+// A blocked task gives up its share of the slices while it waits
+static void cfsBlock(Scheduler *sched, SchedTask *task)
+{
+    if (sched->config.group_scheduling)
+        deactivateGroup(sched, findGroup(sched, task->group), task);
+    else
+        sched->q.cfs.total_weight -= task->weight;
+}
+
+// Back from I/O, a task resumes at most half a latency behind the leftmost
+// task, so a long wait does not buy it the CPU for just as long
+static void cfsWake(Scheduler *sched, SchedTask *task)
+{
+    RBTree *tree = &sched->q.cfs.tree;
+    if (sched->config.group_scheduling)
+    {
+        CfsGroup *group = findGroup(sched, task->group);
+        activateGroup(sched, group, task);
+        tree = &group->tree;
+    }
+    else
+        sched->q.cfs.total_weight += task->weight;
+
+    RBTreeNode *first = rbFirst(tree);
+    if (first == NULL)
+        return;
+
+    double floor = rbEntry(first, SchedTask, node)->vruntime - sched->config.latency / 2;
+    if (task->vruntime < floor)
+        task->vruntime = floor;
+}
+
+// Entries in order with their keys and tie-breaking sequence numbers, tasks
+// by number and groups by id
+static void saveTree(Checkpoint *ckpt, const RBTree *tree, bool of_groups)
+{
+    checkpointPut(ckpt, &tree->size, sizeof(tree->size));
+    checkpointPut(ckpt, &tree->next_seq, sizeof(tree->next_seq));
+    for (const RBTreeNode *node = rbFirst(tree); node != NULL; node = rbNext(node))
+    {
+        checkpointPut(ckpt, &node->key, sizeof(node->key));
+        checkpointPut(ckpt, &node->seq, sizeof(node->seq));
+        if (of_groups)
+            checkpointPut(ckpt, &rbEntry(node, CfsGroup, node)->stats.group, sizeof(int));
+        else
+            checkpointPutTask(ckpt, rbEntry(node, SchedTask, node));
+    }
+}
+
+// Reinserting each entry under its old sequence number keeps the same order,
+// ties included, whatever shape the tree takes
+static int restoreTree(Scheduler *sched, Checkpoint *ckpt, RBTree *tree, bool of_groups)
+{
+    int size;
+    unsigned long next_seq;
+    checkpointGet(ckpt, &size, sizeof(size));
+    checkpointGet(ckpt, &next_seq, sizeof(next_seq));
+
+    for (int i = 0; i < size && !ckpt->failed; i++)
+    {
+        double key;
+        RBTreeNode *node = NULL;
+        checkpointGet(ckpt, &key, sizeof(key));
+        checkpointGet(ckpt, &tree->next_seq, sizeof(tree->next_seq));
+        if (of_groups)
+        {
+            int id;
+            checkpointGet(ckpt, &id, sizeof(id));
+            CfsGroup *group = findGroup(sched, id);
+            if (group != NULL)
+            {
+                group->queued = true;
+                node = &group->node;
+            }
+        }
+        else
+        {
+            SchedTask *task = checkpointGetTask(ckpt);
+            if (task != NULL)
+                node = &task->node;
+        }
+        if (node == NULL || ckpt->failed)
+            return -1;
+        rbInsert(tree, node, key);
+    }
+
+    tree->next_seq = next_seq;
+    return ckpt->failed ? -1 : 0;
+}
+
+static void cfsSave(const Scheduler *sched, Checkpoint *ckpt)
+{
+    bool grouped = sched->config.group_scheduling;
+    checkpointPut(ckpt, &grouped, sizeof(grouped));
+    checkpointPut(ckpt, &sched->q.cfs.total_weight, sizeof(sched->q.cfs.total_weight));
+    checkpointPut(ckpt, &sched->q.cfs.group_floor, sizeof(sched->q.cfs.group_floor));
+    checkpointPut(ckpt, &sched->q.cfs.ready, sizeof(sched->q.cfs.ready));
+    checkpointPut(ckpt, &sched->q.cfs.group_count, sizeof(sched->q.cfs.group_count));
+
+    for (int i = 0; i < sched->q.cfs.group_count; i++)
+    {
+        const CfsGroup *group = sched->q.cfs.groups[i];
+        checkpointPut(ckpt, &group->vruntime, sizeof(group->vruntime));
+        checkpointPut(ckpt, &group->active, sizeof(group->active));
+        checkpointPut(ckpt, &group->total_weight, sizeof(group->total_weight));
+        checkpointPut(ckpt, &group->stats, sizeof(group->stats));
+        saveTree(ckpt, &group->tree, false);
+    }
+
+    saveTree(ckpt, &sched->q.cfs.tree, grouped);
+}
+
+// Shares set on the fresh scheduler before the restore win over the saved
+// ones, so a run can be forked with different group weights
+static int cfsRestore(Scheduler *sched, Checkpoint *ckpt)
+{
+    bool grouped;
+    int group_count;
+    checkpointGet(ckpt, &grouped, sizeof(grouped));
+    if (ckpt->failed || grouped != sched->config.group_scheduling)
+        return -1;
+    checkpointGet(ckpt, &sched->q.cfs.total_weight, sizeof(sched->q.cfs.total_weight));
+    checkpointGet(ckpt, &sched->q.cfs.group_floor, sizeof(sched->q.cfs.group_floor));
+    checkpointGet(ckpt, &sched->q.cfs.ready, sizeof(sched->q.cfs.ready));
+    checkpointGet(ckpt, &group_count, sizeof(group_count));
+
+    for (int i = 0; i < group_count && !ckpt->failed; i++)
+    {
+        SchedGroupStats stats;
+        double vruntime, total_weight;
+        int active;
+        checkpointGet(ckpt, &vruntime, sizeof(vruntime));
+        checkpointGet(ckpt, &active, sizeof(active));
+        checkpointGet(ckpt, &total_weight, sizeof(total_weight));
+        checkpointGet(ckpt, &stats, sizeof(stats));
+        if (ckpt->failed)
+            return -1;
+
+        bool preset = findGroup(sched, stats.group) != NULL;
+        CfsGroup *group = lookupGroup(sched, stats.group);
+        if (group == NULL)
+            return -1;
+        if (preset)
+            stats.shares = group->stats.shares;
+
+        group->vruntime = vruntime;
+        group->active = active;
+        group->total_weight = total_weight;
+        group->stats = stats;
+        if (restoreTree(sched, ckpt, &group->tree, false) != 0)
+            return -1;
+    }
+
+    if (grouped)
+    {
+        sched->q.cfs.total_weight = 0.0;
+        for (int i = 0; i < sched->q.cfs.group_count; i++)
+        {
+            if (sched->q.cfs.groups[i]->active > 0)
+                sched->q.cfs.total_weight += sched->q.cfs.groups[i]->stats.shares;
+        }
+    }
+
+    return restoreTree(sched, ckpt, &sched->q.cfs.tree, grouped);
+}
+
+const SchedOps cfsOps = {
+    cfsInit,
+    cfsDestroy,
+    cfsAdmit,
+    cfsEnqueue,
+    cfsPick,
+    cfsCharge,
+    cfsComplete,
+    NULL,
+    NULL,
+    cfsBlock,
+    cfsWake,
+    cfsSave,
+    cfsRestore,
+};
+
+int sched_set_group_shares(Scheduler *sched, int group, int shares)
+{
+    if (sched->policy != SCHED_POLICY_CFS || shares <= 0)
+        return -1;
+
+    CfsGroup *entry = lookupGroup(sched, group);
+    if (entry == NULL)
+        return -1;
+
+    if (entry->active > 0)
+        sched->q.cfs.total_weight += shares - entry->stats.shares;
+    entry->stats.shares = shares;
+    return 0;
+}
+
+int sched_group_stats(const Scheduler *sched, SchedGroupStats *stats, int max)
+{
+    if (sched->policy != SCHED_POLICY_CFS)
+        return 0;
+
+    for (int i = 0; i < sched->q.cfs.group_count && i < max; i++)
+        stats[i] = sched->q.cfs.groups[i]->stats;
+    return sched->q.cfs.group_count;
+}
@@ -0,0 +1,345 @@
+#include <math.h>
+#include <string.h>
+
+#include "sched_internal.h"
+
+#define CONTROL_PERIOD 16 // Samples between controller steps
+#define CONTROL_KP 0.5
+#define CONTROL_KI 0.1
+#define CONTROL_RANGE 8.0 // The base quantum stays within a factor of this of base_quantum
+
+static double calculateAgingFactor(const SchedTask *task, int ran, int current_time)
+{
+    int waiting_time = current_time - task->arrival_time - task->blocked_time -
+                       (task->burst_time - task->remaining_burst + ran);
+
+    double aging_factor = waiting_time > 0 ? (double)waiting_time / 10.0 : 0.0;
+    if (aging_factor > 1.0)
+        aging_factor = 1.0;
+
+    return aging_factor;
+}
+
+// Weighted sum of criticality, deadline urgency, aging, system priority and
+// the share of the longest admitted path still ahead of the task. `ran` is
+// work the task has done since it was last charged.
+static double priorityAt(const Scheduler *sched, const SchedTask *task, int ran, int current_time)
+{
+    const SchedConfig *config = &sched->config;
+    double criticality_component = task->criticality / 10.0;
+    double deadline_component = 0.0;
+    if (task->absolute_deadline > 0)
+    {
+        int time_to_deadline = task->absolute_deadline - current_time;
+        if (time_to_deadline <= 0)
+            deadline_component = 1.0;
+        else
+            deadline_component = 1.0 / (1.0 + time_to_deadline);
+    }
+
+    double aging_component = calculateAgingFactor(task, ran, current_time);
+    double system_priority_component = task->dynamic_priority / 10.0;
+
+    double priority = (config->criticality_weight * criticality_component) +
+                      (config->deadline_weight * deadline_component) +
+                      (config->aging_weight * aging_component) +
+                      (config->priority_weight * system_priority_component);
+    if (config->critical_path_weight > 0 && sched->q.dps.longest_path > 0)
+    {
+        double path_component = (double)(task->remaining_burst - ran + task->path_after) /
+                                sched->q.dps.longest_path;
+        priority += config->critical_path_weight * path_component;
+    }
+    return priority;
+}
+
+// Returns the unscaled priority and feeds the scaled value back into
+// dynamic_priority.
+static double calculateDynamicPriority(const Scheduler *sched, SchedTask *task, int current_time)
+{
+    double priority = priorityAt(sched, task, 0, current_time);
+    task->dynamic_priority = (int)(priority * 100);
+    return priority;
+}
+
+// The priority a task with scaled priority `priority` competes at. A task
+// holding a resource runs at least at the priority of the tasks it is holding
+// up: the waiters under inheritance, and under the ceiling protocol also
+// above every ready task that will need the resource.
+static int lockPriority(Scheduler *sched, const SchedTask *task, int priority, int now)
+{
+    if (!task->holding)
+        return priority;
+
+    int resource = task->sections.resource[task->section_next];
+    for (const SchedTask *waiter = sched->resources[resource].waiters; waiter != NULL;
+         waiter = waiter->waiter_next)
+    {
+        int lent = (int)(priorityAt(sched, waiter, 0, now) * 100);
+        if (lent > priority)
+            priority = lent;
+    }
+
+    // The ceiling sits just above the users, so a tie goes to the holder
+    if (sched->config.lock_protocol == SCHED_LOCK_CEILING)
+    {
+        const TaskList *ready = &sched->q.dps.ready;
+        for (int i = 0; i < ready->size; i++)
+        {
+            const SchedTask *user = ready->tasks[i];
+            if (user != task && user->dynamic_priority >= priority && usesResource(user, resource))
+                priority = user->dynamic_priority + 1;
+        }
+    }
+    return priority;
+}
+
+// One PI step on the log of the base quantum. The error is relative to the
+// setpoint and capped at 1, and the integral only moves while the output is
+// inside its range, so a long overload does not wind it up.
+static void controlStep(Scheduler *sched)
+{
+    QuantumControl *control = &sched->q.dps.control;
+    const SchedConfig *config = &sched->config;
+    int n = control->taken < QUANTUM_WINDOW ? (int)control->taken : QUANTUM_WINDOW;
+
+    double measured;
+    if (config->quantum_target == SCHED_QUANTUM_RESPONSE)
+    {
+        memcpy(control->scratch, control->samples, sizeof(int) * n);
+        measured = selectKth(control->scratch, n, (99 * n + 99) / 100 - 1);
+    }
+    else
+    {
+        int newest = control->samples[(control->taken - 1) % QUANTUM_WINDOW];
+        int oldest = control->samples[(control->taken - n) % QUANTUM_WINDOW];
+        int span = newest > oldest ? newest - oldest : 1;
+        measured = (n - 1) * 100.0 / span;
+    }
+
+    // Longer slices mean fewer switches but a later first dispatch, so the
+    // two targets pull the quantum in opposite directions
+    double error = (measured - config->quantum_setpoint) / config->quantum_setpoint;
+    if (error > 1.0)
+        error = 1.0;
+    if (config->quantum_target == SCHED_QUANTUM_RESPONSE)
+        error = -error;
+
+    double limit = log(CONTROL_RANGE);
+    double integral = control->integral + error;
+    double output = CONTROL_KP * error + CONTROL_KI * integral;
+    if (output > limit)
+        output = limit;
+    else if (output < -limit)
+        output = -limit;
+    else
+        control->integral = integral;
+
+    SchedQuantumStats *stats = &control->stats;
+    stats->base = config->base_quantum * exp(output);
+    if (stats->base < stats->min_base)
+        stats->min_base = stats->base;
+    if (stats->base > stats->max_base)
+        stats->max_base = stats->base;
+    stats->measured = measured;
+    stats->steps++;
+}
+
+// A response time when a task is first dispatched, or the dispatch time
+static void controlSample(Scheduler *sched, const SchedTask *task, int now)
+{
+    QuantumControl *control = &sched->q.dps.control;
+    int sample;
+    if (sched->config.quantum_target == SCHED_QUANTUM_RESPONSE)
+    {
+        if (task->executed)
+            return;
+        sample = now - task->arrival_time;
+    }
+    else
+        sample = now;
+
+    control->samples[control->taken % QUANTUM_WINDOW] = sample;
+    control->taken++;
+    if (control->taken % CONTROL_PERIOD == 0)
+        controlStep(sched);
+}
+
+static void dpsInit(Scheduler *sched)
+{
+    sched->q.dps.ready.tasks = NULL;
+    sched->q.dps.ready.size = 0;
+    sched->q.dps.ready.capacity = 0;
+    sched->q.dps.load_factor = 0.0;
+    sched->q.dps.longest_path = 0;
+
+    QuantumControl *control = &sched->q.dps.control;
+    control->taken = 0;
+    control->integral = 0.0;
+    control->stats.base = sched->config.base_quantum;
+    control->stats.min_base = control->stats.base;
+    control->stats.max_base = control->stats.base;
+    control->stats.measured = 0.0;
+    control->stats.steps = 0;
+}
+
+static void dpsDestroy(Scheduler *sched)
+{
+    taskListFree(&sched->q.dps.ready);
+}
+
+static bool dpsAdmit(Scheduler *sched, SchedTask *task)
+{
+    if (task->burst_time + task->path_after > sched->q.dps.longest_path)
+        sched->q.dps.longest_path = task->burst_time + task->path_after;
+    return true;
+}
+
+static int dpsEnqueue(Scheduler *sched, SchedTask *task)
+{
+    return taskListPush(&sched->q.dps.ready, task);
+}
+
+static SchedTask *dpsPick(Scheduler *sched, int now)
+{
+    TaskList *ready = &sched->q.dps.ready;
+    if (ready->size == 0)
+        return NULL;
+
+    sched->q.dps.load_factor = (double)ready->size / sched->submitted;
+
+    // A holder's priority may depend on any other ready task's, so under a
+    // lock protocol every priority is brought up to date first
+    bool lending = sched->config.lock_protocol != SCHED_LOCK_NONE;
+    if (lending)
+    {
+        for (int i = 0; i < ready->size; i++)
+            calculateDynamicPriority(sched, ready->tasks[i], now);
+    }
+
+    // One pass instead of re-sorting the queue: the first task with the
+    // highest priority wins, which is what the stable sort in DPS-DTQ.c picks.
+    int best = -1;
+    int best_effective = 0;
+    double best_priority = 0.0;
+    for (int i = 0; i < ready->size; i++)
+    {
+        double priority = lending ? ready->tasks[i]->dynamic_priority / 100.0
+                                  : calculateDynamicPriority(sched, ready->tasks[i], now);
+        if (!placementAllows(sched, ready->tasks[i], now))
+            continue;
+
+        int effective = ready->tasks[i]->dynamic_priority;
+        if (lending)
+            effective = lockPriority(sched, ready->tasks[i], effective, now);
+        if (best < 0 || effective > best_effective)
+        {
+            best = i;
+            best_effective = effective;
+            best_priority = priority;
+        }
+    }
+    if (best < 0)
+        return NULL;
+
+    SchedTask *task = taskListRemoveAt(ready, best);
+
+    // The ready share of every task ever submitted says little about load
+    // on a long trace; under a target the controller stands in for it
+    double quantum;
+    if (sched->config.quantum_target == SCHED_QUANTUM_FIXED)
+    {
+        quantum = sched->config.base_quantum * (1.0 + best_priority) *
+                  (1.0 - 0.5 * sched->q.dps.load_factor);
+    }
+    else
+    {
+        controlSample(sched, task, now);
+        quantum = sched->q.dps.control.stats.base * (1.0 + best_priority);
+    }
+    task->slice = (int)quantum;
+
+    return task;
+}
+
+static void dpsCharge(Scheduler *sched, SchedTask *task, int ran)
+{
+    (void)sched;
+    (void)task;
+    (void)ran;
+}
+
+static void dpsComplete(Scheduler *sched, SchedTask *task)
+{
+    (void)sched;
+    (void)task;
+}
+
+// The value dpsPick would compare `task` on at `now`, once charged `ran`
+static int pickPriority(Scheduler *sched, const SchedTask *task, int ran, int now)
+{
+    int priority = (int)(priorityAt(sched, task, ran, now) * 100);
+    if (sched->config.lock_protocol == SCHED_LOCK_NONE)
+        return priority;
+    return lockPriority(sched, task, priority, now);
+}
+
+// Both tasks are scored as a pick at `now` would score them, the running one
+// with its slice so far charged, so a cut is only made when that pick would
+// take the new task
+static bool dpsPreempts(Scheduler *sched, const SchedTask *running, int ran, const SchedTask *task, int now)
+{
+    if (!sched->config.preempt_on_arrival || !placementAllows(sched, task, now))
+        return false;
+
+    if (ran > running->burst_left)
+        ran = running->burst_left;
+    return pickPriority(sched, task, 0, now) > pickPriority(sched, running, ran, now);
+}
+
+bool sched_quantum_stats(const Scheduler *sched, SchedQuantumStats *stats)
+{
+    if (sched->policy != SCHED_POLICY_DPS_DTQ || sched->config.quantum_target == SCHED_QUANTUM_FIXED)
+        return false;
+
+    *stats = sched->q.dps.control.stats;
+    return true;
+}
+
+static void dpsSave(const Scheduler *sched, Checkpoint *ckpt)
+{
+    checkpointPutTasks(ckpt, sched->q.dps.ready.tasks, sched->q.dps.ready.size);
+    checkpointPut(ckpt, &sched->q.dps.load_factor, sizeof(sched->q.dps.load_factor));
+    checkpointPut(ckpt, &sched->q.dps.longest_path, sizeof(sched->q.dps.longest_path));
+    checkpointPut(ckpt, &sched->q.dps.control, sizeof(sched->q.dps.control));
+}
+
+static int dpsRestore(Scheduler *sched, Checkpoint *ckpt)
+{
+    TaskList *ready = &sched->q.dps.ready;
+    int size = checkpointGetTasks(ckpt, &ready->tasks, &ready->capacity);
+    if (size < 0)
+        return -1;
+    ready->size = size;
+
+    checkpointGet(ckpt, &sched->q.dps.load_factor, sizeof(sched->q.dps.load_factor));
+    checkpointGet(ckpt, &sched->q.dps.longest_path, sizeof(sched->q.dps.longest_path));
+    checkpointGet(ckpt, &sched->q.dps.control, sizeof(sched->q.dps.control));
+    return ckpt->failed ? -1 : 0;
+}
+
+const SchedOps dpsOps = {
+    dpsInit,
+    dpsDestroy,
+    dpsAdmit,
+    dpsEnqueue,
+    dpsPick,
+    dpsCharge,
+    dpsComplete,
+    dpsPreempts,
+    NULL,
+    NULL,
+    NULL,
+    dpsSave,
+    dpsRestore,
+};
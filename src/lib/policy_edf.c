@@ -0,0 +1,225 @@
+#include <limits.h>
+#include <stdlib.h>
+
+#include "sched_internal.h"
+
+// Jobs without a deadline, and demoted ones, sort after every deadline job
+static int deadlineKey(const SchedTask *task)
+{
+    if (task->absolute_deadline <= 0 || task->demoted)
+        return INT_MAX;
+    return task->absolute_deadline;
+}
+
+static bool edfBefore(const SchedTask *a, const SchedTask *b)
+{
+    int key_a = deadlineKey(a);
+    int key_b = deadlineKey(b);
+    if (key_a != key_b)
+        return key_a < key_b;
+    if (a->arrival_time != b->arrival_time)
+        return a->arrival_time < b->arrival_time;
+    if (a->id != b->id)
+        return a->id < b->id;
+    return a->job < b->job;
+}
+
+static void heapPlace(SchedTask **heap, int index, SchedTask *task)
+{
+    heap[index] = task;
+    task->heap_index = index;
+}
+
+static void siftUp(SchedTask **heap, int index)
+{
+    SchedTask *task = heap[index];
+    while (index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if (!edfBefore(task, heap[parent]))
+            break;
+        heapPlace(heap, index, heap[parent]);
+        index = parent;
+    }
+    heapPlace(heap, index, task);
+}
+
+static void siftDown(SchedTask **heap, int size, int index)
+{
+    SchedTask *task = heap[index];
+    for (;;)
+    {
+        int child = 2 * index + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && edfBefore(heap[child + 1], heap[child]))
+            child++;
+        if (!edfBefore(heap[child], task))
+            break;
+        heapPlace(heap, index, heap[child]);
+        index = child;
+    }
+    heapPlace(heap, index, task);
+}
+
+// Demand a job places on the CPU: its density against the tighter of its
+// relative deadline and its period
+static double jobUtilization(const SchedTask *task)
+{
+    int window = task->deadline;
+    if (task->period > 0 && task->period < window)
+        window = task->period;
+    return (double)task->burst_time / window;
+}
+
+static void edfInit(Scheduler *sched)
+{
+    sched->q.edf.heap = NULL;
+    sched->q.edf.size = 0;
+    sched->q.edf.capacity = 0;
+    sched->q.edf.utilization = 0.0;
+}
+
+static void edfDestroy(Scheduler *sched)
+{
+    free(sched->q.edf.heap);
+    sched->q.edf.heap = NULL;
+    sched->q.edf.size = 0;
+    sched->q.edf.capacity = 0;
+}
+
+// Online utilization test: a deadline job is admitted only while the
+// admitted share stays within the bound
+static bool edfAdmit(Scheduler *sched, SchedTask *task)
+{
+    if (task->absolute_deadline <= 0)
+        return true;
+
+    double utilization = jobUtilization(task);
+    if (sched->config.admission != SCHED_ADMIT_ALL &&
+        sched->q.edf.utilization + utilization > sched->config.utilization_bound)
+    {
+        if (sched->config.admission == SCHED_ADMIT_REJECT)
+            return false;
+        task->demoted = true;
+        return true;
+    }
+
+    task->utilization = utilization;
+    sched->q.edf.utilization += utilization;
+    return true;
+}
+
+static int edfEnqueue(Scheduler *sched, SchedTask *task)
+{
+    if (sched->q.edf.size == sched->q.edf.capacity)
+    {
+        int capacity = sched->q.edf.capacity ? sched->q.edf.capacity * 2 : 16;
+        SchedTask **heap = realloc(sched->q.edf.heap, sizeof(SchedTask *) * capacity);
+        if (heap == NULL)
+            return -1;
+        sched->q.edf.heap = heap;
+        sched->q.edf.capacity = capacity;
+    }
+
+    int index = sched->q.edf.size++;
+    heapPlace(sched->q.edf.heap, index, task);
+    siftUp(sched->q.edf.heap, index);
+    return 0;
+}
+
+// The earliest deadline runs to completion unless a job with an earlier
+// deadline arrives
+static SchedTask *edfPick(Scheduler *sched, int now)
+{
+    (void)now;
+
+    if (sched->q.edf.size == 0)
+        return NULL;
+
+    SchedTask **heap = sched->q.edf.heap;
+    SchedTask *task = heap[0];
+    task->heap_index = -1;
+
+    sched->q.edf.size--;
+    if (sched->q.edf.size > 0)
+    {
+        heapPlace(heap, 0, heap[sched->q.edf.size]);
+        siftDown(heap, sched->q.edf.size, 0);
+    }
+
+    task->slice = task->remaining_burst;
+    return task;
+}
+
+static void edfCharge(Scheduler *sched, SchedTask *task, int ran)
+{
+    (void)sched;
+    (void)task;
+    (void)ran;
+}
+
+static void edfComplete(Scheduler *sched, SchedTask *task)
+{
+    sched->q.edf.utilization -= task->utilization;
+    task->utilization = 0.0;
+}
+
+static bool edfPreempts(Scheduler *sched, const SchedTask *running, int ran, const SchedTask *task, int now)
+{
+    (void)sched;
+    (void)ran;
+    (void)now;
+    return deadlineKey(task) < deadlineKey(running);
+}
+
+// With demotion on, a late job moves to the background and gives up its
+// share, so one overrun cannot push every later deadline back with it
+static void edfExpire(Scheduler *sched, SchedTask *task)
+{
+    if (sched->config.admission != SCHED_ADMIT_DEMOTE || task->demoted)
+        return;
+
+    task->demoted = true;
+    sched->q.edf.utilization -= task->utilization;
+    task->utilization = 0.0;
+
+    if (task->heap_index >= 0)
+        siftDown(sched->q.edf.heap, sched->q.edf.size, task->heap_index);
+}
+
+static void edfSave(const Scheduler *sched, Checkpoint *ckpt)
+{
+    checkpointPutTasks(ckpt, sched->q.edf.heap, sched->q.edf.size);
+    checkpointPut(ckpt, &sched->q.edf.utilization, sizeof(sched->q.edf.utilization));
+}
+
+// The heap comes back in the same slot order, so it needs no rebuilding
+static int edfRestore(Scheduler *sched, Checkpoint *ckpt)
+{
+    int size = checkpointGetTasks(ckpt, &sched->q.edf.heap, &sched->q.edf.capacity);
+    if (size < 0)
+        return -1;
+    sched->q.edf.size = size;
+    for (int i = 0; i < size; i++)
+        sched->q.edf.heap[i]->heap_index = i;
+
+    checkpointGet(ckpt, &sched->q.edf.utilization, sizeof(sched->q.edf.utilization));
+    return ckpt->failed ? -1 : 0;
+}
+
+const SchedOps edfOps = {
+    edfInit,
+    edfDestroy,
+    edfAdmit,
+    edfEnqueue,
+    edfPick,
+    edfCharge,
+    edfComplete,
+    edfPreempts,
+    edfExpire,
+    NULL,
+    NULL,
+    edfSave,
+    edfRestore,
+};
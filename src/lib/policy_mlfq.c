@@ -0,0 +1,217 @@
+#include "sched_internal.h"
+
+// Multi-level feedback queue. Each level is a FIFO and a bitmap marks the
+// non-empty ones, so the next task is always the head of the level given by
+// the lowest set bit. A task starts at level 0 and drops a level once it has
+// used that level's quantum, counted across slices so that giving up the CPU
+// just before the quantum ends does not keep it high. Every boost period all
+// tasks go back to level 0: the queues are spliced onto level 0 at once, and
+// each task resets its own level the next time the policy handles it.
+
+static int boostEpoch(const Scheduler *sched, int now)
+{
+    if (sched->config.mlfq_boost_period <= 0)
+        return 0;
+    return now / sched->config.mlfq_boost_period;
+}
+
+// Puts a task whose level dates from before the last boost back on top
+static void catchUp(Scheduler *sched, SchedTask *task)
+{
+    if (task->boost_epoch == sched->q.mlfq.boost_epoch)
+        return;
+
+    task->level = 0;
+    task->level_used = 0;
+    task->boost_epoch = sched->q.mlfq.boost_epoch;
+}
+
+static void boost(Scheduler *sched)
+{
+    SchedTask **head = sched->q.mlfq.head;
+    SchedTask **tail = sched->q.mlfq.tail;
+
+    for (int level = 1; level < sched->q.mlfq.levels; level++)
+    {
+        if (head[level] == NULL)
+            continue;
+
+        if (head[0] == NULL)
+            head[0] = head[level];
+        else
+            tail[0]->queue_next = head[level];
+        tail[0] = tail[level];
+        head[level] = NULL;
+        tail[level] = NULL;
+    }
+
+    sched->q.mlfq.nonempty = head[0] != NULL ? 1u : 0u;
+}
+
+static void mlfqInit(Scheduler *sched)
+{
+    int levels = sched->config.mlfq_levels;
+    if (levels < 1)
+        levels = 1;
+    if (levels > SCHED_MLFQ_MAX_LEVELS)
+        levels = SCHED_MLFQ_MAX_LEVELS;
+
+    for (int i = 0; i < SCHED_MLFQ_MAX_LEVELS; i++)
+    {
+        sched->q.mlfq.head[i] = NULL;
+        sched->q.mlfq.tail[i] = NULL;
+    }
+    sched->q.mlfq.nonempty = 0;
+    sched->q.mlfq.levels = levels;
+    sched->q.mlfq.size = 0;
+    sched->q.mlfq.boost_epoch = 0;
+}
+
+static void mlfqDestroy(Scheduler *sched)
+{
+    (void)sched;
+}
+
+static bool mlfqAdmit(Scheduler *sched, SchedTask *task)
+{
+    task->level = 0;
+    task->level_used = 0;
+    task->boost_epoch = sched->q.mlfq.boost_epoch;
+    return true;
+}
+
+static int mlfqEnqueue(Scheduler *sched, SchedTask *task)
+{
+    catchUp(sched, task);
+
+    int level = task->level;
+    task->queue_next = NULL;
+    if (sched->q.mlfq.head[level] == NULL)
+        sched->q.mlfq.head[level] = task;
+    else
+        sched->q.mlfq.tail[level]->queue_next = task;
+    sched->q.mlfq.tail[level] = task;
+
+    sched->q.mlfq.nonempty |= 1u << level;
+    sched->q.mlfq.size++;
+    return 0;
+}
+
+static SchedTask *mlfqPick(Scheduler *sched, int now)
+{
+    int epoch = boostEpoch(sched, now);
+    if (epoch != sched->q.mlfq.boost_epoch)
+    {
+        sched->q.mlfq.boost_epoch = epoch;
+        boost(sched);
+    }
+
+    if (sched->q.mlfq.nonempty == 0)
+        return NULL;
+
+    int level = __builtin_ctz(sched->q.mlfq.nonempty);
+    SchedTask *task = sched->q.mlfq.head[level];
+
+    sched->q.mlfq.head[level] = task->queue_next;
+    if (task->queue_next == NULL)
+    {
+        sched->q.mlfq.tail[level] = NULL;
+        sched->q.mlfq.nonempty &= ~(1u << level);
+    }
+    task->queue_next = NULL;
+    sched->q.mlfq.size--;
+
+    catchUp(sched, task);
+    task->slice = sched->config.mlfq_quantum[task->level] - task->level_used;
+    return task;
+}
+
+static void mlfqCharge(Scheduler *sched, SchedTask *task, int ran)
+{
+    task->level_used += ran;
+    if (task->level_used < sched->config.mlfq_quantum[task->level])
+        return;
+
+    task->level_used = 0;
+    if (task->level < sched->q.mlfq.levels - 1)
+        task->level++;
+}
+
+static void mlfqComplete(Scheduler *sched, SchedTask *task)
+{
+    (void)sched;
+    (void)task;
+}
+
+// A task that becomes ready above the running one takes the CPU
+static bool mlfqPreempts(Scheduler *sched, const SchedTask *running, int ran, const SchedTask *task, int now)
+{
+    (void)sched;
+    (void)ran;
+    (void)now;
+    return task->level < running->level;
+}
+
+static void mlfqSave(const Scheduler *sched, Checkpoint *ckpt)
+{
+    checkpointPut(ckpt, &sched->q.mlfq.levels, sizeof(sched->q.mlfq.levels));
+    checkpointPut(ckpt, &sched->q.mlfq.boost_epoch, sizeof(sched->q.mlfq.boost_epoch));
+    for (int level = 0; level < sched->q.mlfq.levels; level++)
+    {
+        int count = 0;
+        for (const SchedTask *task = sched->q.mlfq.head[level]; task != NULL; task = task->queue_next)
+            count++;
+
+        checkpointPut(ckpt, &count, sizeof(count));
+        for (const SchedTask *task = sched->q.mlfq.head[level]; task != NULL; task = task->queue_next)
+            checkpointPutTask(ckpt, task);
+    }
+}
+
+// The saved levels must match, since every task's level points into them
+static int mlfqRestore(Scheduler *sched, Checkpoint *ckpt)
+{
+    int levels;
+    checkpointGet(ckpt, &levels, sizeof(levels));
+    if (ckpt->failed || levels != sched->q.mlfq.levels)
+        return -1;
+    checkpointGet(ckpt, &sched->q.mlfq.boost_epoch, sizeof(sched->q.mlfq.boost_epoch));
+
+    for (int level = 0; level < levels; level++)
+    {
+        int count;
+        checkpointGet(ckpt, &count, sizeof(count));
+        for (int i = 0; i < count && !ckpt->failed; i++)
+        {
+            SchedTask *task = checkpointGetTask(ckpt);
+            if (task == NULL)
+                return -1;
+
+            task->queue_next = NULL;
+            if (sched->q.mlfq.head[level] == NULL)
+                sched->q.mlfq.head[level] = task;
+            else
+                sched->q.mlfq.tail[level]->queue_next = task;
+            sched->q.mlfq.tail[level] = task;
+            sched->q.mlfq.nonempty |= 1u << level;
+            sched->q.mlfq.size++;
+        }
+    }
+    return ckpt->failed ? -1 : 0;
+}
+
+const SchedOps mlfqOps = {
+    mlfqInit,
+    mlfqDestroy,
+    mlfqAdmit,
+    mlfqEnqueue,
+    mlfqPick,
+    mlfqCharge,
+    mlfqComplete,
+    mlfqPreempts,
+    NULL,
+    NULL,
+    NULL,
+    mlfqSave,
+    mlfqRestore,
+};
@@ -0,0 +1,119 @@
+#include <stdlib.h>
+
+#include "sched_internal.h"
+
+static double median(int *values, int n)
+{
+    if (n % 2 == 0)
+        return (selectKth(values, n, n / 2) + selectKth(values, n, n / 2 - 1)) / 2.0;
+    return selectKth(values, n, n / 2);
+}
+
+static void refInit(Scheduler *sched)
+{
+    sched->q.ref.ready.tasks = NULL;
+    sched->q.ref.ready.size = 0;
+    sched->q.ref.ready.capacity = 0;
+    sched->q.ref.scratch = NULL;
+    sched->q.ref.scratch_capacity = 0;
+}
+
+static void refDestroy(Scheduler *sched)
+{
+    taskListFree(&sched->q.ref.ready);
+    free(sched->q.ref.scratch);
+}
+
+static bool refAdmit(Scheduler *sched, SchedTask *task)
+{
+    (void)sched;
+    (void)task;
+    return true;
+}
+
+static int refEnqueue(Scheduler *sched, SchedTask *task)
+{
+    return taskListPush(&sched->q.ref.ready, task);
+}
+
+// Shortest remaining time first; the quantum is the average of the mean and
+// the median remaining time of everything that is ready, as in Reference.c.
+static SchedTask *refPick(Scheduler *sched, int now)
+{
+    TaskList *ready = &sched->q.ref.ready;
+    (void)now;
+
+    if (ready->size == 0)
+        return NULL;
+
+    if (sched->q.ref.scratch_capacity < ready->size)
+    {
+        int *scratch = realloc(sched->q.ref.scratch, sizeof(int) * ready->capacity);
+        if (scratch == NULL)
+            return NULL;
+        sched->q.ref.scratch = scratch;
+        sched->q.ref.scratch_capacity = ready->capacity;
+    }
+
+    int best = 0;
+    long sum = 0;
+    for (int i = 0; i < ready->size; i++)
+    {
+        int remaining = ready->tasks[i]->remaining_burst;
+        sched->q.ref.scratch[i] = remaining;
+        sum += remaining;
+        if (remaining < ready->tasks[best]->remaining_burst)
+            best = i;
+    }
+
+    double mean_bt = (double)sum / ready->size;
+    double median_bt = median(sched->q.ref.scratch, ready->size);
+
+    SchedTask *task = taskListRemoveAt(ready, best);
+    task->slice = (int)((mean_bt + median_bt) / 2);
+    return task;
+}
+
+static void refCharge(Scheduler *sched, SchedTask *task, int ran)
+{
+    (void)sched;
+    (void)task;
+    (void)ran;
+}
+
+static void refComplete(Scheduler *sched, SchedTask *task)
+{
+    (void)sched;
+    (void)task;
+}
+
+static void refSave(const Scheduler *sched, Checkpoint *ckpt)
+{
+    checkpointPutTasks(ckpt, sched->q.ref.ready.tasks, sched->q.ref.ready.size);
+}
+
+static int refRestore(Scheduler *sched, Checkpoint *ckpt)
+{
+    TaskList *ready = &sched->q.ref.ready;
+    int size = checkpointGetTasks(ckpt, &ready->tasks, &ready->capacity);
+    if (size < 0)
+        return -1;
+    ready->size = size;
+    return 0;
+}
+
+const SchedOps refOps = {
+    refInit,
+    refDestroy,
+    refAdmit,
+    refEnqueue,
+    refPick,
+    refCharge,
+    refComplete,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    refSave,
+    refRestore,
+};
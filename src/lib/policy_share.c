@@ -0,0 +1,419 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "sched_internal.h"
+
+// Proportional share by tickets. Stride scheduling runs the task with the
+// lowest pass and advances the pass by the stride (inversely proportional to
+// the tickets) for every unit it ran. Lottery scheduling draws the next task
+// with probability proportional to its tickets.
+
+#define STRIDE_ONE (1L << 20) // Pass advanced per unit of time by a one-ticket task
+
+// Criticality counts ten times as much as the system priority
+static int taskTickets(const SchedTask *task)
+{
+    int tickets = 10 * task->criticality + task->system_priority;
+    return tickets > 0 ? tickets : 1;
+}
+
+static bool strideBefore(const SchedTask *a, const SchedTask *b)
+{
+    if (a->pass != b->pass)
+        return a->pass < b->pass;
+    if (a->arrival_time != b->arrival_time)
+        return a->arrival_time < b->arrival_time;
+    if (a->id != b->id)
+        return a->id < b->id;
+    return a->job < b->job;
+}
+
+static void heapPlace(SchedTask **heap, int index, SchedTask *task)
+{
+    heap[index] = task;
+    task->heap_index = index;
+}
+
+static void siftUp(SchedTask **heap, int index)
+{
+    SchedTask *task = heap[index];
+    while (index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if (!strideBefore(task, heap[parent]))
+            break;
+        heapPlace(heap, index, heap[parent]);
+        index = parent;
+    }
+    heapPlace(heap, index, task);
+}
+
+static void siftDown(SchedTask **heap, int size, int index)
+{
+    SchedTask *task = heap[index];
+    for (;;)
+    {
+        int child = 2 * index + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && strideBefore(heap[child + 1], heap[child]))
+            child++;
+        if (!strideBefore(heap[child], task))
+            break;
+        heapPlace(heap, index, heap[child]);
+        index = child;
+    }
+    heapPlace(heap, index, task);
+}
+
+static void strideInit(Scheduler *sched)
+{
+    sched->q.stride.heap = NULL;
+    sched->q.stride.size = 0;
+    sched->q.stride.capacity = 0;
+    sched->q.stride.pass_floor = 0;
+}
+
+static void strideDestroy(Scheduler *sched)
+{
+    free(sched->q.stride.heap);
+    sched->q.stride.heap = NULL;
+    sched->q.stride.size = 0;
+    sched->q.stride.capacity = 0;
+}
+
+// A new task starts one stride past the last pass picked, so it neither
+// catches up on the time before it arrived nor waits behind everyone
+static bool strideAdmit(Scheduler *sched, SchedTask *task)
+{
+    task->tickets = taskTickets(task);
+    task->pass = sched->q.stride.pass_floor + STRIDE_ONE / task->tickets;
+    return true;
+}
+
+static int strideEnqueue(Scheduler *sched, SchedTask *task)
+{
+    if (sched->q.stride.size == sched->q.stride.capacity)
+    {
+        int capacity = sched->q.stride.capacity ? sched->q.stride.capacity * 2 : 16;
+        SchedTask **heap = realloc(sched->q.stride.heap, sizeof(SchedTask *) * capacity);
+        if (heap == NULL)
+            return -1;
+        sched->q.stride.heap = heap;
+        sched->q.stride.capacity = capacity;
+    }
+
+    int index = sched->q.stride.size++;
+    heapPlace(sched->q.stride.heap, index, task);
+    siftUp(sched->q.stride.heap, index);
+    return 0;
+}
+
+static SchedTask *stridePick(Scheduler *sched, int now)
+{
+    (void)now;
+
+    if (sched->q.stride.size == 0)
+        return NULL;
+
+    SchedTask **heap = sched->q.stride.heap;
+    SchedTask *task = heap[0];
+    task->heap_index = -1;
+
+    sched->q.stride.size--;
+    if (sched->q.stride.size > 0)
+    {
+        heapPlace(heap, 0, heap[sched->q.stride.size]);
+        siftDown(heap, sched->q.stride.size, 0);
+    }
+
+    if (task->pass > sched->q.stride.pass_floor)
+        sched->q.stride.pass_floor = task->pass;
+    task->slice = sched->config.share_quantum;
+    return task;
+}
+
+static void strideCharge(Scheduler *sched, SchedTask *task, int ran)
+{
+    (void)sched;
+    task->pass += STRIDE_ONE / task->tickets * ran;
+}
+
+static void strideComplete(Scheduler *sched, SchedTask *task)
+{
+    (void)sched;
+    (void)task;
+}
+
+// Time spent blocked earns no credit
+static void strideWake(Scheduler *sched, SchedTask *task)
+{
+    if (task->pass < sched->q.stride.pass_floor)
+        task->pass = sched->q.stride.pass_floor;
+}
+
+static void strideSave(const Scheduler *sched, Checkpoint *ckpt)
+{
+    checkpointPutTasks(ckpt, sched->q.stride.heap, sched->q.stride.size);
+    checkpointPut(ckpt, &sched->q.stride.pass_floor, sizeof(sched->q.stride.pass_floor));
+}
+
+static int strideRestore(Scheduler *sched, Checkpoint *ckpt)
+{
+    int size = checkpointGetTasks(ckpt, &sched->q.stride.heap, &sched->q.stride.capacity);
+    if (size < 0)
+        return -1;
+    sched->q.stride.size = size;
+    for (int i = 0; i < size; i++)
+        sched->q.stride.heap[i]->heap_index = i;
+
+    checkpointGet(ckpt, &sched->q.stride.pass_floor, sizeof(sched->q.stride.pass_floor));
+    return ckpt->failed ? -1 : 0;
+}
+
+const SchedOps strideOps = {
+    strideInit,
+    strideDestroy,
+    strideAdmit,
+    strideEnqueue,
+    stridePick,
+    strideCharge,
+    strideComplete,
+    NULL,
+    NULL,
+    NULL,
+    strideWake,
+    strideSave,
+    strideRestore,
+};
+
+// Lottery: every ready task holds a slot in a Fenwick tree of ticket counts,
+// so adding, removing and drawing a task are all O(log n). Freed slots are
+// reused, and the tree doubles (rebuilt in O(n)) when every slot is taken.
+
+static void fenwickAdd(long *tree, int capacity, int slot, long delta)
+{
+    for (int i = slot + 1; i <= capacity; i += i & -i)
+        tree[i] += delta;
+}
+
+// Slot whose ticket range holds the ticket number `draw`
+static int fenwickFind(const long *tree, int capacity, long draw)
+{
+    int slot = 0;
+    for (int step = capacity; step > 0; step >>= 1)
+    {
+        if (slot + step <= capacity && tree[slot + step] <= draw)
+        {
+            slot += step;
+            draw -= tree[slot];
+        }
+    }
+    return slot;
+}
+
+static int lotteryGrow(Scheduler *sched)
+{
+    int capacity = sched->q.lottery.capacity ? sched->q.lottery.capacity * 2 : 16;
+    long *tree = calloc(capacity + 1, sizeof(long));
+    long *value = realloc(sched->q.lottery.value, sizeof(long) * capacity);
+    if (value != NULL)
+        sched->q.lottery.value = value;
+    SchedTask **slots = realloc(sched->q.lottery.slots, sizeof(SchedTask *) * capacity);
+    if (slots != NULL)
+        sched->q.lottery.slots = slots;
+    int *free_slots = realloc(sched->q.lottery.free_slots, sizeof(int) * capacity);
+    if (free_slots != NULL)
+        sched->q.lottery.free_slots = free_slots;
+    if (tree == NULL || value == NULL || slots == NULL || free_slots == NULL)
+    {
+        free(tree);
+        return -1;
+    }
+
+    // Linear build: each node passes its sum up to its parent once
+    int old_capacity = sched->q.lottery.capacity;
+    for (int i = 1; i <= capacity; i++)
+    {
+        if (i <= old_capacity)
+            tree[i] += value[i - 1];
+        int parent = i + (i & -i);
+        if (parent <= capacity)
+            tree[parent] += tree[i];
+    }
+
+    free(sched->q.lottery.tree);
+    sched->q.lottery.tree = tree;
+    sched->q.lottery.capacity = capacity;
+    return 0;
+}
+
+// xorshift64*; deterministic for a given seed
+static unsigned long lotteryRandom(Scheduler *sched)
+{
+    unsigned long x = sched->q.lottery.rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    sched->q.lottery.rng = x;
+    return x * 2685821657736338717UL;
+}
+
+static void lotteryInit(Scheduler *sched)
+{
+    memset(&sched->q.lottery, 0, sizeof(sched->q.lottery));
+    sched->q.lottery.rng = sched->config.lottery_seed != 0 ? sched->config.lottery_seed : 1;
+}
+
+static void lotteryDestroy(Scheduler *sched)
+{
+    free(sched->q.lottery.tree);
+    free(sched->q.lottery.value);
+    free(sched->q.lottery.slots);
+    free(sched->q.lottery.free_slots);
+    memset(&sched->q.lottery, 0, sizeof(sched->q.lottery));
+}
+
+static bool lotteryAdmit(Scheduler *sched, SchedTask *task)
+{
+    (void)sched;
+    task->tickets = taskTickets(task);
+    task->quantum_used = 0;
+    return true;
+}
+
+// A task that gave up the CPU early holds compensation tickets until it next
+// wins, in proportion to the part of its quantum it left unused
+static int lotteryEnqueue(Scheduler *sched, SchedTask *task)
+{
+    int slot;
+    if (sched->q.lottery.free_count > 0)
+        slot = sched->q.lottery.free_slots[--sched->q.lottery.free_count];
+    else
+    {
+        if (sched->q.lottery.used == sched->q.lottery.capacity && lotteryGrow(sched) != 0)
+            return -1;
+        slot = sched->q.lottery.used++;
+    }
+
+    long tickets = task->tickets;
+    int quantum = sched->config.share_quantum;
+    if (task->quantum_used > 0 && task->quantum_used < quantum)
+        tickets = tickets * quantum / task->quantum_used;
+
+    sched->q.lottery.value[slot] = tickets;
+    sched->q.lottery.slots[slot] = task;
+    fenwickAdd(sched->q.lottery.tree, sched->q.lottery.capacity, slot, tickets);
+    sched->q.lottery.total += tickets;
+    sched->q.lottery.size++;
+    return 0;
+}
+
+static SchedTask *lotteryPick(Scheduler *sched, int now)
+{
+    (void)now;
+
+    if (sched->q.lottery.size == 0)
+        return NULL;
+
+    long draw = (long)(lotteryRandom(sched) % (unsigned long)sched->q.lottery.total);
+    int slot = fenwickFind(sched->q.lottery.tree, sched->q.lottery.capacity, draw);
+    SchedTask *task = sched->q.lottery.slots[slot];
+    long tickets = sched->q.lottery.value[slot];
+
+    fenwickAdd(sched->q.lottery.tree, sched->q.lottery.capacity, slot, -tickets);
+    sched->q.lottery.value[slot] = 0;
+    sched->q.lottery.slots[slot] = NULL;
+    sched->q.lottery.free_slots[sched->q.lottery.free_count++] = slot;
+    sched->q.lottery.total -= tickets;
+    sched->q.lottery.size--;
+
+    task->slice = sched->config.share_quantum;
+    return task;
+}
+
+static void lotteryCharge(Scheduler *sched, SchedTask *task, int ran)
+{
+    (void)sched;
+    task->quantum_used = ran;
+}
+
+static void lotteryComplete(Scheduler *sched, SchedTask *task)
+{
+    (void)sched;
+    (void)task;
+}
+
+static void lotterySave(const Scheduler *sched, Checkpoint *ckpt)
+{
+    int capacity = sched->q.lottery.capacity;
+    int used = sched->q.lottery.used;
+    checkpointPut(ckpt, &capacity, sizeof(capacity));
+    checkpointPut(ckpt, &used, sizeof(used));
+    checkpointPut(ckpt, &sched->q.lottery.size, sizeof(sched->q.lottery.size));
+    checkpointPut(ckpt, &sched->q.lottery.total, sizeof(sched->q.lottery.total));
+    checkpointPut(ckpt, &sched->q.lottery.rng, sizeof(sched->q.lottery.rng));
+    checkpointPut(ckpt, &sched->q.lottery.free_count, sizeof(sched->q.lottery.free_count));
+    if (capacity == 0)
+        return;
+
+    checkpointPut(ckpt, sched->q.lottery.tree, sizeof(long) * (capacity + 1));
+    checkpointPut(ckpt, sched->q.lottery.value, sizeof(long) * capacity);
+    checkpointPut(ckpt, sched->q.lottery.free_slots, sizeof(int) * sched->q.lottery.free_count);
+    for (int i = 0; i < used; i++)
+        checkpointPutTask(ckpt, sched->q.lottery.slots[i]);
+}
+
+// Takes the tree and slots as they were, so the draws carry on unchanged
+static int lotteryRestore(Scheduler *sched, Checkpoint *ckpt)
+{
+    int capacity, used;
+    checkpointGet(ckpt, &capacity, sizeof(capacity));
+    checkpointGet(ckpt, &used, sizeof(used));
+    checkpointGet(ckpt, &sched->q.lottery.size, sizeof(sched->q.lottery.size));
+    checkpointGet(ckpt, &sched->q.lottery.total, sizeof(sched->q.lottery.total));
+    checkpointGet(ckpt, &sched->q.lottery.rng, sizeof(sched->q.lottery.rng));
+    checkpointGet(ckpt, &sched->q.lottery.free_count, sizeof(sched->q.lottery.free_count));
+    if (ckpt->failed || capacity < 0 || used < 0 || used > capacity ||
+        sched->q.lottery.free_count < 0 || sched->q.lottery.free_count > used)
+        return -1;
+
+    if ((capacity & (capacity - 1)) != 0)
+        return -1;
+    if (capacity == 0)
+        return 0;
+
+    // Fresh from init, so there is nothing to free first
+    sched->q.lottery.tree = calloc(capacity + 1, sizeof(long));
+    sched->q.lottery.value = calloc(capacity, sizeof(long));
+    sched->q.lottery.slots = calloc(capacity, sizeof(SchedTask *));
+    sched->q.lottery.free_slots = calloc(capacity, sizeof(int));
+    if (sched->q.lottery.tree == NULL || sched->q.lottery.value == NULL ||
+        sched->q.lottery.slots == NULL || sched->q.lottery.free_slots == NULL)
+        return -1;
+    sched->q.lottery.capacity = capacity;
+
+    checkpointGet(ckpt, sched->q.lottery.tree, sizeof(long) * (capacity + 1));
+    checkpointGet(ckpt, sched->q.lottery.value, sizeof(long) * capacity);
+    checkpointGet(ckpt, sched->q.lottery.free_slots, sizeof(int) * sched->q.lottery.free_count);
+    for (int i = 0; i < used; i++)
+        sched->q.lottery.slots[i] = checkpointGetTask(ckpt);
+    sched->q.lottery.used = used;
+    return ckpt->failed ? -1 : 0;
+}
+
+const SchedOps lotteryOps = {
+    lotteryInit,
+    lotteryDestroy,
+    lotteryAdmit,
+    lotteryEnqueue,
+    lotteryPick,
+    lotteryCharge,
+    lotteryComplete,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    lotterySave,
+    lotteryRestore,
+};
@@ -0,0 +1,353 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "sched_pool.h"
+#include "sched_intake.h"
+
+#define LATENCY_BUCKETS 64
+#define INTAKE_CAPACITY 4096
+#define INTAKE_BATCH 256
+
+typedef struct
+{
+    SchedWorkFn fn;
+    void *arg;
+    long submit_ns;
+} PoolItem;
+
+struct SchedPool
+{
+    Scheduler *sched;
+    SchedIntake *intake; // Producers submit here without taking the lock
+    long unit_ns;
+    long start_ns;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t all_done;
+    pthread_t *threads;
+    int workers;
+    bool shutdown;
+    atomic_int idle_workers;
+    atomic_long outstanding;
+
+    long completed;
+    long rejected;
+    long dispatches;
+    long last_completion_ns;
+    double sum_latency_ns;
+    long max_latency_ns;
+    long latency_histogram[LATENCY_BUCKETS];
+    double lock_wait_ns;
+    double work_ns;
+    double busy_ns;
+};
+
+static long monotonicNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+// Converts wall-clock time to scheduler units since the pool started
+static int poolNow(const SchedPool *pool, long ns)
+{
+    return (int)((ns - pool->start_ns) / pool->unit_ns);
+}
+
+static int log2Bucket(long value)
+{
+    int bucket = 0;
+    while (value > 1 && bucket < LATENCY_BUCKETS - 1)
+    {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+// Lock and account for the time spent waiting on it
+static void poolLock(SchedPool *pool)
+{
+    long before = monotonicNs();
+    pthread_mutex_lock(&pool->lock);
+    pool->lock_wait_ns += monotonicNs() - before;
+}
+
+// An item the scheduler refused, or could not take back onto its run queue,
+// is dropped unfinished; it is done as far as sched_pool_wait is concerned.
+// Called with the lock held.
+static void refuseItem(void *ctx, SchedTask *task, int status)
+{
+    SchedPool *pool = ctx;
+    (void)status;
+
+    free(task->user_data);
+    task->user_data = NULL;
+    pool->rejected++;
+
+    if (atomic_fetch_sub(&pool->outstanding, 1) == 1)
+        pthread_cond_broadcast(&pool->all_done);
+}
+
+static void *workerMain(void *data)
+{
+    SchedPool *pool = data;
+
+    poolLock(pool);
+    for (;;)
+    {
+        SchedTask *task = NULL;
+        while (!pool->shutdown)
+        {
+            // Whoever holds the lock is the intake's single consumer
+            sched_intake_drain(pool->intake, pool->sched, INTAKE_BATCH, refuseItem, pool);
+            task = sched_pick_next(pool->sched, poolNow(pool, monotonicNs()));
+            if (task != NULL)
+                break;
+
+            // Advertise idleness before the final check. With the fence in
+            // sched_pool_submit, either this check sees the pushed task or
+            // the producer sees the idle worker and signals; without both
+            // fences the store and the load on each side may pass each other.
+            atomic_fetch_add(&pool->idle_workers, 1);
+            atomic_thread_fence(memory_order_seq_cst);
+            if (sched_intake_empty(pool->intake))
+                pthread_cond_wait(&pool->work_ready, &pool->lock);
+            atomic_fetch_sub(&pool->idle_workers, 1);
+        }
+        if (task == NULL)
+            break;
+
+        pool->dispatches++;
+        PoolItem *item = task->user_data;
+        long budget_ns = task->slice * pool->unit_ns;
+        long dispatch_ns = monotonicNs();
+        pthread_mutex_unlock(&pool->lock);
+
+        long run_start = monotonicNs();
+        bool finished = item->fn(item->arg, budget_ns);
+        long run_end = monotonicNs();
+
+        int ran = (int)((run_end - run_start + pool->unit_ns - 1) / pool->unit_ns);
+        if (ran < 1)
+            ran = 1;
+
+        poolLock(pool);
+        pool->work_ns += run_end - run_start;
+
+        if (finished)
+        {
+            // Report exactly what was used so the task completes now
+            task->burst_time -= task->remaining_burst - ran;
+            task->remaining_burst = ran;
+            task->burst_left = ran;
+        }
+        else if (task->remaining_burst <= ran)
+        {
+            // Longer than the caller estimated, keep it runnable
+            task->burst_time += ran - task->remaining_burst + 1;
+            task->remaining_burst = ran + 1;
+            task->burst_left = ran + 1;
+        }
+
+        int requeued = sched_charge(pool->sched, task, ran);
+        if (requeued == 0)
+        {
+            sched_complete(pool->sched, task, poolNow(pool, run_end));
+
+            long latency = run_end - item->submit_ns;
+            pool->completed++;
+            pool->sum_latency_ns += latency;
+            if (latency > pool->max_latency_ns)
+                pool->max_latency_ns = latency;
+            pool->latency_histogram[log2Bucket(latency)]++;
+            pool->last_completion_ns = run_end;
+            free(item);
+
+            if (atomic_fetch_sub(&pool->outstanding, 1) == 1)
+                pthread_cond_broadcast(&pool->all_done);
+        }
+        else if (requeued < 0)
+        {
+            refuseItem(pool, task, -1);
+        }
+        else
+        {
+            pthread_cond_signal(&pool->work_ready);
+        }
+
+        pool->busy_ns += monotonicNs() - dispatch_ns;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+SchedPool *sched_pool_create(SchedPolicy policy, const SchedConfig *config, int workers, long unit_ns)
+{
+    if (workers < 1 || unit_ns < 1)
+        return NULL;
+
+    SchedPool *pool = calloc(1, sizeof(SchedPool));
+    if (pool == NULL)
+        return NULL;
+
+    pool->sched = sched_create(policy, config);
+    pool->intake = sched_intake_create(INTAKE_CAPACITY);
+    pool->threads = malloc(sizeof(pthread_t) * workers);
+    if (pool->sched == NULL || pool->intake == NULL || pool->threads == NULL)
+    {
+        sched_destroy(pool->sched);
+        sched_intake_destroy(pool->intake);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+
+    pool->unit_ns = unit_ns;
+    pool->start_ns = monotonicNs();
+    atomic_init(&pool->idle_workers, 0);
+    atomic_init(&pool->outstanding, 0);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+
+    for (int i = 0; i < workers; i++)
+    {
+        if (pthread_create(&pool->threads[i], NULL, workerMain, pool) != 0)
+            break;
+        pool->workers++;
+    }
+
+    if (pool->workers == 0)
+    {
+        sched_pool_destroy(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+int sched_pool_submit(SchedPool *pool, SchedTask *task, SchedWorkFn fn, void *arg)
+{
+    PoolItem *item = malloc(sizeof(PoolItem));
+    if (item == NULL)
+        return -1;
+
+    item->fn = fn;
+    item->arg = arg;
+    item->submit_ns = monotonicNs();
+
+    // A work item does its own blocking, locking and ordering, so it is one
+    // independent CPU burst to the policy
+    if (task->burst_time < 1)
+        task->burst_time = 1;
+    task->io.count = 0;
+    task->sections.count = 0;
+    task->after.count = 0;
+    task->path_after = 0;
+    task->user_data = item;
+    task->arrival_time = poolNow(pool, item->submit_ns);
+
+    atomic_fetch_add(&pool->outstanding, 1);
+    while (!sched_intake_push(pool->intake, task))
+        sched_yield(); // Ring full, let the workers catch up
+
+    // Only touch the lock when a worker may be asleep; the fence pairs with
+    // the one in workerMain
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&pool->idle_workers) > 0)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_signal(&pool->work_ready);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return 0;
+}
+
+void sched_pool_wait(SchedPool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load(&pool->outstanding) > 0)
+        pthread_cond_wait(&pool->all_done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void sched_pool_stats(SchedPool *pool, SchedPoolStats *stats)
+{
+    memset(stats, 0, sizeof(SchedPoolStats));
+
+    pthread_mutex_lock(&pool->lock);
+
+    long end_ns = pool->completed > 0 ? pool->last_completion_ns : monotonicNs();
+    stats->completed = pool->completed;
+    stats->rejected = pool->rejected;
+    stats->dispatches = pool->dispatches;
+    stats->wall_seconds = (end_ns - pool->start_ns) / 1e9;
+    if (stats->wall_seconds > 0)
+        stats->throughput = pool->completed / stats->wall_seconds;
+
+    if (pool->completed > 0)
+    {
+        stats->avg_latency_ms = pool->sum_latency_ns / pool->completed / 1e6;
+        stats->max_latency_ms = pool->max_latency_ns / 1e6;
+
+        long target = (long)(pool->completed * 0.99);
+        long seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; i++)
+        {
+            seen += pool->latency_histogram[i];
+            if (seen > target || i == LATENCY_BUCKETS - 1)
+            {
+                stats->p99_latency_ms = (double)(1L << (i + 1 < 62 ? i + 1 : 62)) / 1e6;
+                if (stats->p99_latency_ms > stats->max_latency_ms)
+                    stats->p99_latency_ms = stats->max_latency_ms;
+                break;
+            }
+        }
+    }
+
+    if (pool->dispatches > 0)
+        stats->avg_lock_wait_us = pool->lock_wait_ns / pool->dispatches / 1e3;
+    if (pool->busy_ns > 0)
+        stats->scheduler_overhead = 1.0 - pool->work_ns / pool->busy_ns;
+
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void sched_pool_metrics(SchedPool *pool, SchedMetrics *metrics)
+{
+    pthread_mutex_lock(&pool->lock);
+    long end_ns = pool->completed > 0 ? pool->last_completion_ns : monotonicNs();
+    sched_metrics(pool->sched, poolNow(pool, end_ns), metrics);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void sched_pool_destroy(SchedPool *pool)
+{
+    if (pool == NULL)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->workers; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_cond_destroy(&pool->all_done);
+    sched_destroy(pool->sched);
+    sched_intake_destroy(pool->intake);
+    free(pool->threads);
+    free(pool);
+}
@@ -0,0 +1,311 @@
+#include "rbtree.h"
+
+static int nodeLess(const RBTreeNode *a, const RBTreeNode *b)
+{
+    if (a->key != b->key)
+        return a->key < b->key;
+    return a->seq < b->seq;
+}
+
+static int colorOf(const RBTreeNode *node)
+{
+    return node == NULL ? RB_BLACK : node->color;
+}
+
+static void rotateLeft(RBTree *tree, RBTreeNode *x)
+{
+    RBTreeNode *y = x->right;
+    x->right = y->left;
+    if (y->left != NULL)
+        y->left->parent = x;
+
+    y->parent = x->parent;
+    if (x->parent == NULL)
+        tree->root = y;
+    else if (x == x->parent->left)
+        x->parent->left = y;
+    else
+        x->parent->right = y;
+
+    y->left = x;
+    x->parent = y;
+}
+
+static void rotateRight(RBTree *tree, RBTreeNode *x)
+{
+    RBTreeNode *y = x->left;
+    x->left = y->right;
+    if (y->right != NULL)
+        y->right->parent = x;
+
+    y->parent = x->parent;
+    if (x->parent == NULL)
+        tree->root = y;
+    else if (x == x->parent->right)
+        x->parent->right = y;
+    else
+        x->parent->left = y;
+
+    y->right = x;
+    x->parent = y;
+}
+
+void rbInit(RBTree *tree)
+{
+    tree->root = NULL;
+    tree->leftmost = NULL;
+    tree->next_seq = 0;
+    tree->size = 0;
+}
+
+void rbInsert(RBTree *tree, RBTreeNode *node, double key)
+{
+    RBTreeNode *parent = NULL;
+    RBTreeNode **link = &tree->root;
+    int leftmost = 1;
+
+    node->key = key;
+    node->seq = tree->next_seq++;
+
+    while (*link != NULL)
+    {
+        parent = *link;
+        if (nodeLess(node, parent))
+        {
+            link = &parent->left;
+        }
+        else
+        {
+            link = &parent->right;
+            leftmost = 0;
+        }
+    }
+
+    node->parent = parent;
+    node->left = NULL;
+    node->right = NULL;
+    node->color = RB_RED;
+    *link = node;
+
+    if (leftmost)
+        tree->leftmost = node;
+    tree->size++;
+
+    while (node != tree->root && colorOf(node->parent) == RB_RED)
+    {
+        RBTreeNode *p = node->parent;
+        RBTreeNode *g = p->parent;
+
+        if (p == g->left)
+        {
+            RBTreeNode *uncle = g->right;
+            if (colorOf(uncle) == RB_RED)
+            {
+                p->color = RB_BLACK;
+                uncle->color = RB_BLACK;
+                g->color = RB_RED;
+                node = g;
+                continue;
+            }
+            if (node == p->right)
+            {
+                rotateLeft(tree, p);
+                node = p;
+                p = node->parent;
+            }
+            p->color = RB_BLACK;
+            g->color = RB_RED;
+            rotateRight(tree, g);
+        }
+        else
+        {
+            RBTreeNode *uncle = g->left;
+            if (colorOf(uncle) == RB_RED)
+            {
+                p->color = RB_BLACK;
+                uncle->color = RB_BLACK;
+                g->color = RB_RED;
+                node = g;
+                continue;
+            }
+            if (node == p->left)
+            {
+                rotateRight(tree, p);
+                node = p;
+                p = node->parent;
+            }
+            p->color = RB_BLACK;
+            g->color = RB_RED;
+            rotateLeft(tree, g);
+        }
+    }
+
+    tree->root->color = RB_BLACK;
+}
+
+static void transplant(RBTree *tree, RBTreeNode *u, RBTreeNode *v)
+{
+    if (u->parent == NULL)
+        tree->root = v;
+    else if (u == u->parent->left)
+        u->parent->left = v;
+    else
+        u->parent->right = v;
+
+    if (v != NULL)
+        v->parent = u->parent;
+}
+
+static void eraseFixup(RBTree *tree, RBTreeNode *x, RBTreeNode *parent)
+{
+    while (x != tree->root && colorOf(x) == RB_BLACK)
+    {
+        if (x == parent->left)
+        {
+            RBTreeNode *w = parent->right;
+            if (colorOf(w) == RB_RED)
+            {
+                w->color = RB_BLACK;
+                parent->color = RB_RED;
+                rotateLeft(tree, parent);
+                w = parent->right;
+            }
+            if (colorOf(w->left) == RB_BLACK && colorOf(w->right) == RB_BLACK)
+            {
+                w->color = RB_RED;
+                x = parent;
+                parent = x->parent;
+            }
+            else
+            {
+                if (colorOf(w->right) == RB_BLACK)
+                {
+                    w->left->color = RB_BLACK;
+                    w->color = RB_RED;
+                    rotateRight(tree, w);
+                    w = parent->right;
+                }
+                w->color = parent->color;
+                parent->color = RB_BLACK;
+                if (w->right != NULL)
+                    w->right->color = RB_BLACK;
+                rotateLeft(tree, parent);
+                x = tree->root;
+                parent = NULL;
+            }
+        }
+        else
+        {
+            RBTreeNode *w = parent->left;
+            if (colorOf(w) == RB_RED)
+            {
+                w->color = RB_BLACK;
+                parent->color = RB_RED;
+                rotateRight(tree, parent);
+                w = parent->left;
+            }
+            if (colorOf(w->right) == RB_BLACK && colorOf(w->left) == RB_BLACK)
+            {
+                w->color = RB_RED;
+                x = parent;
+                parent = x->parent;
+            }
+            else
+            {
+                if (colorOf(w->left) == RB_BLACK)
+                {
+                    w->right->color = RB_BLACK;
+                    w->color = RB_RED;
+                    rotateLeft(tree, w);
+                    w = parent->left;
+                }
+                w->color = parent->color;
+                parent->color = RB_BLACK;
+                if (w->left != NULL)
+                    w->left->color = RB_BLACK;
+                rotateRight(tree, parent);
+                x = tree->root;
+                parent = NULL;
+            }
+        }
+    }
+
+    if (x != NULL)
+        x->color = RB_BLACK;
+}
+
+void rbErase(RBTree *tree, RBTreeNode *node)
+{
+    RBTreeNode *x;
+    RBTreeNode *x_parent;
+    int removed_color = node->color;
+
+    if (tree->leftmost == node)
+        tree->leftmost = rbNext(node);
+
+    if (node->left == NULL)
+    {
+        x = node->right;
+        x_parent = node->parent;
+        transplant(tree, node, node->right);
+    }
+    else if (node->right == NULL)
+    {
+        x = node->left;
+        x_parent = node->parent;
+        transplant(tree, node, node->left);
+    }
+    else
+    {
+        RBTreeNode *y = node->right;
+        while (y->left != NULL)
+            y = y->left;
+
+        removed_color = y->color;
+        x = y->right;
+
+        if (y->parent == node)
+        {
+            x_parent = y;
+        }
+        else
+        {
+            x_parent = y->parent;
+            transplant(tree, y, y->right);
+            y->right = node->right;
+            y->right->parent = y;
+        }
+
+        transplant(tree, node, y);
+        y->left = node->left;
+        y->left->parent = y;
+        y->color = node->color;
+    }
+
+    if (removed_color == RB_BLACK)
+        eraseFixup(tree, x, x_parent);
+
+    node->left = node->right = node->parent = NULL;
+    tree->size--;
+}
+
+RBTreeNode *rbFirst(const RBTree *tree)
+{
+    return tree->leftmost;
+}
+
+RBTreeNode *rbNext(const RBTreeNode *node)
+{
+    if (node->right != NULL)
+    {
+        node = node->right;
+        while (node->left != NULL)
+            node = node->left;
+        return (RBTreeNode *)node;
+    }
+
+    while (node->parent != NULL && node == node->parent->right)
+        node = node->parent;
+
+    return node->parent;
+}
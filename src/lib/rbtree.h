@@ -0,0 +1,37 @@
+#ifndef RBTREE_H
+#define RBTREE_H
+
+#include <stddef.h>
+
+#define RB_RED 1
+#define RB_BLACK 0
+
+// Recover the structure that embeds a tree node
+#define rbEntry(node, type, member) ((type *)((char *)(node) - offsetof(type, member)))
+
+// Intrusive red-black tree node ordered by (key, seq)
+typedef struct RBTreeNode
+{
+    double key;
+    unsigned long seq; // Insertion order, breaks ties so equal keys stay FIFO
+    struct RBTreeNode *left;
+    struct RBTreeNode *right;
+    struct RBTreeNode *parent;
+    int color;
+} RBTreeNode;
+
+typedef struct
+{
+    RBTreeNode *root;
+    RBTreeNode *leftmost; // Cached minimum, picking the next entity is O(1)
+    unsigned long next_seq;
+    int size;
+} RBTree;
+
+void rbInit(RBTree *tree);
+void rbInsert(RBTree *tree, RBTreeNode *node, double key);
+void rbErase(RBTree *tree, RBTreeNode *node);
+RBTreeNode *rbFirst(const RBTree *tree);
+RBTreeNode *rbNext(const RBTreeNode *node);
+
+#endif
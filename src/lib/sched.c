@@ -0,0 +1,412 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sched_internal.h"
+
+int taskListPush(TaskList *list, SchedTask *task)
+{
+    if (list->size == list->capacity)
+    {
+        int capacity = list->capacity ? list->capacity * 2 : 16;
+        SchedTask **tasks = realloc(list->tasks, sizeof(SchedTask *) * capacity);
+        if (tasks == NULL)
+            return -1;
+        list->tasks = tasks;
+        list->capacity = capacity;
+    }
+
+    list->tasks[list->size++] = task;
+    return 0;
+}
+
+SchedTask *taskListRemoveAt(TaskList *list, int index)
+{
+    SchedTask *task = list->tasks[index];
+    memmove(&list->tasks[index], &list->tasks[index + 1],
+            sizeof(SchedTask *) * (list->size - index - 1));
+    list->size--;
+    return task;
+}
+
+void taskListFree(TaskList *list)
+{
+    free(list->tasks);
+    list->tasks = NULL;
+    list->size = 0;
+    list->capacity = 0;
+}
+
+unsigned int hashGroup(int id, int size)
+{
+    return ((unsigned int)id * 2654435761u) & (unsigned int)(size - 1);
+}
+
+int selectKth(int *values, int n, int k)
+{
+    int lo = 0;
+    int hi = n - 1;
+
+    while (lo < hi)
+    {
+        int pivot = values[lo + (hi - lo) / 2];
+        int i = lo;
+        int j = hi;
+
+        while (i <= j)
+        {
+            while (values[i] < pivot)
+                i++;
+            while (values[j] > pivot)
+                j--;
+            if (i <= j)
+            {
+                int t = values[i];
+                values[i] = values[j];
+                values[j] = t;
+                i++;
+                j--;
+            }
+        }
+
+        if (k <= j)
+            hi = j;
+        else if (k >= i)
+            lo = i;
+        else
+            break;
+    }
+
+    return values[k];
+}
+
+void sched_default_config(SchedPolicy policy, SchedConfig *config)
+{
+    (void)policy;
+
+    config->base_quantum = 4.0;
+    config->criticality_weight = 0.35;
+    config->deadline_weight = 0.30;
+    config->aging_weight = 0.25;
+    config->priority_weight = 0.10;
+    config->critical_path_weight = 0.0;
+    config->preempt_on_arrival = false;
+    config->lock_protocol = SCHED_LOCK_NONE;
+    config->quantum_target = SCHED_QUANTUM_FIXED;
+    config->quantum_setpoint = 0.0;
+
+    config->min_granularity = 1.0;
+    config->latency = 20.0;
+    config->group_scheduling = false;
+
+    config->admission = SCHED_ADMIT_DEMOTE;
+    config->utilization_bound = 1.0;
+
+    config->mlfq_levels = 4;
+    config->mlfq_boost_period = 50;
+    for (int i = 0; i < SCHED_MLFQ_MAX_LEVELS; i++)
+        config->mlfq_quantum[i] = 2 << i;
+
+    config->share_quantum = 4;
+    config->lottery_seed = 1;
+
+    config->affinity_wait = 20;
+
+    config->class_metrics = false;
+}
+
+Scheduler *sched_create(SchedPolicy policy, const SchedConfig *config)
+{
+    Scheduler *sched = calloc(1, sizeof(Scheduler));
+    if (sched == NULL)
+        return NULL;
+
+    sched->policy = policy;
+    if (config != NULL)
+        sched->config = *config;
+    else
+        sched_default_config(policy, &sched->config);
+
+    switch (policy)
+    {
+    case SCHED_POLICY_DPS_DTQ:
+        sched->ops = &dpsOps;
+        break;
+    case SCHED_POLICY_CFS:
+        sched->ops = &cfsOps;
+        break;
+    case SCHED_POLICY_REFERENCE:
+        sched->ops = &refOps;
+        break;
+    case SCHED_POLICY_EDF:
+        sched->ops = &edfOps;
+        break;
+    case SCHED_POLICY_MLFQ:
+        sched->ops = &mlfqOps;
+        break;
+    case SCHED_POLICY_STRIDE:
+        sched->ops = &strideOps;
+        break;
+    case SCHED_POLICY_LOTTERY:
+        sched->ops = &lotteryOps;
+        break;
+    default:
+        free(sched);
+        return NULL;
+    }
+
+    if (classesInit(sched) != 0)
+    {
+        free(sched->classes);
+        free(sched);
+        return NULL;
+    }
+    sched->ops->init(sched);
+    return sched;
+}
+
+void sched_destroy(Scheduler *sched)
+{
+    if (sched == NULL)
+        return;
+
+    sched->ops->destroy(sched);
+    free(sched->classes);
+    free(sched->class_hash);
+    free(sched);
+}
+
+int sched_submit(Scheduler *sched, SchedTask *task)
+{
+    task->remaining_burst = task->burst_time;
+    task->burst_left = task->burst_time;
+    for (int i = 0; i < task->io.count; i++)
+        task->burst_left -= task->io.burst[i];
+    task->io_next = 0;
+    task->blocked_since = 0;
+    task->blocked_time = 0;
+    task->section_next = 0;
+    task->holding = false;
+    task->waiter_next = NULL;
+    task->slice = 0;
+    task->absolute_deadline = task->deadline > 0 ? task->arrival_time + task->deadline : 0;
+    task->first_execution_time = -1;
+    task->completion_time = 0;
+    task->turnaround_time = 0;
+    task->waiting_time = 0;
+    task->response_time = 0;
+    task->executed = false;
+    task->completed = false;
+    task->dynamic_priority = task->system_priority;
+    task->vruntime = 0;
+    task->heap_index = -1;
+    task->utilization = 0.0;
+    task->demoted = false;
+    task->rejected = false;
+    task->ready_since = task->arrival_time;
+
+    if (classesSubmit(sched, task) != 0)
+        return -1;
+    if (!sched->ops->admit(sched, task))
+    {
+        task->rejected = true;
+        return SCHED_REJECTED;
+    }
+    if (sched->ops->enqueue(sched, task) != 0)
+        return -1;
+
+    sched->submitted++;
+    sched->live++;
+    return 0;
+}
+
+SchedTask *sched_pick_next(Scheduler *sched, int now)
+{
+    SchedTask *task;
+    do
+    {
+        task = sched->ops->pick(sched, now);
+        if (task == NULL)
+            return NULL;
+    } while (!acquireSection(sched, task, now));
+
+    if (task->slice < 1)
+        task->slice = 1;
+
+    if (!task->executed)
+    {
+        task->first_execution_time = now;
+        task->executed = true;
+    }
+
+    return task;
+}
+
+SchedTask *sched_pick_next_on(Scheduler *sched, int now, const SchedTopology *topology,
+                              int cpu, bool cache_hot_only)
+{
+    sched->topology = topology;
+    sched->cpu = cpu;
+    sched->cache_hot_only = cache_hot_only;
+
+    SchedTask *task = sched_pick_next(sched, now);
+
+    sched->topology = NULL;
+    return task;
+}
+
+// Jobs of a periodic task share its cache, so the task's own last CPU counts
+bool placementAllows(const Scheduler *sched, const SchedTask *task, int now)
+{
+    if (sched->topology == NULL || !sched->cache_hot_only)
+        return true;
+
+    const SchedTask *owner = task->origin != NULL ? task->origin : task;
+    if (owner->last_cpu < 0 || sched_same_llc(sched->topology, owner->last_cpu, sched->cpu))
+        return true;
+    return now - task->ready_since >= sched->config.affinity_wait;
+}
+
+int sched_charge(Scheduler *sched, SchedTask *task, int ran)
+{
+    if (ran > task->burst_left)
+        ran = task->burst_left;
+
+    task->remaining_burst -= ran;
+    task->burst_left -= ran;
+    sched->ops->charge(sched, task, ran);
+
+    if (task->burst_left > 0)
+        return sched->ops->enqueue(sched, task) == 0 ? 1 : -1;
+
+    return 0;
+}
+
+void sched_complete(Scheduler *sched, SchedTask *task, int now)
+{
+    MetricAccumulator *acc = &sched->acc;
+
+    task->completed = true;
+    task->completion_time = now;
+    task->turnaround_time = task->completion_time - task->arrival_time;
+    task->waiting_time = task->turnaround_time - task->burst_time - task->blocked_time;
+    task->response_time = task->first_execution_time - task->arrival_time;
+
+    acc->completed++;
+    acc->sum_turnaround += task->turnaround_time;
+    acc->sum_sq_turnaround += (double)task->turnaround_time * task->turnaround_time;
+    acc->sum_waiting += task->waiting_time;
+    acc->sum_sq_waiting += (double)task->waiting_time * task->waiting_time;
+    acc->sum_response += task->response_time;
+    if (task->waiting_time > SCHED_STARVATION_THRESHOLD)
+        acc->starved++;
+    if (task->criticality >= SCHED_HIGH_CRITICALITY)
+    {
+        acc->critical_completed++;
+        acc->sum_critical_turnaround += task->turnaround_time;
+    }
+    classesComplete(sched, task);
+
+    sched->live--;
+    sched->ops->complete(sched, task);
+}
+
+bool sched_io_pending(const SchedTask *task)
+{
+    return task->io_next < task->io.count;
+}
+
+int sched_block(Scheduler *sched, SchedTask *task, int now)
+{
+    task->blocked_since = now;
+    sched->blocked++;
+    if (sched->ops->block != NULL)
+        sched->ops->block(sched, task);
+    return task->io.wait[task->io_next];
+}
+
+int sched_wake(Scheduler *sched, SchedTask *task, int now)
+{
+    task->blocked_time += now - task->blocked_since;
+    task->burst_left = task->io.burst[task->io_next++];
+    task->ready_since = now;
+    sched->blocked--;
+    if (sched->ops->wake != NULL)
+        sched->ops->wake(sched, task);
+    return sched->ops->enqueue(sched, task);
+}
+
+bool sched_should_preempt(Scheduler *sched, const SchedTask *running, int ran, const SchedTask *task, int now)
+{
+    if (sched->ops->preempts == NULL)
+        return false;
+    return sched->ops->preempts(sched, running, ran, task, now);
+}
+
+void sched_deadline_passed(Scheduler *sched, SchedTask *task)
+{
+    classesDeadlinePassed(sched, task);
+    if (sched->ops->expire != NULL)
+        sched->ops->expire(sched, task);
+}
+
+int sched_ready_count(const Scheduler *sched)
+{
+    if (sched->policy == SCHED_POLICY_CFS)
+        return sched->config.group_scheduling ? sched->q.cfs.ready : sched->q.cfs.tree.size;
+    if (sched->policy == SCHED_POLICY_REFERENCE)
+        return sched->q.ref.ready.size;
+    if (sched->policy == SCHED_POLICY_EDF)
+        return sched->q.edf.size;
+    if (sched->policy == SCHED_POLICY_MLFQ)
+        return sched->q.mlfq.size;
+    if (sched->policy == SCHED_POLICY_STRIDE)
+        return sched->q.stride.size;
+    if (sched->policy == SCHED_POLICY_LOTTERY)
+        return sched->q.lottery.size;
+    return sched->q.dps.ready.size;
+}
+
+int sched_live_count(const Scheduler *sched)
+{
+    return sched->live;
+}
+
+int sched_blocked_count(const Scheduler *sched)
+{
+    return sched->blocked;
+}
+
+void sched_metrics(const Scheduler *sched, int total_time, SchedMetrics *metrics)
+{
+    const MetricAccumulator *acc = &sched->acc;
+    double n = (double)acc->completed;
+
+    memset(metrics, 0, sizeof(SchedMetrics));
+    if (acc->completed == 0)
+        return;
+
+    metrics->avg_turnaround_time = acc->sum_turnaround / n;
+    metrics->avg_waiting_time = acc->sum_waiting / n;
+    metrics->avg_response_time = acc->sum_response / n;
+    metrics->throughput = total_time > 0 ? n / total_time : 0.0;
+    metrics->fairness_index = (acc->sum_turnaround * acc->sum_turnaround) / (n * acc->sum_sq_turnaround);
+    metrics->starvation_count = acc->starved;
+
+    double mean_waiting_time = acc->sum_waiting / n;
+    double variance = acc->sum_sq_waiting / n - mean_waiting_time * mean_waiting_time;
+    if (variance < 0.0)
+        variance = 0.0;
+
+    // Nobody waited at all: perfectly balanced rather than 0/0
+    double coefficient_of_variation = mean_waiting_time > 0.0 ? sqrt(variance) / mean_waiting_time : 0.0;
+    metrics->load_balancing_efficiency = 1.0 / (1.0 + coefficient_of_variation);
+
+    metrics->locks_taken = acc->locks_taken;
+    metrics->lock_waits = acc->lock_waits;
+    metrics->lock_wait_time = acc->lock_wait_time;
+    metrics->inversion_time = acc->inversion_time;
+    metrics->max_inversion = acc->max_inversion;
+    if (acc->critical_completed > 0)
+        metrics->avg_critical_turnaround = acc->sum_critical_turnaround / acc->critical_completed;
+}
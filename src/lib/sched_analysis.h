@@ -0,0 +1,46 @@
+#ifndef SCHED_ANALYSIS_H
+#define SCHED_ANALYSIS_H
+
+#include <stdbool.h>
+#include "scheduler.h"
+
+// Offline schedulability analysis for sets of periodic tasks on one CPU.
+// Every task must have period > 0. burst_time is the worst-case execution
+// time, and deadline is relative to the release (0 means deadline = period).
+// Releases are assumed synchronous, which is the worst case, so offsets in
+// arrival_time are ignored.
+
+typedef enum
+{
+    SCHED_PRIORITY_DEADLINE_MONOTONIC, // Shorter relative deadline first
+    SCHED_PRIORITY_SYSTEM              // Higher system_priority first
+} SchedPriorityOrder;
+
+typedef struct
+{
+    int unschedulable; // Tasks whose response time can exceed their deadline
+    double utilization;
+    long steps; // Fixed-point iterations, for tuning
+} SchedRtaResult;
+
+typedef struct
+{
+    bool schedulable;
+    double utilization;
+    long bound;        // Demand was checked for every deadline up to here
+    long failure_time; // Some interval of this length demands more, or 0
+    long steps;
+} SchedDemandResult;
+
+// Exact response-time analysis under fixed priorities. response[i] receives
+// the worst-case response time of tasks[i], or -1 if it exceeds the deadline.
+// priority[i], if not NULL, receives the task's rank (0 is the highest).
+// Returns 0, or -1 if memory ran out.
+int sched_rta(const SchedTask *tasks, int n, SchedPriorityOrder order,
+              long *response, int *priority, SchedRtaResult *result);
+
+// Processor-demand test for preemptive EDF, using Quick Processor-demand
+// Analysis (Zhang and Burns, 2009)
+void sched_edf_demand(const SchedTask *tasks, int n, SchedDemandResult *result);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef SCHED_FRONTEND_H
+#define SCHED_FRONTEND_H
+
+#include <stdbool.h>
+
+#include "scheduler.h"
+#include "sched_sim.h"
+#include "sched_topology.h"
+
+// Command-line front end of the simulating engines (bin/DPS-DTQ, bin/CFS,
+// bin/EDF, bin/MLFQ, bin/Stride). A driver parses its policy's options into
+// `config` and hands every other argument to sched_frontend_option; the front
+// end reads the process file, runs the simulator and prints the metrics and
+// the class, job and group tables. Errors print a message and exit(1).
+
+#define SCHED_FRONTEND_MAX_PROCESSES 100
+
+// The options sched_frontend_option takes, for the drivers' usage lines
+#define SCHED_FRONTEND_USAGE                                                               \
+    "[--horizon=N] [--one-shot] [--job-stats] [--class-stats] [--switch-cost=N] "         \
+    "[--cache-penalty=N] [--cache-decay=N] [--topology=FILE] [--affinity-wait=N] "        \
+    "[--checkpoint=T:FILE | --checkpoint-every=N:PREFIX] [--resume=FILE] "                \
+    "[--what-if=BASELINE] [--decision-log=FILE] <input_file|->"
+
+typedef struct
+{
+    SchedPolicy policy;
+    SchedConfig config; // The driver's policy options go here
+    SchedSimOptions sim;
+    SchedTopology topology;
+    const char *input;        // Process file, "-" to stream standard input
+    const char *resume_path;  // --resume
+    const char *what_if_path; // --what-if baseline
+    bool job_stats;
+    bool sample_input; // Without an input, run input.txt, writing a sample one if it is missing
+
+    // Filled in by sched_frontend_run
+    SchedTask *tasks; // The processes in file order, NULL when streaming
+    int n;
+    int what_if_divergence;
+    SchedSimResult result;
+    SchedMetrics metrics;
+    SchedQuantumStats quantum;
+    bool adaptive_quantum;
+    SchedClassStats *classes;
+    int class_count;
+    SchedGroupStats *groups;
+    int group_count;
+} SchedFrontend;
+
+// Defaults for `policy`, with no input yet
+void sched_frontend_init(SchedFrontend *fe, SchedPolicy policy);
+
+// Applies one of the options every engine takes, or takes `arg` as the input
+// file. Returns false for any other "--" option.
+bool sched_frontend_option(SchedFrontend *fe, const char *arg);
+
+// Checks the options together once all are parsed. Returns false if there
+// is no input, for the driver to print its usage.
+bool sched_frontend_check(SchedFrontend *fe);
+
+// sched_create with fe->policy and fe->config
+Scheduler *sched_frontend_create(SchedFrontend *fe);
+
+// Runs the input through `sched`, which must be fresh, resuming or
+// branching from a checkpoint as the options ask, and collects the results.
+// Hooks only apply to a process file.
+void sched_frontend_run(SchedFrontend *fe, Scheduler *sched, const SchedSimHooks *hooks);
+
+// Prints the metrics, then the class, job and group tables asked for
+void sched_frontend_report(const SchedFrontend *fe);
+
+#endif
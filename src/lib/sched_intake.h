@@ -0,0 +1,31 @@
+#ifndef SCHED_INTAKE_H
+#define SCHED_INTAKE_H
+
+#include "scheduler.h"
+
+// Lock-free multi-producer single-consumer submission ring. Any number of
+// producer threads push tasks without taking a lock; the thread that owns the
+// Scheduler drains them in batches with sched_intake_drain.
+
+typedef struct SchedIntake SchedIntake;
+
+// Capacity is rounded up to a power of two
+SchedIntake *sched_intake_create(int capacity);
+void sched_intake_destroy(SchedIntake *intake);
+
+// Safe from any thread; returns false when the ring is full
+bool sched_intake_push(SchedIntake *intake, SchedTask *task);
+
+// Gets a task sched_submit refused, with its result: SCHED_REJECTED from
+// admission control, or -1 when memory ran out. The task is not queued.
+typedef void (*SchedRefusedFn)(void *ctx, SchedTask *task, int status);
+
+// Consumer only. Submits up to max queued tasks to the scheduler and returns
+// how many were taken off the ring, refused ones included. Those go to
+// `refused`, which may be NULL if nothing can be refused.
+int sched_intake_drain(SchedIntake *intake, Scheduler *sched, int max, SchedRefusedFn refused, void *ctx);
+
+// Consumer only
+bool sched_intake_empty(const SchedIntake *intake);
+
+#endif
@@ -0,0 +1,291 @@
+#ifndef SCHED_INTERNAL_H
+#define SCHED_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scheduler.h"
+
+// A snapshot being written or read back. Fields are stored as raw bytes, so
+// a checkpoint only restores into the binary that wrote it. Tasks are stored
+// as numbers: the caller's array first, then the simulator's live jobs.
+typedef struct Checkpoint
+{
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+    size_t pos;  // Read position
+    bool failed; // Out of memory, or a short or inconsistent read
+    SchedTask *tasks;
+    int n;
+    SchedTask **jobs;
+    int job_count;
+} Checkpoint;
+
+typedef struct
+{
+    void (*init)(Scheduler *sched);
+    void (*destroy)(Scheduler *sched);
+    bool (*admit)(Scheduler *sched, SchedTask *task); // First submission only; false rejects
+    int (*enqueue)(Scheduler *sched, SchedTask *task);
+    SchedTask *(*pick)(Scheduler *sched, int now); // Dequeues and sets task->slice
+    void (*charge)(Scheduler *sched, SchedTask *task, int ran);
+    void (*complete)(Scheduler *sched, SchedTask *task);
+    // Optional: whether a newly ready task should displace the running one at
+    // `now`, the running one having done `ran` since it was last charged
+    bool (*preempts)(Scheduler *sched, const SchedTask *running, int ran, const SchedTask *task, int now);
+    // Optional: the task's absolute deadline passed before it completed
+    void (*expire)(Scheduler *sched, SchedTask *task);
+    // Optional: the task left for I/O, and came back before being requeued
+    void (*block)(Scheduler *sched, SchedTask *task);
+    void (*wake)(Scheduler *sched, SchedTask *task);
+    // The run-queue structure, restored into a scheduler fresh from init
+    void (*save)(const Scheduler *sched, Checkpoint *ckpt);
+    int (*restore)(Scheduler *sched, Checkpoint *ckpt);
+} SchedOps;
+
+// A tenant under CFS group scheduling: a vruntime tree of its own ready
+// tasks, queued as one entity in the scheduler's tree while it has any
+typedef struct CfsGroup
+{
+    double vruntime;     // CPU time received, scaled by the shares
+    RBTree tree;
+    RBTreeNode node;
+    bool queued;
+    int active;          // Live tasks not blocked on I/O
+    double total_weight; // Of the active tasks
+    SchedGroupStats stats;
+    struct CfsGroup *hash_next;
+} CfsGroup;
+
+#define QUANTUM_WINDOW 128 // Samples the quantum controller measures over
+
+// Feedback on the DPS-DTQ base quantum, fed one sample per dispatch
+typedef struct
+{
+    int samples[QUANTUM_WINDOW]; // Ring of response times, or of dispatch times
+    int scratch[QUANTUM_WINDOW];
+    long taken;      // Samples so far
+    double integral; // Of the error, over every controller step
+    SchedQuantumStats stats;
+} QuantumControl;
+
+// Growable FIFO of task pointers kept in arrival order
+typedef struct
+{
+    SchedTask **tasks;
+    int size;
+    int capacity;
+} TaskList;
+
+// Running sums so metrics never need the completed tasks themselves
+typedef struct
+{
+    long completed;
+    double sum_turnaround;
+    double sum_sq_turnaround;
+    double sum_waiting;
+    double sum_sq_waiting;
+    double sum_response;
+    int starved;
+    long critical_completed;
+    double sum_critical_turnaround;
+    long locks_taken;
+    long lock_waits;
+    long lock_wait_time;
+    long inversion_time;
+    int max_inversion;
+} MetricAccumulator;
+
+// The buckets of SchedHistogram
+#define CLASS_EXACT_LIMIT 64
+#define CLASS_SUB_BUCKETS 16
+#define CLASS_BUCKETS SCHED_HISTOGRAM_BUCKETS
+
+// Running sums of one class, see sched_class_stats
+typedef struct
+{
+    SchedClassKind kind;
+    int key;
+    long completed;
+    long deadline_misses;
+    int starved;
+    double sum_turnaround;
+    double sum_waiting;
+    double sum_response;
+    int max_response;
+    int max_turnaround;
+    long response[CLASS_BUCKETS];
+    long turnaround[CLASS_BUCKETS];
+    int hash_next; // Next group class in the same bucket, or -1
+} ClassAccumulator;
+
+// Criticalities 0-10 and the priority bands come first, then the groups
+#define CLASS_FIXED (11 + SCHED_PRIORITY_BANDS)
+
+// A shared resource from the tasks' critical sections
+typedef struct
+{
+    SchedTask *holder;  // NULL while free
+    SchedTask *waiters; // Most critical first, then in order of arrival
+} SchedResource;
+
+struct Scheduler
+{
+    SchedPolicy policy;
+    SchedConfig config;
+    const SchedOps *ops;
+
+    long submitted;
+    int live;    // Submitted but not completed
+    int blocked; // Live but waiting for I/O
+    MetricAccumulator acc;
+    ClassAccumulator *classes; // NULL without class_metrics
+    int class_count;
+    int class_capacity;
+    int *class_hash; // Index of the first group class in each bucket, or -1
+    int class_hash_size;
+    SchedResource resources[SCHED_MAX_RESOURCES];
+
+    // Placement of the pick in progress, set by sched_pick_next_on
+    const SchedTopology *topology; // NULL when placement does not matter
+    int cpu;
+    bool cache_hot_only;
+
+    union
+    {
+        struct
+        {
+            TaskList ready;
+            double load_factor;
+            int longest_path; // Longest burst plus path_after admitted so far
+            QuantumControl control;
+        } dps;
+
+        struct
+        {
+            TaskList ready;
+            int *scratch; // Remaining times for the median
+            int scratch_capacity;
+        } ref;
+
+        struct
+        {
+            RBTree tree;         // Tasks, or groups with group scheduling
+            double total_weight; // Of live tasks, or of the shares of active groups
+            CfsGroup **groups;   // In the order first seen
+            int group_count;
+            int group_capacity;
+            CfsGroup **hash;     // Chained on group id
+            int hash_size;
+            double group_floor;  // Highest group vruntime picked so far
+            int ready;           // Ready tasks with group scheduling
+        } cfs;
+
+        struct
+        {
+            SchedTask **heap; // Min-heap on deadline, task->heap_index is the slot
+            int size;
+            int capacity;
+            double utilization; // Sum over admitted live tasks
+        } edf;
+
+        struct
+        {
+            SchedTask *head[SCHED_MLFQ_MAX_LEVELS]; // FIFO per level
+            SchedTask *tail[SCHED_MLFQ_MAX_LEVELS];
+            unsigned int nonempty; // Bit i is set while level i has tasks
+            int levels;
+            int size;
+            int boost_epoch; // Boosts applied so far
+        } mlfq;
+
+        struct
+        {
+            SchedTask **heap; // Min-heap on pass, task->heap_index is the slot
+            int size;
+            int capacity;
+            long pass_floor; // Highest pass picked so far
+        } stride;
+
+        struct
+        {
+            long *tree;        // Fenwick tree of tickets per slot, 1-based
+            long *value;       // Tickets in each slot, 0 when free
+            SchedTask **slots;
+            int *free_slots;
+            int free_count;
+            int used;     // Slots handed out at least once
+            int capacity; // Always a power of two
+            int size;
+            long total;
+            unsigned long rng;
+        } lottery;
+    } q;
+};
+
+extern const SchedOps dpsOps;
+extern const SchedOps cfsOps;
+extern const SchedOps refOps;
+extern const SchedOps edfOps;
+extern const SchedOps mlfqOps;
+extern const SchedOps strideOps;
+extern const SchedOps lotteryOps;
+
+int taskListPush(TaskList *list, SchedTask *task);
+SchedTask *taskListRemoveAt(TaskList *list, int index);
+void taskListFree(TaskList *list);
+
+// Bucket of a group id in a hash of `size` buckets, a power of two
+unsigned int hashGroup(int id, int size);
+
+// k-th smallest value, partially reordering values
+int selectKth(int *values, int n, int k);
+
+// Whether the pick in progress may hand out `task`
+bool placementAllows(const Scheduler *sched, const SchedTask *task, int now);
+
+// Takes the resource of the critical section a picked task has reached, if
+// any. Returns false if it is held; the task then waits for it off the run
+// queue.
+bool acquireSection(Scheduler *sched, SchedTask *task, int now);
+
+// Whether the task has a critical section on `resource` it has not finished
+bool usesResource(const SchedTask *task, int resource);
+
+// Per-class metrics, each a no-op without class_metrics. classesInit and
+// classesSubmit return 0, or -1 if memory ran out.
+int classesInit(Scheduler *sched);
+int classesSubmit(Scheduler *sched, const SchedTask *task);
+void classesComplete(Scheduler *sched, const SchedTask *task);
+void classesDeadlinePassed(Scheduler *sched, const SchedTask *task);
+void classesSave(const Scheduler *sched, Checkpoint *ckpt);
+int classesRestore(Scheduler *sched, Checkpoint *ckpt);
+
+void checkpointPut(Checkpoint *ckpt, const void *value, size_t size);
+// Zeroes value and sets failed if the checkpoint is too short
+void checkpointGet(Checkpoint *ckpt, void *value, size_t size);
+void checkpointPutTask(Checkpoint *ckpt, const SchedTask *task);
+// NULL for a NULL task, or with failed set for a bad number
+SchedTask *checkpointGetTask(Checkpoint *ckpt);
+
+// A count, then the tasks in order. checkpointGetTasks grows *tasks to hold
+// them and returns the count, or -1.
+void checkpointPutTasks(Checkpoint *ckpt, SchedTask *const *tasks, int count);
+int checkpointGetTasks(Checkpoint *ckpt, SchedTask ***tasks, int *capacity);
+
+// FNV-1a of `size` bytes, continuing from `hash`; 0 starts a new one
+uint64_t checkpointHash(uint64_t hash, const void *value, size_t size);
+
+// Hash of every SchedConfig field, one field at a time so padding stays out
+uint64_t schedulerConfigHash(const Scheduler *sched);
+
+// The counters, metric sums and resources, then the policy's own state
+void schedulerSave(const Scheduler *sched, Checkpoint *ckpt);
+int schedulerRestore(Scheduler *sched, Checkpoint *ckpt);
+
+// The whole checkpoint in a single write or read
+int checkpointWrite(const Checkpoint *ckpt, const char *path);
+int checkpointRead(Checkpoint *ckpt, const char *path);
+
+#endif
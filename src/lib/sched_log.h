@@ -0,0 +1,61 @@
+#ifndef SCHED_LOG_H
+#define SCHED_LOG_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// Decision log: a compact binary record of a simulated run, enough to
+// recompute its metrics without running the policy again. After a short
+// header, each record is a varint tag (type, plus the CPU << 2 for slices)
+// followed by varint fields. Times and process ids are stored as zigzag
+// deltas from the previous record, so a slice usually takes 4 or 5 bytes.
+
+typedef enum
+{
+    SCHED_LOG_SLICE,    // A task ran on a CPU from time for length units
+    SCHED_LOG_COMPLETE, // A task or job completed at time
+    SCHED_LOG_REJECT,   // Admission control turned a task or job away
+    SCHED_LOG_END       // The run ended at time, on cpus CPUs
+} SchedLogType;
+
+typedef struct
+{
+    SchedLogType type;
+    int time;
+    int id; // Process id; jobs of a periodic task share it
+    int cpu;
+    int length;
+
+    // Completions only
+    int turnaround_time;
+    int response_time;
+    int burst_time;
+    int blocked_time; // Time spent waiting for I/O
+    int criticality;
+    bool missed;      // Still running when its absolute deadline passed
+
+    // End only
+    int cpus;
+} SchedLogRecord;
+
+typedef struct
+{
+    FILE *file;
+    int time; // Of the previous record
+    int id;
+} SchedLog;
+
+// Writes the header. Returns 0, or -1 if the write failed.
+int sched_log_start(SchedLog *log, FILE *out);
+
+void sched_log_write(SchedLog *log, const SchedLogRecord *record);
+
+// Checks the header of a log written by sched_log_start. Returns 0, or -1 if
+// `in` is not a decision log.
+int sched_log_open(SchedLog *log, FILE *in);
+
+// Reads the next record. Returns 1 with *record set, 0 at the end of the log
+// and -1 if the log is truncated or corrupt.
+int sched_log_read(SchedLog *log, SchedLogRecord *record);
+
+#endif
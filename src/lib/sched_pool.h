@@ -0,0 +1,52 @@
+#ifndef SCHED_POOL_H
+#define SCHED_POOL_H
+
+#include "scheduler.h"
+
+// Thread-pool executor: real worker threads run user work items in the order
+// and for the quanta chosen by a Scheduler. One scheduler time unit maps to
+// `unit_ns` nanoseconds of wall-clock time.
+//
+// Preemption is cooperative: a work item is handed the quantum as a budget
+// and must return once the budget is spent.
+
+// Runs the item for at most budget_ns; returns true once the item is finished
+typedef bool (*SchedWorkFn)(void *arg, long budget_ns);
+
+typedef struct
+{
+    long completed;
+    long rejected;             // Refused by the scheduler, or lost when it ran out of memory
+    long dispatches;
+    double wall_seconds;
+    double throughput;         // Completed items per second
+    double avg_latency_ms;     // Submit to completion
+    double p99_latency_ms;     // From a log2 histogram, an upper bound
+    double max_latency_ms;
+    double avg_lock_wait_us;   // Time spent acquiring the scheduler lock per dispatch
+    double scheduler_overhead; // Fraction of worker time spent outside work items
+} SchedPoolStats;
+
+typedef struct SchedPool SchedPool;
+
+SchedPool *sched_pool_create(SchedPolicy policy, const SchedConfig *config, int workers, long unit_ns);
+
+// task->burst_time is the expected run time in scheduler units; the arrival
+// time is taken from the clock. The task must stay valid until completion.
+// An item the scheduler refuses, e.g. under EDF admission control, is dropped
+// without running: task->rejected is set if admission turned it away, and it
+// counts as done for sched_pool_wait. So does an item the scheduler runs out
+// of memory to requeue.
+int sched_pool_submit(SchedPool *pool, SchedTask *task, SchedWorkFn fn, void *arg);
+
+// Blocks until every submitted item has completed
+void sched_pool_wait(SchedPool *pool);
+
+void sched_pool_stats(SchedPool *pool, SchedPoolStats *stats);
+
+// Metrics of the underlying scheduler in time units
+void sched_pool_metrics(SchedPool *pool, SchedMetrics *metrics);
+
+void sched_pool_destroy(SchedPool *pool);
+
+#endif
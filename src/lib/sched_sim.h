@@ -0,0 +1,203 @@
+#ifndef SCHED_SIM_H
+#define SCHED_SIM_H
+
+#include "scheduler.h"
+
+#define SCHED_SIM_MAX_HORIZON (1 << 30)
+
+// sched_sim_run_tasks result for predecessors that are unknown, ambiguous,
+// periodic or on a cycle
+#define SCHED_SIM_BAD_PRECEDENCE -2
+
+// The checkpoint could not be written, or does not match the run resuming it
+#define SCHED_SIM_BAD_CHECKPOINT -3
+
+// sched_sim_run result for a source that went back in arrival_time
+#define SCHED_SIM_UNORDERED -4
+
+// Discrete-event simulator. Arrivals, periodic releases, slice ends and
+// deadlines are events in a calendar queue, and the policy only runs when one
+// of them fires, so idle gaps and new event types cost nothing per tick.
+//
+// A task with a period is a periodic task: the simulator releases a new job
+// for it every period, starting at arrival_time, until the horizon. Each job
+// is a copy of the task with its own arrival_time and absolute deadline. Only
+// the next release of each task is ever queued, so jobs are generated lazily
+// and live only until they complete.
+//
+// Slices normally run to their end. If the policy says a newly ready task
+// preempts the running one, the slice is cut at that instant and the part
+// already used is charged.
+//
+// Switching the CPU to a different task can cost time. Each switch costs
+// switch_cost plus a cache refill of up to cache_penalty. The refill shrinks
+// the more recently the task last ran: a task that stopped `gap` units ago
+// pays cache_penalty * (1 - exp(-gap / cache_decay)), rounded, and a task
+// that has not run yet pays all of it. Jobs of a periodic task share the
+// task's cache. The overhead sits on the timeline before the slice and is
+// not charged to the task.
+//
+// A task with I/O phases leaves the CPU when each CPU burst ends and waits
+// out its I/O off the run queue, while other tasks use the CPU. It becomes
+// ready again when the I/O completes, and may preempt like a new arrival.
+//
+// A task with critical sections takes each resource when its work reaches
+// the section and releases it at the end, and each of those points ends the
+// slice. A task that finds its resource held waits off the run queue until
+// the holder releases it; meanwhile the holder may be preempted or wait for
+// I/O, and whatever runs instead prolongs the wait.
+//
+// With a topology the simulator runs one CPU per entry, all fed from the
+// scheduler's single run queue. At each instant, idle CPUs first pick with
+// cache_hot_only set (see sched_pick_next_on) and then without it, so no CPU
+// idles while work is ready. A task resumed under another LLC or node pays
+// the topology's migration cost and a fully cold cache. A newly ready task
+// that beats several running ones preempts the weakest of them.
+//
+// With decision_log set, every slice, completion and rejection is appended
+// to it as it happens, then an end record once the run drains; the file is
+// flushed but left open. A run resumed from a checkpoint logs only what
+// happens after it.
+
+// Pulls the next arrival from a workload source, in arrival_time order.
+// Returns 1 with *task set, 0 at the end of the workload and -1 on error.
+typedef int (*SchedArrivalFn)(void *ctx, SchedTask **task);
+
+typedef struct
+{
+    // Called for every slice on every CPU; task is NULL for an idle span
+    void (*on_slice)(void *ctx, const SchedTask *task, int cpu, int start, int end);
+    // Called once per task or job after sched_complete, or with
+    // task->rejected set if admission control turned it away. The task may
+    // be freed here, except for jobs (origin != NULL), which the simulator
+    // frees.
+    void (*on_complete)(void *ctx, SchedTask *task);
+    // Called once per periodic task after its last job; it may be freed here
+    void (*on_retire)(void *ctx, SchedTask *task);
+    void *ctx;
+} SchedSimHooks;
+
+typedef struct
+{
+    bool release_periodic; // Re-release tasks every period; false runs each once
+    int horizon;           // No releases at or after this time; 0 for the hyperperiod
+    int switch_cost;       // Fixed cost of every context switch
+    int cache_penalty;     // Refill cost of a fully cold cache
+    int cache_decay;       // Time for a cache to go cold; 0 means always cold
+    const SchedTopology *topology; // CPUs to simulate; NULL for a single CPU
+    int checkpoint_at;             // Save the run here, see sched_sim_run_tasks; -1 for none
+    int checkpoint_every;          // Also save at each multiple of this, 0 for none
+    const char *checkpoint_path;   // File the checkpoint is written to
+    FILE *decision_log;            // Gets every slice and completion, see sched_log.h; NULL for none
+} SchedSimOptions;
+
+typedef struct
+{
+    int total_time;
+    long events;
+    long dispatches;
+    long deadline_misses; // Jobs still running when their absolute deadline passed
+    long idle_time;       // Summed over every CPU
+    long preemptions;     // Slices cut short by a newly ready task
+    long rejected;        // Tasks and jobs turned away by admission control
+    long jobs_released;   // Jobs released by periodic tasks
+    int horizon;          // Release horizon actually used
+    long switches;        // Dispatches that changed the task on a CPU
+    long switch_time;     // Time spent switching rather than running tasks
+    long migrations;      // Dispatches onto another LLC than the task last used
+    long io_waits;        // I/O phases waited out
+    long edges;           // Precedence edges between the tasks
+    int cpus;
+    int checkpoint_time;  // checkpoint_at of the checkpoint taken or resumed from, -1 if none
+    int divergence;       // Time a what-if run resumed before, see sched_sim_resume_before; -1 otherwise
+} SchedSimResult;
+
+// Share of the run spent on task work rather than idle or switching
+double sched_sim_utilization(const SchedSimResult *result);
+
+void sched_sim_default_options(SchedSimOptions *options);
+
+// Returns 0 on success, SCHED_SIM_UNORDERED if an arrival came before the one
+// pulled ahead of it, and -1 if the source failed or memory ran out; options
+// may be NULL for the defaults.
+//
+// The default horizon is the latest periodic arrival plus the hyperperiod (the
+// LCM of the periods), which covers at least one full cycle of every task
+// offset. It grows as periodic tasks arrive, and is capped at
+// SCHED_SIM_MAX_HORIZON.
+//
+// Checkpoints need the tasks up front, so this ignores checkpoint_at.
+int sched_sim_run(Scheduler *sched, SchedArrivalFn next_arrival, void *source,
+                  const SchedSimHooks *hooks, const SchedSimOptions *options,
+                  SchedSimResult *result);
+
+// Convenience source over an array of tasks in any order. Tasks may name
+// predecessors by id: such a task is released when it has arrived and the
+// last of them has completed, and its arrival_time becomes the release
+// time. A rejected predecessor counts as completed. Each completion visits
+// only its own successor edges. Periodic tasks may only take part when
+// release_periodic is off. Returns SCHED_SIM_BAD_PRECEDENCE if the
+// predecessors cannot be resolved; otherwise as sched_sim_run.
+//
+// With checkpoint_at set, the whole state of the run is written to
+// checkpoint_path in a single write, once every decision before
+// checkpoint_at is made, and the run carries on. A run that ends sooner
+// writes none. checkpoint_every saves periodic checkpoints the same way, each
+// named by sched_sim_checkpoint_name; a stretch with no events that passes
+// several multiples saves only the last of them. Returns
+// SCHED_SIM_BAD_CHECKPOINT if a write fails.
+int sched_sim_run_tasks(Scheduler *sched, SchedTask *tasks, int n,
+                        const SchedSimHooks *hooks, const SchedSimOptions *options,
+                        SchedSimResult *result);
+
+// Carries on a run of sched_sim_run_tasks from the checkpoint at `path`.
+// The tasks must be the same array, in the same order and freshly set up as
+// for a first run. Those that had arrived by the checkpoint are taken from
+// it, in the same arrival order, and the rest keep the parameters given. The
+// scheduler must be freshly created with the same policy, and the topology
+// must have as many CPUs. The scheduler config and
+// the switch and cache costs may differ, so runs can fork from a shared
+// warm-up prefix; the horizon and release_periodic come from the checkpoint.
+// Hooks only see what happens after the checkpoint. The file holds raw
+// structures, so only the binary that wrote it can read it. Returns
+// SCHED_SIM_BAD_CHECKPOINT if it cannot be used; otherwise as
+// sched_sim_run_tasks.
+int sched_sim_resume_tasks(Scheduler *sched, SchedTask *tasks, int n,
+                           const SchedSimHooks *hooks, const SchedSimOptions *options,
+                           const char *path, SchedSimResult *result);
+
+// Path of the periodic checkpoint at `time`: `path` followed by "." and the
+// time. Returns the length, as snprintf.
+int sched_sim_checkpoint_name(char *name, size_t size, const char *path, int time);
+
+// Earliest time at which a run of `edited` can decide differently from a run
+// of `baseline`, the same n tasks in the same order with some parameters
+// changed. A changed task can only matter once it is pulled from the array,
+// which happens as the task before it in arrival order arrives; a change to
+// a task linked by predecessors can shift priorities from the start. Returns
+// the latest arrival if nothing changed, or -1 if the ids differ.
+int sched_sim_divergence(const SchedTask *baseline, const SchedTask *edited, int n);
+
+// What-if run: takes `tasks` from the latest periodic checkpoint an earlier
+// run of them saved (checkpoint_every and checkpoint_path as it used) at or
+// before `time`, usually the divergence from the tasks that run used, and
+// runs them to the end. Runs from the start if there is no such checkpoint,
+// or if the earlier run had another scheduler config, switch or cache costs
+// or topology, in which case result->divergence is 0 rather than `time`.
+// Metrics cover the whole run, the part before the checkpoint included, and
+// result->checkpoint_time is the time resumed from. Takes no checkpoints of
+// its own; otherwise as sched_sim_resume_tasks.
+int sched_sim_resume_before(Scheduler *sched, SchedTask *tasks, int n,
+                            const SchedSimHooks *hooks, const SchedSimOptions *options,
+                            int time, SchedSimResult *result);
+
+// Streams a trace ordered by arrival_time through the scheduler: tasks are
+// read only when the clock reaches them, each completion is written to `out`
+// as a CSV record as it happens and the task is freed straight away, so
+// memory is bounded by the number of live tasks rather than the trace size.
+// Jobs of periodic tasks are written as they complete, like any other task.
+// Returns 0 on success, or -1 on a malformed or unordered trace.
+int sched_run_stream(Scheduler *sched, FILE *in, FILE *out,
+                     const SchedSimOptions *options, SchedSimResult *result);
+
+#endif
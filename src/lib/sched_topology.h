@@ -0,0 +1,40 @@
+#ifndef SCHED_TOPOLOGY_H
+#define SCHED_TOPOLOGY_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#define SCHED_MAX_CPUS 256
+
+// CPUs grouped into last-level cache domains and NUMA nodes, for the
+// multi-CPU simulator. Moving a task within its LLC is free; moving it to
+// another LLC or node costs the matching penalty on top of a cold cache.
+typedef struct SchedTopology
+{
+    int cpus;
+    int llc[SCHED_MAX_CPUS];  // Last-level cache domain of each CPU
+    int node[SCHED_MAX_CPUS]; // NUMA node of each CPU
+    int llc_migration_cost;   // Resuming under another LLC on the same node
+    int node_migration_cost;  // Resuming on another node
+} SchedTopology;
+
+// One CPU, nothing to migrate between
+void sched_topology_single(SchedTopology *topology);
+
+// Reads a topology description:
+//
+//   cpu <id> <llc> <node>       one line per CPU, ids 0..n-1 in any order
+//   llc_migration_cost <n>
+//   node_migration_cost <n>
+//
+// Blank lines and '#' comments are skipped. Returns 0, or -1 with
+// *line_number at the offending line (0 if the CPU list has gaps).
+int sched_topology_read(FILE *in, SchedTopology *topology, int *line_number);
+
+bool sched_same_llc(const SchedTopology *topology, int a, int b);
+
+// Extra cost of resuming on `to` a task that last ran on `from`, or 0 if
+// `from` is -1
+int sched_migration_cost(const SchedTopology *topology, int from, int to);
+
+#endif
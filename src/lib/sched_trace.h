@@ -0,0 +1,49 @@
+#ifndef SCHED_TRACE_H
+#define SCHED_TRACE_H
+
+#include <stdio.h>
+
+// sched_trace_import result for a trace whose span does not fit the time unit
+#define SCHED_TRACE_TOO_LONG -2
+
+typedef struct
+{
+    long unit_ns;   // Length of one simulator time unit, 1000 for microseconds
+    long window_ns; // Longest a process record stays open, which bounds memory
+} SchedTraceOptions;
+
+typedef struct
+{
+    long lines;
+    long events;     // sched_switch and sched_wakeup lines used
+    long malformed;  // Scheduler events whose fields could not be read
+    long reordered;  // Events stamped earlier than the one before, taken as simultaneous
+    long tasks;      // Distinct pids, the idle task excluded
+    long records;    // Processes written
+    long cpu_time;   // Summed bursts written, in time units
+} SchedTraceStats;
+
+void sched_trace_default_options(SchedTraceOptions *options);
+
+// Reads a text dump of Linux scheduler events, from `perf sched script` or
+// an ftrace buffer with sched_switch and sched_wakeup enabled, and writes
+// the tasks as processes in the input format, ordered by arrival_time as
+// sched_run_stream needs.
+//
+// A task arrives when it first wakes or runs. Its time on a CPU until it
+// blocks is its burst; a preempted task stays runnable and its burst goes
+// on. Each block until the next wakeup becomes an I/O phase followed by the
+// next CPU burst. A record is closed after SCHED_MAX_IO_PHASES phases, after
+// window_ns, or when the task exits, and the task carries on in a new record
+// with the same pid that arrives when it next becomes ready. Priorities map
+// to criticality and system priority 1-10, nice -20 and real-time tasks
+// being 10. Times start at 0 with the first event.
+//
+// The input is read a line at a time and records are written as soon as no
+// open one can arrive before them, so memory grows with the number of pids
+// and the records of one window, not the size of the dump. Other events and
+// lines are skipped. Returns 0, -1 if memory ran out or the output failed, or
+// SCHED_TRACE_TOO_LONG.
+int sched_trace_import(FILE *in, FILE *out, const SchedTraceOptions *options, SchedTraceStats *stats);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef SCHED_WORKLOAD_H
+#define SCHED_WORKLOAD_H
+
+#include <stdio.h>
+#include "scheduler.h"
+
+typedef enum
+{
+    SCHED_DIST_CONST,       // a
+    SCHED_DIST_UNIFORM,     // Integers a to b
+    SCHED_DIST_EXPONENTIAL, // Mean a
+    SCHED_DIST_NORMAL,      // Mean a, standard deviation b
+    SCHED_DIST_PARETO       // Minimum a, shape b; heavy-tailed
+} SchedDistKind;
+
+typedef struct
+{
+    SchedDistKind kind;
+    double a;
+    double b;
+} SchedDist;
+
+// Distribution of randomized workloads. Samples are rounded to integers and
+// clamped to each field's range.
+typedef struct
+{
+    int processes;
+    SchedDist interarrival;
+    SchedDist burst;         // First CPU burst, at least 1
+    double deadline_share;   // Part of the processes given a deadline
+    SchedDist slack;         // Deadline past the task's CPU and I/O time
+    SchedDist criticality;   // 1-10
+    SchedDist priority;      // system_priority, 1-10
+    SchedDist io_phases;     // 0 to SCHED_MAX_IO_PHASES
+    SchedDist io_wait;
+    SchedDist io_burst;      // At least 1
+} SchedWorkload;
+
+// 20 processes arriving every 4 units on average, bursts of 1-10, no
+// deadlines and no I/O
+void sched_workload_default(SchedWorkload *workload);
+
+// Reads a workload description over the defaults:
+//
+//   processes <n>
+//   interarrival|burst|slack|criticality|priority|io_phases|io_wait|io_burst <dist>
+//   deadline_share <fraction>
+//
+// where <dist> is "const <v>", "uniform <lo> <hi>", "exponential <mean>",
+// "normal <mean> <sd>" or "pareto <min> <shape>". Blank lines and '#'
+// comments are skipped. Returns 0, or -1 with *line_number at the offending
+// line.
+int sched_workload_read(FILE *in, SchedWorkload *workload, int *line_number);
+
+// Fills tasks[0..processes-1] with one instance, ids from 1 in arrival
+// order. The same seed always gives the same instance. Returns 0, or -1 if
+// the arrivals would pass SCHED_SIM_MAX_HORIZON.
+int sched_workload_generate(const SchedWorkload *workload, unsigned long seed, SchedTask *tasks);
+
+#endif
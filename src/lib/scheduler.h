@@ -0,0 +1,464 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "rbtree.h"
+#include "sched_topology.h"
+
+// libscheduler: the DPS-DTQ, CFS, reference SRPT, EDF, MLFQ, stride and
+// lottery policies behind an online API.
+//
+// The caller owns the clock and the task storage. A typical dispatch loop:
+//
+//     sched_submit(s, task);                  // when the task arrives
+//     task = sched_pick_next(s, now);         // task->slice holds the quantum
+//     ...run it for up to task->slice...
+//     if (sched_charge(s, task, ran) == 0)    // requeued while work remains
+//         sched_complete(s, task, now + ran);
+//
+// All state lives in the Scheduler instance, so independent instances can be
+// used concurrently (one per worker shard); a single instance is not
+// thread-safe.
+
+typedef enum
+{
+    SCHED_POLICY_DPS_DTQ,
+    SCHED_POLICY_CFS,
+    SCHED_POLICY_REFERENCE, // SRPT with a mean/median adaptive quantum
+    SCHED_POLICY_EDF,       // Preemptive earliest deadline first
+    SCHED_POLICY_MLFQ,      // Multi-level feedback queue
+    SCHED_POLICY_STRIDE,    // Deterministic proportional share by tickets
+    SCHED_POLICY_LOTTERY    // Randomized proportional share by tickets
+} SchedPolicy;
+
+// What EDF does with a job that would push the admitted utilization past
+// the bound
+typedef enum
+{
+    SCHED_ADMIT_ALL,    // No admission control
+    SCHED_ADMIT_REJECT, // Drop the job
+    SCHED_ADMIT_DEMOTE  // Run it in the background, after every deadline job
+} SchedAdmission;
+
+// sched_submit result for a task turned away by admission control
+#define SCHED_REJECTED 1
+
+#define SCHED_MAX_IO_PHASES 16
+
+#define SCHED_MLFQ_MAX_LEVELS 16
+
+#define SCHED_DEFAULT_GROUP_SHARES 1024
+
+#define SCHED_MAX_CRITICAL_SECTIONS 8
+#define SCHED_MAX_PREDECESSORS 8
+#define SCHED_MAX_RESOURCES 64
+
+// Tasks at or above this criticality count towards the high-criticality
+// turnaround in SchedMetrics
+#define SCHED_HIGH_CRITICALITY 8
+
+// Tasks that waited longer than this count as starved in SchedMetrics
+#define SCHED_STARVATION_THRESHOLD 20
+
+// How DPS-DTQ lifts a task that holds a shared resource
+typedef enum
+{
+    SCHED_LOCK_NONE,    // The holder keeps its own priority
+    SCHED_LOCK_INHERIT, // It runs at the priority of the tasks waiting on it
+    SCHED_LOCK_CEILING  // It runs at the priority of every ready task that uses the resource
+} SchedLockProtocol;
+
+// What the DPS-DTQ base quantum is steered by
+typedef enum
+{
+    SCHED_QUANTUM_FIXED,    // base_quantum, shortened as the ready queue grows
+    SCHED_QUANTUM_RESPONSE, // Held where the P99 response time is quantum_setpoint
+    SCHED_QUANTUM_SWITCHES  // Held where there are quantum_setpoint dispatches per 100 time units
+} SchedQuantumTarget;
+
+// A task that alternates CPU bursts with blocking I/O. After its first CPU
+// burst it blocks for wait[0], runs burst[0], blocks for wait[1], and so on.
+// The task's burst_time counts every CPU burst, these included.
+typedef struct
+{
+    int count;
+    int wait[SCHED_MAX_IO_PHASES];
+    int burst[SCHED_MAX_IO_PHASES];
+} SchedIoPhases;
+
+// Parts of a task's CPU work done while holding a shared resource. Section
+// i holds resource[i] from start[i] units of CPU work for length[i] units;
+// sections are in order and do not overlap, so a task holds at most one
+// resource at a time.
+typedef struct
+{
+    int count;
+    int resource[SCHED_MAX_CRITICAL_SECTIONS];
+    int start[SCHED_MAX_CRITICAL_SECTIONS];
+    int length[SCHED_MAX_CRITICAL_SECTIONS];
+} SchedCriticalSections;
+
+// Tasks, by id, that must complete before a task is released
+typedef struct
+{
+    int count;
+    int id[SCHED_MAX_PREDECESSORS];
+} SchedPredecessors;
+
+// A new field also goes into schedulerConfigHash, which checkpoints record
+typedef struct
+{
+    // DPS-DTQ
+    double base_quantum;         // Base time quantum
+    double criticality_weight;   // Weight for criticality (Wc)
+    double deadline_weight;      // Weight for deadline (Wf)
+    double aging_weight;         // Weight for aging (Wa)
+    double priority_weight;      // Weight for system priority (Ws)
+    double critical_path_weight; // Weight for the work left on the task's longest path (Wp)
+    bool preempt_on_arrival;     // A higher-priority arrival cuts the running slice
+    SchedLockProtocol lock_protocol;
+    SchedQuantumTarget quantum_target;
+    double quantum_setpoint;     // Must be positive unless the quantum is fixed
+
+    // CFS
+    double min_granularity;
+    double latency;
+    bool group_scheduling; // Share the CPU between groups first, then between a group's tasks
+
+    // EDF
+    SchedAdmission admission;
+    double utilization_bound; // Admitted sum of burst / min(deadline, period)
+
+    // MLFQ
+    int mlfq_levels;                             // Level 0 is the highest
+    int mlfq_quantum[SCHED_MLFQ_MAX_LEVELS];     // CPU time a task gets at each level before demotion
+    int mlfq_boost_period;                       // Every task returns to level 0 this often; 0 never
+
+    // Stride and lottery
+    int share_quantum;          // Slice handed out on every pick
+    unsigned long lottery_seed; // Same seed, same draws
+
+    // Multi-CPU placement (DPS-DTQ and CFS)
+    int affinity_wait; // Ready this long, a task may move to a cold LLC
+
+    bool class_metrics; // Break metrics down by class, see sched_class_stats
+} SchedConfig;
+
+// Per-job statistics of a periodic task, filled in by the simulator. A job's
+// response time runs from its release to its completion; jitter is the
+// spread (max - min) over every job released in the horizon.
+typedef struct
+{
+    long released;
+    long completed;
+    long missed;     // Jobs still running at their absolute deadline
+    long rejected;   // Jobs turned away by admission control
+    int outstanding; // Released but not yet completed
+    bool releasing;  // More releases are due before the horizon
+    int min_response;
+    int max_response;
+    double sum_response;
+    double sum_sq_response;
+    int min_start; // Release to first dispatch
+    int max_start;
+    int last_completion;
+} SchedJobStats;
+
+typedef struct SchedTask
+{
+    // Filled in by the caller before sched_submit
+    int id;
+    int arrival_time;
+    int burst_time;
+    int deadline;        // Relative to arrival_time, 0 for none
+    int criticality;     // Higher for safety-critical tasks (1-10)
+    int period;          // For periodic tasks
+    int system_priority; // Manual override or industry standard
+    SchedIoPhases io;    // count 0 for a purely CPU-bound task
+    int group;           // Tenant for CFS group scheduling and class metrics, 0 by default
+    SchedCriticalSections sections; // count 0 for a task that shares nothing
+    SchedPredecessors after;        // count 0 for a task released at arrival_time
+    void *user_data;
+
+    // Maintained by the scheduler
+    int remaining_burst;
+    int burst_left;    // CPU time before the task next blocks or completes
+    int io_next;       // Next I/O phase
+    int blocked_since; // Start of the I/O phase in progress
+    int blocked_time;  // Time spent in I/O so far
+    int section_next;  // Critical section held or next to take
+    bool holding;      // Whether it holds section_next's resource
+    int lock_since;    // Start of the wait for a resource
+    bool lock_inverted; // The wait is behind a less critical holder
+    int slice; // Quantum granted by the last sched_pick_next
+    int absolute_deadline; // arrival_time + deadline, 0 for none
+    int first_execution_time;
+    int completion_time;
+    int turnaround_time;
+    int waiting_time;
+    int response_time;
+    bool executed;
+    bool completed;
+
+    int dynamic_priority; // DPS-DTQ priority scaled by 100
+    int nice;             // CFS nice value derived from criticality
+    double weight;
+    double vruntime;
+
+    RBTreeNode node;      // CFS run-queue linkage
+    int heap_index;       // EDF or stride heap slot, -1 when not queued
+    double utilization;   // Share held under EDF admission control
+    bool demoted;         // EDF runs it in the background
+    bool rejected;        // Turned away by admission control
+    void *deadline_event; // Pending deadline event in the simulator
+    int level;            // MLFQ level
+    int level_used;       // CPU time used at the current MLFQ level
+    int boost_epoch;      // MLFQ boost the level dates from
+    struct SchedTask *queue_next; // MLFQ level queue linkage
+    struct SchedTask *waiter_next; // Resource wait queue linkage
+    int tickets;          // Stride and lottery share
+    long pass;            // Stride pass value
+    int quantum_used;     // Lottery: part of its last quantum the task ran
+    int last_ran;         // End of the task's last slice in the simulator, -1 if none
+    int last_cpu;         // CPU of the task's last slice in the simulator, -1 if none
+    int ready_since;      // When the task last went back on the run queue
+
+    // Precedence, maintained by sched_sim_run_tasks
+    int waiting_for;                // Predecessors not yet complete
+    bool arrived;                   // Reached arrival_time while still waiting
+    struct SchedTask **successors;
+    int successor_count;
+    int path_after;                 // Longest chain of work behind it, 0 if not linked
+
+    // Periodic release, maintained by the simulator
+    int job;                  // Release index, 0 for the first job
+    struct SchedTask *origin; // Periodic task a job was released from
+    int job_slot;             // Place among the simulator's live jobs
+    SchedJobStats jobs;       // Set on the periodic task itself
+} SchedTask;
+
+// CPU use of one group under CFS group scheduling
+typedef struct
+{
+    int group;
+    int shares;
+    long completed;     // Tasks and jobs of the group completed so far
+    long cpu_time;      // Time charged to the group's tasks
+    double sum_turnaround;
+} SchedGroupStats;
+
+// The DPS-DTQ quantum controller so far
+typedef struct
+{
+    double base;     // Base quantum in use now
+    double min_base;
+    double max_base;
+    double measured; // At the last step: the windowed P99 response time or dispatch rate
+    long steps;
+} SchedQuantumStats;
+
+typedef struct
+{
+    double avg_turnaround_time;
+    double avg_waiting_time;
+    double avg_response_time;
+    double throughput;
+    double fairness_index;
+    int starvation_count;
+    double load_balancing_efficiency;
+    long locks_taken;      // Critical sections entered
+    long lock_waits;       // Times a task found its resource held
+    long lock_wait_time;
+    long inversion_time;   // Waited behind a less critical holder
+    int max_inversion;     // Longest such wait
+    double avg_critical_turnaround; // Tasks with criticality >= SCHED_HIGH_CRITICALITY
+} SchedMetrics;
+
+// How sched_class_stats groups completed tasks
+typedef enum
+{
+    SCHED_CLASS_CRITICALITY, // key is the criticality, 0-10
+    SCHED_CLASS_PRIORITY,    // key is the band of system_priority: 0 for 1-3, 1 for 4-7, 2 for 8-10
+    SCHED_CLASS_GROUP        // key is the group (tenant)
+} SchedClassKind;
+
+#define SCHED_PRIORITY_BANDS 3
+
+// Metrics over the completed tasks of one class. Percentiles are nearest
+// rank, exact below 64 and at most 1/16 high above it.
+typedef struct
+{
+    SchedClassKind kind;
+    int key;
+    long completed;
+    long deadline_misses; // Still live when their absolute deadline passed
+    int starvation_count;
+    double avg_turnaround_time;
+    double avg_waiting_time;
+    double avg_response_time;
+    int p50_response_time;
+    int p95_response_time;
+    int p99_response_time;
+    int max_response_time;
+    int p99_turnaround_time;
+} SchedClassStats;
+
+// Latency histogram in fixed memory: exact below 64, then 16 buckets per
+// power of two up to 2^31
+#define SCHED_HISTOGRAM_BUCKETS (64 + 25 * 16)
+
+typedef struct
+{
+    long count;
+    int max;
+    long buckets[SCHED_HISTOGRAM_BUCKETS];
+} SchedHistogram;
+
+typedef struct Scheduler Scheduler;
+
+void sched_default_config(SchedPolicy policy, SchedConfig *config);
+
+// Returns NULL on allocation failure; config may be NULL for the defaults
+Scheduler *sched_create(SchedPolicy policy, const SchedConfig *config);
+void sched_destroy(Scheduler *sched);
+
+// Makes a task runnable; the task must stay valid until it is completed.
+// Returns SCHED_REJECTED if admission control turned it away, in which case
+// the scheduler holds no reference to it.
+int sched_submit(Scheduler *sched, SchedTask *task);
+
+// Removes and returns the task to run at `now`, or NULL if none is ready
+SchedTask *sched_pick_next(Scheduler *sched, int now);
+
+// sched_pick_next for one CPU of a multi-CPU system. With cache_hot_only set,
+// DPS-DTQ and CFS only hand out tasks that last ran under the CPU's LLC, have
+// not run yet, or have been ready for affinity_wait; NULL means none of the
+// ready tasks qualify. The other policies ignore placement.
+SchedTask *sched_pick_next_on(Scheduler *sched, int now, const SchedTopology *topology,
+                              int cpu, bool cache_hot_only);
+
+// Accounts `ran` time units to a picked task. Returns 1 if work remains and
+// the task went back on the run queue, 0 if it is ready to complete, and -1
+// if work remains but the run queue could not grow to take it back.
+int sched_charge(Scheduler *sched, SchedTask *task, int ran);
+
+void sched_complete(Scheduler *sched, SchedTask *task, int now);
+
+// Whether a task that sched_charge did not requeue has an I/O phase ahead of
+// it, rather than being ready to complete
+bool sched_io_pending(const SchedTask *task);
+
+// Takes a task whose CPU burst just ended off the CPU for its next I/O phase
+// and returns how long the I/O lasts. The task stays live, but is not ready
+// again until sched_wake.
+int sched_block(Scheduler *sched, SchedTask *task, int now);
+
+// Ends the task's I/O phase and queues it for its next CPU burst. Returns 0,
+// or -1 if the run queue could not grow.
+int sched_wake(Scheduler *sched, SchedTask *task, int now);
+
+// Releases the resource a task holds once its CPU work has reached the end
+// of the critical section, and hands it to the most critical waiter (the
+// longest waiting among equals). Call it after sched_charge. *woken is set
+// to the waiter, which is now ready, or NULL. Returns 0, or -1 if the run
+// queue could not grow.
+//
+// sched_pick_next takes resources as tasks reach their sections: a task
+// whose resource is held waits off the run queue, and the next task is
+// picked instead.
+int sched_unlock(Scheduler *sched, SchedTask *task, int now, SchedTask **woken);
+
+// CPU work a task can do before it next takes or releases a resource, or -1
+// if it has no critical section left; a slice should stop there
+int sched_lock_distance(const SchedTask *task);
+
+// Whether a task that just became ready should preempt the running one at
+// `now`. `ran` is the work the running task has done in its current slice,
+// which sched_charge has not yet taken.
+bool sched_should_preempt(Scheduler *sched, const SchedTask *running, int ran, const SchedTask *task, int now);
+
+// Tells the policy a task is still live past its absolute deadline
+void sched_deadline_passed(Scheduler *sched, SchedTask *task);
+
+int sched_ready_count(const Scheduler *sched);
+int sched_live_count(const Scheduler *sched);
+int sched_blocked_count(const Scheduler *sched);
+
+// Sets a group's CPU shares under CFS group scheduling, creating the group
+// if needed. Groups default to SCHED_DEFAULT_GROUP_SHARES. Returns -1 if the
+// group could not be created or the scheduler is not CFS.
+int sched_set_group_shares(Scheduler *sched, int group, int shares);
+
+// Copies up to `max` groups, in the order they were first seen, and returns
+// how many groups there are
+int sched_group_stats(const Scheduler *sched, SchedGroupStats *stats, int max);
+
+// Copies the state of the DPS-DTQ quantum controller. Returns false if the
+// quantum is fixed.
+bool sched_quantum_stats(const Scheduler *sched, SchedQuantumStats *stats);
+
+// Metrics over every task completed so far; total_time is the elapsed span
+void sched_metrics(const Scheduler *sched, int total_time, SchedMetrics *metrics);
+
+// With class_metrics set, copies up to `max` classes that have completed or
+// missed anything, criticalities first, then priority bands, then groups in
+// the order first seen, and returns how many there are. Each class keeps
+// running sums and a fixed histogram of its latencies, filled in by
+// sched_complete as tasks finish, so nothing is kept per task. Groups are
+// found through a hash, so any number of tenants costs the same per task.
+// Returns 0 without class_metrics.
+int sched_class_stats(const Scheduler *sched, SchedClassStats *stats, int max);
+
+// Every class sched_class_stats has, in a new array the caller frees. Returns
+// how many, or -1 if memory ran out.
+int sched_class_table(const Scheduler *sched, SchedClassStats **stats);
+
+// Writes classes as CSV rows under a header: "Criticality,<n>",
+// "Priority,1-3|4-7|8-10" and, when some task has a group other than 0,
+// "Group,<n>"
+void sched_write_class_stats(FILE *out, const SchedClassStats *stats, int count);
+
+// Writes a CSV row under a header for each of the n tasks that released
+// jobs. Response time runs from each job's release to its completion, and
+// jitter is the spread between the best and worst job. `rejected` adds a
+// RejectedJobs column for admission control.
+void sched_write_job_stats(FILE *out, const SchedTask *tasks, int n, bool rejected);
+
+// Counts a value into a zeroed histogram; negative values count as 0
+void sched_histogram_add(SchedHistogram *histogram, int value);
+
+// Nearest-rank percentile, at most 1/16 high and capped at the largest value
+// added. Returns 0 for an empty histogram.
+int sched_histogram_percentile(const SchedHistogram *histogram, int p);
+
+// Returned for a line that does not fit the reader's buffer: records and
+// their extensions are at most 255 characters long
+#define SCHED_LINE_TOO_LONG -2
+
+// fgets into `line` of `size` bytes. Returns 1, 0 at end of input, or
+// SCHED_LINE_TOO_LONG with the start of a line longer than size - 1
+// characters, leaving the rest unread.
+int sched_read_line(FILE *in, char *line, int size);
+
+// Reads the next "id arrival burst deadline criticality period priority"
+// record, skipping blank lines, '#' comments and the leading process count.
+// The record may go on with tags and I/O phases; see
+// sched_parse_extensions. Returns 1 on success, 0 at end of input, -1 on a
+// malformed line and SCHED_LINE_TOO_LONG on an over-long one.
+int sched_read_task(FILE *in, SchedTask *task, int *line_number);
+
+// Parses what may follow the seven fields of a record: tags, then
+// "<io_wait> <cpu_burst>" pairs, where the record's burst is the first CPU
+// burst. The tags are "group=<id>", "after=<id>[,<id>...]" predecessors and
+// any number of "cs=<resource>:<start>:<length>" critical sections, in
+// order of start. The group is 0 when untagged; group, sections and after
+// may be NULL to ignore them. Returns the CPU time in the pairs, to be added
+// to burst_time, or -1 if the rest of the record is malformed.
+int sched_parse_extensions(const char *text, SchedIoPhases *io, int *group,
+                           SchedCriticalSections *sections, SchedPredecessors *after);
+
+// Total I/O wait of a task
+int sched_io_time(const SchedIoPhases *io);
+
+#endif
@@ -0,0 +1,1546 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sched_sim.h"
+#include "sched_internal.h"
+#include "sched_log.h"
+#include "event_queue.h"
+
+#define CHECKPOINT_VERSION 4
+
+typedef struct
+{
+    SchedArrivalFn next_arrival;
+    void *source;
+    int last_arrival;
+} ArrivalSource;
+
+typedef struct
+{
+    SchedTask **order;
+    int n;
+    int next;
+} TaskArraySource;
+
+// One CPU of the simulated machine
+typedef struct
+{
+    SchedTask *running;
+    SimEvent *slice_event; // SLICE_END of the running task
+    int slice_start;       // When the running task's work starts, after any switch
+    int idle_since;
+    SchedTask *on_cpu;     // Cache owner of the task that ran last
+    bool preempt;          // A task that should displace `running` became ready
+} SimCpu;
+
+typedef struct
+{
+    Scheduler *sched;
+    const SchedSimHooks *hooks;
+    SchedSimOptions options;
+    SchedSimResult *result;
+    EventQueue queue;
+    ArrivalSource src;
+    long hyperperiod;  // LCM of the periods seen so far
+    int latest_offset; // Latest periodic arrival
+    int horizon;
+
+    const SchedTopology *topology; // NULL for a single CPU
+    SimCpu *cpus;
+    int cpu_count;
+
+    bool precedence; // Tasks are linked by sched_sim_run_tasks
+    SchedLog log;    // Written when options.decision_log is set
+
+    // Set for sched_sim_run_tasks, which alone can take checkpoints
+    SchedTask *tasks;
+    int n;
+    TaskArraySource *array;
+    bool checkpointed; // Taken, restored from, or not asked for
+    int next_periodic; // Next multiple of checkpoint_every to save at, 0 for none
+
+    SchedTask **jobs; // Released and not yet finished, each at its job_slot
+    int job_count;
+    int job_capacity;
+} Simulation;
+
+// Queues the next arrival; only one is ever pending, so the workload is
+// pulled lazily no matter how long it is.
+static int pullArrival(Simulation *sim)
+{
+    ArrivalSource *src = &sim->src;
+    SchedTask *task;
+    int status = src->next_arrival(src->source, &task);
+    if (status <= 0)
+        return status;
+
+    if (task->arrival_time < src->last_arrival)
+        return SCHED_SIM_UNORDERED;
+    src->last_arrival = task->arrival_time;
+
+    return eventQueuePush(&sim->queue, task->arrival_time, SIM_EVENT_ARRIVAL, task) != NULL ? 1 : -1;
+}
+
+static long gcd(long a, long b)
+{
+    while (b != 0)
+    {
+        long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Folds a new periodic task into the default horizon
+static void extendHorizon(Simulation *sim, const SchedTask *task)
+{
+    if (sim->options.horizon > 0)
+        return;
+
+    sim->hyperperiod = sim->hyperperiod / gcd(sim->hyperperiod, task->period) * task->period;
+    if (sim->hyperperiod > SCHED_SIM_MAX_HORIZON)
+        sim->hyperperiod = SCHED_SIM_MAX_HORIZON;
+    if (task->arrival_time > sim->latest_offset)
+        sim->latest_offset = task->arrival_time;
+
+    long horizon = sim->latest_offset + sim->hyperperiod;
+    sim->horizon = horizon < SCHED_SIM_MAX_HORIZON ? (int)horizon : SCHED_SIM_MAX_HORIZON;
+}
+
+static int rejectTask(Simulation *sim, SchedTask *task);
+
+// Tells the hooks and the decision log about a slice of work
+static void reportSlice(Simulation *sim, const SchedTask *task, int cpu, int start, int end)
+{
+    if (sim->hooks->on_slice != NULL)
+        sim->hooks->on_slice(sim->hooks->ctx, task, cpu, start, end);
+    if (sim->options.decision_log == NULL)
+        return;
+
+    SchedLogRecord record = {0};
+    record.type = SCHED_LOG_SLICE;
+    record.time = start;
+    record.id = task->id;
+    record.cpu = cpu;
+    record.length = end - start;
+    sched_log_write(&sim->log, &record);
+}
+
+// Logs a finished or rejected task; a completed one has missed its deadline
+// if the deadline event already fired
+static void logFinish(Simulation *sim, const SchedTask *task, int now)
+{
+    if (sim->options.decision_log == NULL)
+        return;
+
+    SchedLogRecord record = {0};
+    record.type = task->rejected ? SCHED_LOG_REJECT : SCHED_LOG_COMPLETE;
+    record.time = now;
+    record.id = task->id;
+    if (!task->rejected)
+    {
+        record.turnaround_time = task->turnaround_time;
+        record.response_time = task->response_time;
+        record.burst_time = task->burst_time;
+        record.blocked_time = task->blocked_time;
+        record.criticality = task->criticality;
+        record.missed = task->absolute_deadline > 0 && task->deadline_event == NULL;
+    }
+    sched_log_write(&sim->log, &record);
+}
+
+// Work the task on a CPU has done in its slice by `now`
+static int slicePart(const SimCpu *cpu, int now)
+{
+    return now > cpu->slice_start ? now - cpu->slice_start : 0;
+}
+
+// Flags the CPU a newly ready task should take over at `now`, if any. While
+// some CPU is idle nothing is cut; otherwise the weakest running task it
+// beats goes.
+static void notePreemption(Simulation *sim, const SchedTask *task, int now)
+{
+    SimCpu *target = NULL;
+
+    for (int i = 0; i < sim->cpu_count; i++)
+    {
+        SimCpu *cpu = &sim->cpus[i];
+        if (cpu->running == NULL)
+            return;
+        if (cpu->preempt || !sched_should_preempt(sim->sched, cpu->running, slicePart(cpu, now), task, now))
+            continue;
+        if (target == NULL ||
+            sched_should_preempt(sim->sched, cpu->running, slicePart(cpu, now), target->running, now))
+            target = cpu;
+    }
+
+    if (target != NULL)
+        target->preempt = true;
+}
+
+static int submitTask(Simulation *sim, SchedTask *task)
+{
+    int status = sched_submit(sim->sched, task);
+    if (status == SCHED_REJECTED)
+        return rejectTask(sim, task);
+    if (status != 0)
+        return -1;
+
+    // Every caller submits a task at its arrival time
+    notePreemption(sim, task, task->arrival_time);
+
+    task->deadline_event = NULL;
+    if (task->absolute_deadline > 0)
+    {
+        task->deadline_event = eventQueuePush(&sim->queue, task->absolute_deadline, SIM_EVENT_DEADLINE, task);
+        if (task->deadline_event == NULL)
+            return -1;
+    }
+    return 0;
+}
+
+// Live jobs are listed so that a checkpoint can number them
+static int trackJob(Simulation *sim, SchedTask *job)
+{
+    if (sim->job_count == sim->job_capacity)
+    {
+        int capacity = sim->job_capacity > 0 ? sim->job_capacity * 2 : 16;
+        SchedTask **jobs = realloc(sim->jobs, sizeof(SchedTask *) * capacity);
+        if (jobs == NULL)
+            return -1;
+        sim->jobs = jobs;
+        sim->job_capacity = capacity;
+    }
+
+    job->job_slot = sim->job_count;
+    sim->jobs[sim->job_count++] = job;
+    return 0;
+}
+
+static void untrackJob(Simulation *sim, SchedTask *job)
+{
+    SchedTask *last = sim->jobs[--sim->job_count];
+    sim->jobs[job->job_slot] = last;
+    last->job_slot = job->job_slot;
+}
+
+// Releases the next job of a periodic task at `now` and queues the release
+// after it
+static int releaseJob(Simulation *sim, SchedTask *task, int now)
+{
+    SchedTask *job = malloc(sizeof(SchedTask));
+    if (job == NULL)
+        return -1;
+
+    *job = *task;
+    job->arrival_time = now;
+    job->job = (int)task->jobs.released;
+    job->origin = task;
+    if (trackJob(sim, job) != 0)
+    {
+        free(job);
+        return -1;
+    }
+
+    task->jobs.released++;
+    task->jobs.outstanding++;
+    sim->result->jobs_released++;
+
+    if (submitTask(sim, job) != 0)
+        return -1;
+
+    return eventQueuePush(&sim->queue, now + task->period, SIM_EVENT_RELEASE, task) != NULL ? 0 : -1;
+}
+
+// The caller may free `owner` once it is done, so no CPU may refer to it
+static void forgetOwner(Simulation *sim, const SchedTask *owner)
+{
+    for (int i = 0; i < sim->cpu_count; i++)
+    {
+        if (sim->cpus[i].on_cpu == owner)
+            sim->cpus[i].on_cpu = NULL;
+    }
+}
+
+static void retireTask(Simulation *sim, SchedTask *task)
+{
+    forgetOwner(sim, task);
+    task->completed = true;
+    task->completion_time = task->jobs.last_completion;
+    if (sim->hooks->on_retire != NULL)
+        sim->hooks->on_retire(sim->hooks->ctx, task);
+}
+
+static void recordJob(SchedJobStats *stats, const SchedTask *job)
+{
+    int response = job->completion_time - job->arrival_time;
+    int start = job->first_execution_time - job->arrival_time;
+
+    if (stats->completed == 0 || response < stats->min_response)
+        stats->min_response = response;
+    if (stats->completed == 0 || response > stats->max_response)
+        stats->max_response = response;
+    if (stats->completed == 0 || start < stats->min_start)
+        stats->min_start = start;
+    if (stats->completed == 0 || start > stats->max_start)
+        stats->max_start = start;
+
+    stats->completed++;
+    stats->outstanding--;
+    stats->sum_response += response;
+    stats->sum_sq_response += (double)response * response;
+    stats->last_completion = job->completion_time;
+}
+
+// Hands a finished or rejected task to the caller, and frees it if it was a
+// job
+static void finishTask(Simulation *sim, SchedTask *task)
+{
+    SchedTask *origin = task->origin;
+
+    if (sim->hooks->on_complete != NULL)
+        sim->hooks->on_complete(sim->hooks->ctx, task);
+
+    if (origin != NULL)
+    {
+        untrackJob(sim, task);
+        free(task);
+        if (!origin->jobs.releasing && origin->jobs.outstanding == 0)
+            retireTask(sim, origin);
+    }
+}
+
+// Releases every successor whose last predecessor this was and whose
+// arrival time has passed; the rest are released when they arrive. Each
+// edge is visited once.
+static int releaseSuccessors(Simulation *sim, SchedTask *task, int now)
+{
+    for (int i = 0; i < task->successor_count; i++)
+    {
+        SchedTask *next = task->successors[i];
+        if (--next->waiting_for > 0 || !next->arrived)
+            continue;
+
+        next->arrival_time = now;
+        if (submitTask(sim, next) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+static int completeTask(Simulation *sim, SchedTask *task, int now)
+{
+    sched_complete(sim->sched, task, now);
+    logFinish(sim, task, now);
+    if (task->deadline_event != NULL)
+        eventQueueCancel(&sim->queue, task->deadline_event);
+
+    if (task->origin != NULL)
+        recordJob(&task->origin->jobs, task);
+    else
+        forgetOwner(sim, task);
+
+    int status = sim->precedence ? releaseSuccessors(sim, task, now) : 0;
+    finishTask(sim, task);
+    return status;
+}
+
+// Parks a task for its next I/O phase; the pending wakeup events are the
+// blocked queue, ordered by when each I/O completes
+static int blockTask(Simulation *sim, SchedTask *task, int now)
+{
+    int wait = sched_block(sim->sched, task, now);
+    sim->result->io_waits++;
+    return eventQueuePush(&sim->queue, now + wait, SIM_EVENT_WAKEUP, task) != NULL ? 0 : -1;
+}
+
+static int wakeTask(Simulation *sim, SchedTask *task, int now)
+{
+    if (sched_wake(sim->sched, task, now) != 0)
+        return -1;
+
+    notePreemption(sim, task, now);
+    return 0;
+}
+
+// A rejected task counts as done for its successors
+static int rejectTask(Simulation *sim, SchedTask *task)
+{
+    sim->result->rejected++;
+    logFinish(sim, task, task->arrival_time);
+    if (task->origin != NULL)
+    {
+        task->origin->jobs.rejected++;
+        task->origin->jobs.outstanding--;
+    }
+
+    int status = sim->precedence ? releaseSuccessors(sim, task, task->arrival_time) : 0;
+    finishTask(sim, task);
+    return status;
+}
+
+static int handleArrival(Simulation *sim, SchedTask *task, int now)
+{
+    task->job = 0;
+    task->origin = NULL;
+    task->last_ran = -1;
+    task->last_cpu = -1;
+
+    if (sim->precedence && task->waiting_for > 0)
+    {
+        task->arrived = true; // Its last predecessor releases it
+        return 0;
+    }
+
+    if (!sim->options.release_periodic || task->period <= 0)
+        return submitTask(sim, task);
+
+    memset(&task->jobs, 0, sizeof(SchedJobStats));
+    task->jobs.releasing = true;
+    task->completed = false;
+    extendHorizon(sim, task);
+
+    if (now < sim->horizon)
+        return releaseJob(sim, task, now);
+
+    task->jobs.releasing = false;
+    retireTask(sim, task);
+    return 0;
+}
+
+// Jobs of a periodic task run the same code on the same data
+static SchedTask *cacheOwner(SchedTask *task)
+{
+    return task->origin != NULL ? task->origin : task;
+}
+
+// Whether `task` last ran under a different LLC than `cpu`
+static bool migrates(const Simulation *sim, SchedTask *task, int cpu)
+{
+    const SchedTask *owner = cacheOwner(task);
+    return sim->topology != NULL && owner->last_cpu >= 0 &&
+           !sched_same_llc(sim->topology, owner->last_cpu, cpu);
+}
+
+// Time to switch `cpu` to `task` at `now`. A task moved to another LLC finds
+// the cache there cold and pays the migration cost on top.
+static int switchCost(const Simulation *sim, SchedTask *task, int cpu, int now)
+{
+    const SchedTask *owner = cacheOwner(task);
+    double refill = sim->options.cache_penalty;
+    int migration = 0;
+
+    if (migrates(sim, task, cpu))
+        migration = sched_migration_cost(sim->topology, owner->last_cpu, cpu);
+    else if (owner->last_ran >= 0 && sim->options.cache_decay > 0)
+        refill *= 1.0 - exp(-(double)(now - owner->last_ran) / sim->options.cache_decay);
+
+    return sim->options.switch_cost + migration + (int)(refill + 0.5);
+}
+
+// Stops the task running on `index` at `now`, charging the part of the
+// slice it used. Returns -1 if the task could not be requeued.
+static int preemptRunning(Simulation *sim, int index, int now)
+{
+    SimCpu *cpu = &sim->cpus[index];
+    SchedTask *task = cpu->running;
+    int ran = now - cpu->slice_start;
+
+    eventQueueCancel(&sim->queue, cpu->slice_event);
+
+    // Cut while still switching in: the rest of the switch never happens and
+    // the task's cache never warmed, so its next dispatch here switches again
+    if (ran < 0)
+    {
+        sim->result->switch_time += ran;
+        ran = 0;
+        cpu->on_cpu = NULL;
+    }
+    else
+    {
+        reportSlice(sim, task, index, cpu->slice_start, now);
+        cacheOwner(task)->last_ran = now;
+    }
+
+    // The slice was cut short, so work always remains and the task requeues
+    task->ready_since = now;
+    cpu->running = NULL;
+    cpu->slice_event = NULL;
+    cpu->idle_since = now;
+    sim->result->preemptions++;
+    return sched_charge(sim->sched, task, ran) < 0 ? -1 : 0;
+}
+
+// Starts a slice of `task` on `index` at `now`
+static int dispatchTask(Simulation *sim, int index, SchedTask *task, int now)
+{
+    SimCpu *cpu = &sim->cpus[index];
+    SchedTask *owner = cacheOwner(task);
+    SchedSimResult *result = sim->result;
+
+    if (now > cpu->idle_since)
+    {
+        result->idle_time += now - cpu->idle_since;
+        if (sim->hooks->on_slice != NULL)
+            sim->hooks->on_slice(sim->hooks->ctx, NULL, index, cpu->idle_since, now);
+    }
+
+    // Switching to a different task delays the start of its work
+    int overhead = 0;
+    if (owner != cpu->on_cpu || owner->last_cpu != index)
+    {
+        if (migrates(sim, task, index))
+            result->migrations++;
+        overhead = switchCost(sim, task, index, now);
+        result->switches++;
+        result->switch_time += overhead;
+        if (task->first_execution_time == now)
+            task->first_execution_time += overhead;
+        cpu->on_cpu = owner;
+    }
+    owner->last_cpu = index;
+    task->last_cpu = index;
+
+    // Taking or releasing a resource ends the slice, so the lock changes
+    // hands at the right point of the task's work
+    int execution_time = task->slice < task->burst_left ? task->slice : task->burst_left;
+    int until_lock = sched_lock_distance(task);
+    if (until_lock > 0 && until_lock < execution_time)
+        execution_time = until_lock;
+    cpu->running = task;
+    cpu->slice_start = now + overhead;
+    result->dispatches++;
+    cpu->slice_event = eventQueuePush(&sim->queue, cpu->slice_start + execution_time, SIM_EVENT_SLICE_END, task);
+    return cpu->slice_event != NULL ? 0 : -1;
+}
+
+void sched_sim_default_options(SchedSimOptions *options)
+{
+    options->release_periodic = true;
+    options->horizon = 0;
+    options->switch_cost = 0;
+    options->cache_penalty = 0;
+    options->cache_decay = 10;
+    options->topology = NULL;
+    options->checkpoint_at = -1;
+    options->checkpoint_every = 0;
+    options->checkpoint_path = NULL;
+    options->decision_log = NULL;
+}
+
+double sched_sim_utilization(const SchedSimResult *result)
+{
+    long capacity = (long)result->total_time * (result->cpus > 0 ? result->cpus : 1);
+    if (capacity <= 0)
+        return 0.0;
+    return (double)(capacity - result->idle_time - result->switch_time) / capacity;
+}
+
+static int saveSimulation(Simulation *sim, int now, int time, const char *path);
+
+// Periodic checkpoints from `now` on are due at the next multiple of the
+// interval
+static void schedulePeriodic(Simulation *sim, int now)
+{
+    int every = sim->options.checkpoint_every;
+    sim->next_periodic = 0;
+    if (every > 0 && sim->options.checkpoint_path != NULL && now / every < INT_MAX / every - 1)
+        sim->next_periodic = (now / every + 1) * every;
+}
+
+// Saves what is due before the next event, at `time`. Idle stretches can
+// pass several periodic times at once; the state is the same at each, so
+// it is saved once, under the latest.
+static int takeCheckpoints(Simulation *sim, int now, int time)
+{
+    if (!sim->checkpointed && time >= sim->options.checkpoint_at)
+    {
+        sim->checkpointed = true;
+        if (saveSimulation(sim, now, sim->options.checkpoint_at, sim->options.checkpoint_path) != 0)
+            return -1;
+    }
+
+    if (sim->next_periodic > 0 && time >= sim->next_periodic)
+    {
+        int every = sim->options.checkpoint_every;
+        int at = time - time % every;
+        size_t size = strlen(sim->options.checkpoint_path) + 16;
+        char *path = malloc(size);
+        if (path == NULL)
+            return -1;
+
+        sched_sim_checkpoint_name(path, size, sim->options.checkpoint_path, at);
+        int status = saveSimulation(sim, now, at, path);
+        free(path);
+        schedulePeriodic(sim, at);
+        return status;
+    }
+    return 0;
+}
+
+// Sets up an empty machine; the caller queues the first arrival or restores
+// a checkpoint
+static int startSimulation(Simulation *sim, Scheduler *sched, const SchedSimHooks *hooks,
+                           const SchedSimOptions *options, SchedSimResult *result)
+{
+    static const SchedSimHooks no_hooks = {NULL, NULL, NULL, NULL};
+
+    memset(sim, 0, sizeof(Simulation));
+    sim->sched = sched;
+    sim->hooks = hooks != NULL ? hooks : &no_hooks;
+    if (options != NULL)
+        sim->options = *options;
+    else
+        sched_sim_default_options(&sim->options);
+    sim->result = result;
+    sim->hyperperiod = 1;
+    sim->horizon = sim->options.horizon;
+    sim->topology = sim->options.topology;
+    sim->cpu_count = sim->topology != NULL ? sim->topology->cpus : 1;
+    sim->checkpointed = sim->options.checkpoint_at < 0 || sim->options.checkpoint_path == NULL;
+    schedulePeriodic(sim, 0);
+    memset(result, 0, sizeof(SchedSimResult));
+    result->cpus = sim->cpu_count;
+    result->checkpoint_time = -1;
+    result->divergence = -1;
+
+    if (sim->options.decision_log != NULL && sched_log_start(&sim->log, sim->options.decision_log) != 0)
+        return -1;
+
+    sim->cpus = calloc(sim->cpu_count, sizeof(SimCpu));
+    if (sim->cpus == NULL)
+        return -1;
+    if (eventQueueInit(&sim->queue) != 0)
+    {
+        free(sim->cpus);
+        return -1;
+    }
+    return 0;
+}
+
+// Runs until the event queue drains, from a clock at `current_time`
+static int runSimulation(Simulation *sim, int current_time)
+{
+    Scheduler *sched = sim->sched;
+    SchedSimResult *result = sim->result;
+    int status = 0;
+
+    for (;;)
+    {
+        // Taken between instants, once every decision up to then is made
+        if (!sim->checkpointed || sim->next_periodic > 0)
+        {
+            const SimEvent *next = eventQueuePeek(&sim->queue);
+            if (next != NULL && takeCheckpoints(sim, current_time, next->time) != 0)
+            {
+                status = SCHED_SIM_BAD_CHECKPOINT;
+                break;
+            }
+        }
+
+        SimEvent *event = eventQueuePop(&sim->queue);
+        if (event == NULL)
+            break;
+
+        SchedTask *task = event->data;
+        result->events++;
+
+        // A release past the horizon does not move the clock, so the last
+        // busy instant stays the end of the run
+        bool past_horizon = event->type == SIM_EVENT_RELEASE && event->time >= sim->horizon;
+        if (!past_horizon)
+            current_time = event->time;
+
+        switch (event->type)
+        {
+        case SIM_EVENT_ARRIVAL:
+            if (handleArrival(sim, task, current_time) != 0)
+                status = -1;
+            else if ((status = pullArrival(sim)) > 0)
+                status = 0;
+            break;
+
+        case SIM_EVENT_RELEASE:
+            if (past_horizon)
+            {
+                task->jobs.releasing = false;
+                if (task->jobs.outstanding == 0)
+                    retireTask(sim, task);
+            }
+            else if (releaseJob(sim, task, current_time) != 0)
+            {
+                status = -1;
+            }
+            break;
+
+        case SIM_EVENT_SLICE_END:
+        {
+            SimCpu *cpu = &sim->cpus[task->last_cpu];
+            cpu->running = NULL;
+            cpu->slice_event = NULL;
+            cpu->idle_since = current_time;
+            reportSlice(sim, task, task->last_cpu, cpu->slice_start, current_time);
+            cacheOwner(task)->last_ran = current_time;
+
+            int requeued = sched_charge(sched, task, current_time - cpu->slice_start);
+            SchedTask *woken;
+            if (requeued < 0 || sched_unlock(sched, task, current_time, &woken) != 0)
+            {
+                status = -1;
+                break;
+            }
+            if (woken != NULL)
+                notePreemption(sim, woken, current_time);
+
+            if (requeued > 0)
+                task->ready_since = current_time;
+            else if (sched_io_pending(task))
+                status = blockTask(sim, task, current_time);
+            else
+                status = completeTask(sim, task, current_time);
+            break;
+        }
+
+        case SIM_EVENT_WAKEUP:
+            status = wakeTask(sim, task, current_time);
+            break;
+
+        case SIM_EVENT_DEADLINE:
+            task->deadline_event = NULL;
+            result->deadline_misses++;
+            if (task->origin != NULL)
+                task->origin->jobs.missed++;
+            sched_deadline_passed(sched, task);
+            break;
+        }
+
+        eventQueueRelease(&sim->queue, event);
+        if (status < 0)
+            break;
+
+        // Let the policy decide only once every event of this instant is in
+        const SimEvent *next = eventQueuePeek(&sim->queue);
+        if (next != NULL && next->time == current_time)
+            continue;
+
+        for (int i = 0; i < sim->cpu_count; i++)
+        {
+            if (sim->cpus[i].running != NULL && sim->cpus[i].preempt &&
+                preemptRunning(sim, i, current_time) != 0)
+                status = -1;
+            sim->cpus[i].preempt = false;
+        }
+
+        // Cache-hot placements first; then idle CPUs take whatever is left
+        int passes = sim->topology != NULL ? 2 : 1;
+        for (int pass = 0; pass < passes && status == 0; pass++)
+        {
+            for (int i = 0; i < sim->cpu_count; i++)
+            {
+                if (sim->cpus[i].running != NULL)
+                    continue;
+
+                SchedTask *running = sched_pick_next_on(sched, current_time, sim->topology, i, pass == 0);
+                if (running != NULL && dispatchTask(sim, i, running, current_time) != 0)
+                {
+                    status = -1;
+                    break;
+                }
+            }
+        }
+        if (status < 0)
+            break;
+    }
+
+    // CPUs left idle at the end of a multi-CPU run
+    for (int i = 0; i < sim->cpu_count && sim->cpu_count > 1; i++)
+    {
+        if (sim->cpus[i].running == NULL && current_time > sim->cpus[i].idle_since)
+            result->idle_time += current_time - sim->cpus[i].idle_since;
+    }
+
+    result->total_time = current_time;
+    result->horizon = sim->horizon;
+
+    if (sim->options.decision_log != NULL)
+    {
+        SchedLogRecord record = {0};
+        record.type = SCHED_LOG_END;
+        record.time = current_time;
+        record.cpus = sim->cpu_count;
+        sched_log_write(&sim->log, &record);
+        if (fflush(sim->options.decision_log) != 0 || ferror(sim->options.decision_log))
+            status = -1;
+    }
+    return status;
+}
+
+// Jobs still live after a failed run are freed with the rest
+static void endSimulation(Simulation *sim)
+{
+    for (int i = 0; i < sim->job_count; i++)
+        free(sim->jobs[i]);
+    free(sim->jobs);
+    eventQueueFree(&sim->queue);
+    free(sim->cpus);
+}
+
+int sched_sim_run(Scheduler *sched, SchedArrivalFn next_arrival, void *source,
+                  const SchedSimHooks *hooks, const SchedSimOptions *options,
+                  SchedSimResult *result)
+{
+    Simulation sim;
+    if (startSimulation(&sim, sched, hooks, options, result) != 0)
+        return -1;
+
+    sim.src.next_arrival = next_arrival;
+    sim.src.source = source;
+    sim.checkpointed = true;
+    sim.next_periodic = 0;
+
+    int status = pullArrival(&sim);
+    if (status >= 0)
+        status = runSimulation(&sim, 0);
+    endSimulation(&sim);
+    return status;
+}
+
+typedef struct
+{
+    int time;
+    int type;
+    unsigned long seq;
+    const SchedTask *task;
+} SavedEvent;
+
+typedef struct
+{
+    SavedEvent *events;
+    int count;
+} EventList;
+
+static void collectEvent(void *ctx, const SimEvent *event)
+{
+    EventList *list = ctx;
+    SavedEvent *saved = &list->events[list->count++];
+    saved->time = event->time;
+    saved->type = event->type;
+    saved->seq = event->seq;
+    saved->task = event->data;
+}
+
+static int compareSeq(const void *a, const void *b)
+{
+    const SavedEvent *x = a;
+    const SavedEvent *y = b;
+    return x->seq < y->seq ? -1 : (x->seq > y->seq);
+}
+
+static void saveTask(Checkpoint *ckpt, const SchedTask *task)
+{
+    checkpointPut(ckpt, task, sizeof(SchedTask));
+    checkpointPut(ckpt, &task->job_slot, sizeof(task->job_slot));
+    checkpointPutTask(ckpt, task->origin);
+}
+
+// Writes the whole state of the run at `now` in one go, as the checkpoint
+// for `time`: the tasks that have arrived and the live jobs, the clock and
+// sums so far, the CPUs, the pending events in the order they were queued,
+// and the scheduler. Tasks yet to arrive are untouched but for their count
+// of predecessors still running, so only that is kept of them.
+// Everything besides the tasks that steers a run: the scheduler config, the
+// switch and cache costs and the topology
+static uint64_t setupHash(const Scheduler *sched, const SchedSimOptions *options)
+{
+    uint64_t hash = schedulerConfigHash(sched);
+    hash = checkpointHash(hash, &options->switch_cost, sizeof(options->switch_cost));
+    hash = checkpointHash(hash, &options->cache_penalty, sizeof(options->cache_penalty));
+    hash = checkpointHash(hash, &options->cache_decay, sizeof(options->cache_decay));
+
+    const SchedTopology *topology = options->topology;
+    if (topology != NULL)
+    {
+        hash = checkpointHash(hash, &topology->cpus, sizeof(topology->cpus));
+        hash = checkpointHash(hash, topology->llc, sizeof(int) * topology->cpus);
+        hash = checkpointHash(hash, topology->node, sizeof(int) * topology->cpus);
+        hash = checkpointHash(hash, &topology->llc_migration_cost, sizeof(topology->llc_migration_cost));
+        hash = checkpointHash(hash, &topology->node_migration_cost, sizeof(topology->node_migration_cost));
+    }
+    return hash;
+}
+
+static int saveSimulation(Simulation *sim, int now, int time, const char *path)
+{
+    static const char magic[8] = "SCHEDCKP";
+    Checkpoint ckpt;
+    memset(&ckpt, 0, sizeof(ckpt));
+    ckpt.tasks = sim->tasks;
+    ckpt.n = sim->n;
+
+    EventList list;
+    list.events = malloc(sizeof(SavedEvent) * (sim->queue.size > 0 ? sim->queue.size : 1));
+    list.count = 0;
+    if (list.events == NULL)
+        return -1;
+    eventQueueVisit(&sim->queue, collectEvent, &list);
+    qsort(list.events, list.count, sizeof(SavedEvent), compareSeq);
+
+    int version = CHECKPOINT_VERSION;
+    int task_size = sizeof(SchedTask);
+    uint64_t setup = setupHash(sim->sched, &sim->options);
+    sim->result->checkpoint_time = time;
+    checkpointPut(&ckpt, magic, sizeof(magic));
+    checkpointPut(&ckpt, &version, sizeof(version));
+    checkpointPut(&ckpt, &task_size, sizeof(task_size));
+    checkpointPut(&ckpt, &sim->n, sizeof(sim->n));
+    checkpointPut(&ckpt, &sim->job_count, sizeof(sim->job_count));
+    checkpointPut(&ckpt, &sim->cpu_count, sizeof(sim->cpu_count));
+    checkpointPut(&ckpt, &setup, sizeof(setup));
+
+    const TaskArraySource *array = sim->array;
+    checkpointPut(&ckpt, &array->next, sizeof(array->next));
+    for (int i = 0; i < array->next; i++)
+    {
+        checkpointPutTask(&ckpt, array->order[i]);
+        saveTask(&ckpt, array->order[i]);
+    }
+
+    int waiting = 0;
+    for (int i = array->next; i < array->n; i++)
+        waiting += array->order[i]->waiting_for != array->order[i]->after.count;
+    checkpointPut(&ckpt, &waiting, sizeof(waiting));
+    for (int i = array->next; i < array->n; i++)
+    {
+        if (array->order[i]->waiting_for == array->order[i]->after.count)
+            continue;
+        checkpointPutTask(&ckpt, array->order[i]);
+        checkpointPut(&ckpt, &array->order[i]->waiting_for, sizeof(int));
+    }
+
+    for (int i = 0; i < sim->job_count; i++)
+        saveTask(&ckpt, sim->jobs[i]);
+
+    checkpointPut(&ckpt, &now, sizeof(now));
+    checkpointPut(&ckpt, &sim->src.last_arrival, sizeof(sim->src.last_arrival));
+    checkpointPut(&ckpt, &sim->hyperperiod, sizeof(sim->hyperperiod));
+    checkpointPut(&ckpt, &sim->latest_offset, sizeof(sim->latest_offset));
+    checkpointPut(&ckpt, &sim->horizon, sizeof(sim->horizon));
+    checkpointPut(&ckpt, &sim->options.horizon, sizeof(sim->options.horizon));
+    checkpointPut(&ckpt, &sim->options.release_periodic, sizeof(sim->options.release_periodic));
+    checkpointPut(&ckpt, sim->result, sizeof(SchedSimResult));
+
+    for (int i = 0; i < sim->cpu_count; i++)
+    {
+        const SimCpu *cpu = &sim->cpus[i];
+        checkpointPutTask(&ckpt, cpu->running);
+        checkpointPut(&ckpt, &cpu->slice_start, sizeof(cpu->slice_start));
+        checkpointPut(&ckpt, &cpu->idle_since, sizeof(cpu->idle_since));
+        checkpointPutTask(&ckpt, cpu->on_cpu);
+        checkpointPut(&ckpt, &cpu->preempt, sizeof(cpu->preempt));
+    }
+
+    checkpointPut(&ckpt, &list.count, sizeof(list.count));
+    for (int i = 0; i < list.count; i++)
+    {
+        checkpointPut(&ckpt, &list.events[i].time, sizeof(list.events[i].time));
+        checkpointPut(&ckpt, &list.events[i].type, sizeof(list.events[i].type));
+        checkpointPut(&ckpt, &list.events[i].seq, sizeof(list.events[i].seq));
+        checkpointPutTask(&ckpt, list.events[i].task);
+    }
+    free(list.events);
+
+    schedulerSave(sim->sched, &ckpt);
+
+    int status = ckpt.failed ? -1 : checkpointWrite(&ckpt, path);
+    free(ckpt.data);
+    return status;
+}
+
+// Takes a saved task body over the caller's task. The caller's user_data and
+// successor lists stay, and links into queues are rebuilt later.
+static int restoreTask(Checkpoint *ckpt, SchedTask *task, bool is_job)
+{
+    SchedTask saved;
+    int job_slot;
+    checkpointGet(ckpt, &saved, sizeof(SchedTask));
+    checkpointGet(ckpt, &job_slot, sizeof(job_slot));
+    SchedTask *origin = checkpointGetTask(ckpt);
+    if (ckpt->failed || (is_job ? origin == NULL : saved.id != task->id))
+        return -1;
+
+    const SchedTask *owner = is_job ? origin : task;
+    saved.user_data = owner->user_data;
+    saved.successors = owner->successors;
+    saved.successor_count = owner->successor_count;
+    saved.origin = origin;
+    saved.job_slot = job_slot;
+    memset(&saved.node, 0, sizeof(RBTreeNode));
+    saved.deadline_event = NULL;
+    saved.queue_next = NULL;
+    saved.waiter_next = NULL;
+    *task = saved;
+    return 0;
+}
+
+// Reads a checkpoint of the same tasks back into a fresh simulation; jobs
+// are allocated again and the pending events requeued in their old order
+static int restoreSimulation(Simulation *sim, const char *path, int *now)
+{
+    static const char magic[8] = "SCHEDCKP";
+    Checkpoint ckpt;
+    memset(&ckpt, 0, sizeof(ckpt));
+    if (checkpointRead(&ckpt, path) != 0)
+    {
+        free(ckpt.data);
+        return -1;
+    }
+
+    char file_magic[8];
+    int version, task_size, n, job_count, cpus;
+    uint64_t setup; // Free to differ here, see sched_sim_resume_tasks
+    checkpointGet(&ckpt, file_magic, sizeof(file_magic));
+    checkpointGet(&ckpt, &version, sizeof(version));
+    checkpointGet(&ckpt, &task_size, sizeof(task_size));
+    checkpointGet(&ckpt, &n, sizeof(n));
+    checkpointGet(&ckpt, &job_count, sizeof(job_count));
+    checkpointGet(&ckpt, &cpus, sizeof(cpus));
+    checkpointGet(&ckpt, &setup, sizeof(setup));
+    if (ckpt.failed || memcmp(file_magic, magic, sizeof(magic)) != 0 ||
+        version != CHECKPOINT_VERSION || task_size != (int)sizeof(SchedTask) ||
+        n != sim->n || cpus != sim->cpu_count || job_count < 0 ||
+        (size_t)job_count > ckpt.size / sizeof(SchedTask))
+    {
+        free(ckpt.data);
+        return -1;
+    }
+
+    for (int i = 0; i < job_count; i++)
+    {
+        SchedTask *job = malloc(sizeof(SchedTask));
+        if (job == NULL || trackJob(sim, job) != 0)
+        {
+            free(job);
+            free(ckpt.data);
+            return -1;
+        }
+    }
+
+    ckpt.tasks = sim->tasks;
+    ckpt.n = sim->n;
+    ckpt.jobs = sim->jobs;
+    ckpt.job_count = sim->job_count;
+
+    // The tasks must have arrived in the same order up to the checkpoint;
+    // the rest keep the caller's parameters
+    TaskArraySource *array = sim->array;
+    int status = 0;
+    int next, waiting;
+    checkpointGet(&ckpt, &next, sizeof(next));
+    if (next < 0 || next > n)
+        status = -1;
+    for (int i = 0; i < next && status == 0; i++)
+    {
+        if (checkpointGetTask(&ckpt) != array->order[i])
+            status = -1;
+        else
+            status = restoreTask(&ckpt, array->order[i], false);
+    }
+    array->next = next;
+
+    checkpointGet(&ckpt, &waiting, sizeof(waiting));
+    for (int i = 0; i < waiting && status == 0 && !ckpt.failed; i++)
+    {
+        SchedTask *task = checkpointGetTask(&ckpt);
+        if (task == NULL || task >= sim->tasks + n)
+            status = -1;
+        else
+            checkpointGet(&ckpt, &task->waiting_for, sizeof(task->waiting_for));
+    }
+
+    for (int i = 0; i < job_count && status == 0; i++)
+        status = restoreTask(&ckpt, sim->jobs[i], true);
+    for (int i = 0; i < job_count && status == 0; i++)
+    {
+        if (sim->jobs[i]->job_slot != i)
+            status = -1;
+    }
+
+    checkpointGet(&ckpt, now, sizeof(*now));
+    checkpointGet(&ckpt, &sim->src.last_arrival, sizeof(sim->src.last_arrival));
+    checkpointGet(&ckpt, &sim->hyperperiod, sizeof(sim->hyperperiod));
+    checkpointGet(&ckpt, &sim->latest_offset, sizeof(sim->latest_offset));
+    checkpointGet(&ckpt, &sim->horizon, sizeof(sim->horizon));
+    checkpointGet(&ckpt, &sim->options.horizon, sizeof(sim->options.horizon));
+    checkpointGet(&ckpt, &sim->options.release_periodic, sizeof(sim->options.release_periodic));
+    checkpointGet(&ckpt, sim->result, sizeof(SchedSimResult));
+
+    for (int i = 0; i < sim->cpu_count && status == 0; i++)
+    {
+        SimCpu *cpu = &sim->cpus[i];
+        cpu->running = checkpointGetTask(&ckpt);
+        checkpointGet(&ckpt, &cpu->slice_start, sizeof(cpu->slice_start));
+        checkpointGet(&ckpt, &cpu->idle_since, sizeof(cpu->idle_since));
+        cpu->on_cpu = checkpointGetTask(&ckpt);
+        checkpointGet(&ckpt, &cpu->preempt, sizeof(cpu->preempt));
+    }
+
+    int count;
+    checkpointGet(&ckpt, &count, sizeof(count));
+    for (int i = 0; i < count && status == 0 && !ckpt.failed; i++)
+    {
+        int time, type;
+        unsigned long seq;
+        checkpointGet(&ckpt, &time, sizeof(time));
+        checkpointGet(&ckpt, &type, sizeof(type));
+        checkpointGet(&ckpt, &seq, sizeof(seq));
+        SchedTask *task = checkpointGetTask(&ckpt);
+        if (task == NULL || type < SIM_EVENT_SLICE_END || type > SIM_EVENT_DEADLINE)
+        {
+            status = -1;
+            break;
+        }
+
+        SimEvent *event = eventQueueRestore(&sim->queue, time, type, seq, task);
+        if (event == NULL)
+            status = -1;
+        else if (type == SIM_EVENT_DEADLINE)
+            task->deadline_event = event;
+        else if (type == SIM_EVENT_SLICE_END)
+        {
+            if (task->last_cpu < 0 || task->last_cpu >= sim->cpu_count ||
+                sim->cpus[task->last_cpu].running != task)
+                status = -1;
+            else
+                sim->cpus[task->last_cpu].slice_event = event;
+        }
+    }
+
+    if (status == 0 && !ckpt.failed)
+        status = schedulerRestore(sim->sched, &ckpt);
+    if (ckpt.failed || ckpt.pos != ckpt.size)
+        status = -1;
+
+    free(ckpt.data);
+    return status;
+}
+
+typedef struct
+{
+    int id;
+    int index;
+} TaskId;
+
+static int compareId(const void *a, const void *b)
+{
+    const TaskId *x = a;
+    const TaskId *y = b;
+    if (x->id != y->id)
+        return x->id < y->id ? -1 : 1;
+    return x->index - y->index;
+}
+
+// Index of the only task with `id`, or -1 if there is none or several
+static int findTask(const TaskId *ids, int n, int id)
+{
+    int low = 0;
+    int high = n;
+    while (low < high)
+    {
+        int mid = low + (high - low) / 2;
+        if (ids[mid].id < id)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low == n || ids[low].id != id || (low + 1 < n && ids[low + 1].id == id))
+        return -1;
+    return ids[low].index;
+}
+
+// Turns the tasks' predecessor ids into successor lists, held in one block
+// the caller frees, and works out path_after in reverse topological order.
+// Returns the number of edges, -1 when out of memory, or
+// SCHED_SIM_BAD_PRECEDENCE.
+static long linkTasks(SchedTask *tasks, int n, bool release_periodic, SchedTask ***block)
+{
+    long edges = 0;
+    for (int i = 0; i < n; i++)
+    {
+        tasks[i].waiting_for = tasks[i].after.count;
+        tasks[i].arrived = false;
+        tasks[i].successors = NULL;
+        tasks[i].successor_count = 0;
+        tasks[i].path_after = 0;
+        edges += tasks[i].after.count;
+    }
+
+    *block = NULL;
+    if (edges == 0)
+        return 0;
+
+    TaskId *ids = malloc(sizeof(TaskId) * n);
+    int *predecessor = malloc(sizeof(int) * edges);
+    int *order = malloc(sizeof(int) * n);
+    int *indegree = malloc(sizeof(int) * n);
+    *block = malloc(sizeof(SchedTask *) * edges);
+    long status = edges;
+    if (ids == NULL || predecessor == NULL || order == NULL || indegree == NULL || *block == NULL)
+    {
+        status = -1;
+        goto done;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        ids[i].id = tasks[i].id;
+        ids[i].index = i;
+    }
+    qsort(ids, n, sizeof(TaskId), compareId);
+
+    // Re-releasing periodic tasks have no single completion to wait for
+    long edge = 0;
+    for (int i = 0; i < n; i++)
+    {
+        for (int k = 0; k < tasks[i].after.count; k++)
+        {
+            int from = findTask(ids, n, tasks[i].after.id[k]);
+            if (from < 0 || from == i ||
+                (release_periodic && (tasks[i].period > 0 || tasks[from].period > 0)))
+            {
+                status = SCHED_SIM_BAD_PRECEDENCE;
+                goto done;
+            }
+            predecessor[edge++] = from;
+            tasks[from].successor_count++;
+        }
+    }
+
+    // Each task's successors get a run of the block; successor_count counts
+    // back up as it is filled
+    SchedTask **next_slot = *block;
+    for (int i = 0; i < n; i++)
+    {
+        tasks[i].successors = next_slot;
+        next_slot += tasks[i].successor_count;
+        tasks[i].successor_count = 0;
+    }
+    edge = 0;
+    for (int i = 0; i < n; i++)
+    {
+        for (int k = 0; k < tasks[i].after.count; k++)
+        {
+            SchedTask *from = &tasks[predecessor[edge++]];
+            from->successors[from->successor_count++] = &tasks[i];
+        }
+    }
+
+    // Kahn's algorithm; whatever it cannot order sits on a cycle
+    int head = 0;
+    int tail = 0;
+    for (int i = 0; i < n; i++)
+    {
+        indegree[i] = tasks[i].after.count;
+        if (indegree[i] == 0)
+            order[tail++] = i;
+    }
+    while (head < tail)
+    {
+        SchedTask *task = &tasks[order[head++]];
+        for (int k = 0; k < task->successor_count; k++)
+        {
+            int next = (int)(task->successors[k] - tasks);
+            if (--indegree[next] == 0)
+                order[tail++] = next;
+        }
+    }
+    if (tail < n)
+    {
+        status = SCHED_SIM_BAD_PRECEDENCE;
+        goto done;
+    }
+
+    for (int i = n - 1; i >= 0; i--)
+    {
+        SchedTask *task = &tasks[order[i]];
+        for (int k = 0; k < task->successor_count; k++)
+        {
+            const SchedTask *next = task->successors[k];
+            if (next->burst_time + next->path_after > task->path_after)
+                task->path_after = next->burst_time + next->path_after;
+        }
+    }
+
+done:
+    free(ids);
+    free(predecessor);
+    free(order);
+    free(indegree);
+    return status;
+}
+
+static int compareArrival(const void *a, const void *b)
+{
+    const SchedTask *t1 = *(SchedTask *const *)a;
+    const SchedTask *t2 = *(SchedTask *const *)b;
+    if (t1->arrival_time != t2->arrival_time)
+        return t1->arrival_time - t2->arrival_time;
+    return t1 < t2 ? -1 : (t1 > t2); // Input order among equal arrivals
+}
+
+static int nextFromArray(void *ctx, SchedTask **task)
+{
+    TaskArraySource *src = ctx;
+    if (src->next == src->n)
+        return 0;
+
+    *task = src->order[src->next++];
+    return 1;
+}
+
+// Runs an array of tasks from the start, or from the checkpoint at
+// `resume_path` if set
+static int simulateTasks(Scheduler *sched, SchedTask *tasks, int n,
+                         const SchedSimHooks *hooks, const SchedSimOptions *options,
+                         const char *resume_path, SchedSimResult *result)
+{
+    TaskArraySource src;
+    src.order = malloc(sizeof(SchedTask *) * (n > 0 ? n : 1));
+    src.n = n;
+    src.next = 0;
+    if (src.order == NULL)
+        return -1;
+
+    for (int i = 0; i < n; i++)
+        src.order[i] = &tasks[i];
+    qsort(src.order, n, sizeof(SchedTask *), compareArrival);
+
+    SchedTask **successors;
+    bool release_periodic = options == NULL || options->release_periodic;
+    long edges = linkTasks(tasks, n, release_periodic, &successors);
+    if (edges < 0)
+    {
+        free(successors);
+        free(src.order);
+        return (int)edges;
+    }
+
+    Simulation sim;
+    if (startSimulation(&sim, sched, hooks, options, result) != 0)
+    {
+        free(successors);
+        free(src.order);
+        return -1;
+    }
+    sim.src.next_arrival = nextFromArray;
+    sim.src.source = &src;
+    sim.precedence = edges > 0;
+    sim.tasks = tasks;
+    sim.n = n;
+    sim.array = &src;
+
+    int status;
+    if (resume_path == NULL)
+        status = pullArrival(&sim) < 0 ? -1 : runSimulation(&sim, 0);
+    else
+    {
+        int now;
+        if (restoreSimulation(&sim, resume_path, &now) != 0)
+            status = SCHED_SIM_BAD_CHECKPOINT;
+        else
+        {
+            sim.checkpointed = sim.checkpointed || sim.options.checkpoint_at <= now;
+            schedulePeriodic(&sim, now);
+            status = runSimulation(&sim, now);
+        }
+    }
+    result->edges = edges;
+
+    endSimulation(&sim);
+    free(successors);
+    free(src.order);
+    return status;
+}
+
+int sched_sim_run_tasks(Scheduler *sched, SchedTask *tasks, int n,
+                        const SchedSimHooks *hooks, const SchedSimOptions *options,
+                        SchedSimResult *result)
+{
+    return simulateTasks(sched, tasks, n, hooks, options, NULL, result);
+}
+
+int sched_sim_resume_tasks(Scheduler *sched, SchedTask *tasks, int n,
+                           const SchedSimHooks *hooks, const SchedSimOptions *options,
+                           const char *path, SchedSimResult *result)
+{
+    return simulateTasks(sched, tasks, n, hooks, options, path, result);
+}
+
+int sched_sim_checkpoint_name(char *name, size_t size, const char *path, int time)
+{
+    return snprintf(name, size, "%s.%d", path, time);
+}
+
+static bool sameParameters(const SchedTask *a, const SchedTask *b)
+{
+    if (a->arrival_time != b->arrival_time || a->burst_time != b->burst_time ||
+        a->deadline != b->deadline || a->criticality != b->criticality ||
+        a->period != b->period || a->system_priority != b->system_priority || a->group != b->group)
+        return false;
+    if (a->io.count != b->io.count || a->sections.count != b->sections.count ||
+        a->after.count != b->after.count)
+        return false;
+
+    size_t io = sizeof(int) * a->io.count;
+    size_t sections = sizeof(int) * a->sections.count;
+    return memcmp(a->io.wait, b->io.wait, io) == 0 && memcmp(a->io.burst, b->io.burst, io) == 0 &&
+           memcmp(a->sections.resource, b->sections.resource, sections) == 0 &&
+           memcmp(a->sections.start, b->sections.start, sections) == 0 &&
+           memcmp(a->sections.length, b->sections.length, sections) == 0 &&
+           memcmp(a->after.id, b->after.id, sizeof(int) * a->after.count) == 0;
+}
+
+// Whether tasks[index] has predecessors or is one
+static bool isLinked(const SchedTask *tasks, int n, int index)
+{
+    if (tasks[index].after.count > 0)
+        return true;
+
+    for (int i = 0; i < n; i++)
+    {
+        for (int k = 0; k < tasks[i].after.count; k++)
+        {
+            if (tasks[i].after.id[k] == tasks[index].id)
+                return true;
+        }
+    }
+    return false;
+}
+
+// Arrival of the task just before tasks[index] in the order sched_sim_run_tasks
+// pulls them, or -1 if it comes first
+static int arrivalBefore(const SchedTask *tasks, int n, int index)
+{
+    int arrival = tasks[index].arrival_time;
+    int before = -1;
+    for (int i = 0; i < n; i++)
+    {
+        int other = tasks[i].arrival_time;
+        if (i != index && (other < arrival || (other == arrival && i < index)) && other > before)
+            before = other;
+    }
+    return before;
+}
+
+int sched_sim_divergence(const SchedTask *baseline, const SchedTask *edited, int n)
+{
+    int latest = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (baseline[i].id != edited[i].id)
+            return -1;
+        if (baseline[i].arrival_time > latest)
+            latest = baseline[i].arrival_time;
+        if (edited[i].arrival_time > latest)
+            latest = edited[i].arrival_time;
+    }
+
+    int divergence = latest;
+    for (int i = 0; i < n; i++)
+    {
+        if (sameParameters(&baseline[i], &edited[i]))
+            continue;
+        if (isLinked(baseline, n, i) || isLinked(edited, n, i))
+            return 0;
+
+        int before = arrivalBefore(baseline, n, i);
+        int edited_before = arrivalBefore(edited, n, i);
+        if (edited_before < before)
+            before = edited_before;
+        if (before < divergence)
+            divergence = before > 0 ? before : 0;
+    }
+    return divergence;
+}
+
+// Whether the checkpoint at `path` was saved under `setup`. One that cannot
+// be read passes, so resuming from it reports why.
+static bool savedUnder(const char *path, uint64_t setup)
+{
+    static const char magic[8] = "SCHEDCKP";
+    Checkpoint ckpt;
+    memset(&ckpt, 0, sizeof(ckpt));
+    if (checkpointRead(&ckpt, path) != 0)
+    {
+        free(ckpt.data);
+        return true;
+    }
+
+    char file_magic[8];
+    int version, fields[4];
+    uint64_t saved;
+    checkpointGet(&ckpt, file_magic, sizeof(file_magic));
+    checkpointGet(&ckpt, &version, sizeof(version));
+    checkpointGet(&ckpt, fields, sizeof(fields)); // Task size, n, jobs and CPUs
+    checkpointGet(&ckpt, &saved, sizeof(saved));
+    bool passes = ckpt.failed || memcmp(file_magic, magic, sizeof(magic)) != 0 ||
+                  version != CHECKPOINT_VERSION || saved == setup;
+    free(ckpt.data);
+    return passes;
+}
+
+int sched_sim_resume_before(Scheduler *sched, SchedTask *tasks, int n,
+                            const SchedSimHooks *hooks, const SchedSimOptions *options,
+                            int time, SchedSimResult *result)
+{
+    SchedSimOptions what_if;
+    if (options != NULL)
+        what_if = *options;
+    else
+        sched_sim_default_options(&what_if);
+    what_if.checkpoint_at = -1;
+    what_if.checkpoint_every = 0;
+
+    int every = options != NULL && options->checkpoint_path != NULL ? options->checkpoint_every : 0;
+    if (every <= 0 || time <= 0)
+    {
+        int status = simulateTasks(sched, tasks, n, hooks, &what_if, NULL, result);
+        result->divergence = time;
+        return status;
+    }
+
+    size_t size = strlen(options->checkpoint_path) + 16;
+    char *path = malloc(size);
+    if (path == NULL)
+        return -1;
+
+    // Idle stretches leave some multiples without a checkpoint of their own
+    int status = 1;
+    for (int at = time - time % every; at > 0 && status > 0; at -= every)
+    {
+        sched_sim_checkpoint_name(path, size, options->checkpoint_path, at);
+        FILE *file = fopen(path, "rb");
+        if (file == NULL)
+            continue;
+        fclose(file);
+
+        // Every checkpoint of the earlier run shares its setup, and under
+        // another one the runs may differ from the first decision
+        if (!savedUnder(path, setupHash(sched, &what_if)))
+        {
+            time = 0;
+            break;
+        }
+        status = simulateTasks(sched, tasks, n, hooks, &what_if, path, result);
+    }
+    free(path);
+
+    if (status > 0)
+        status = simulateTasks(sched, tasks, n, hooks, &what_if, NULL, result);
+    result->divergence = time;
+    return status;
+}
@@ -0,0 +1,274 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "scheduler.h"
+#include "sched_sim.h"
+
+#define MAX_LINE_LENGTH 256
+
+int sched_read_line(FILE *in, char *line, int size)
+{
+    if (fgets(line, size, in) == NULL)
+        return 0;
+    if (strchr(line, '\n') != NULL)
+        return 1;
+
+    // A line that exactly fills the buffer, or the last one of the input,
+    // ends here
+    int c = getc(in);
+    if (c == '\n' || c == EOF)
+        return 1;
+    ungetc(c, in);
+    return SCHED_LINE_TOO_LONG;
+}
+
+int sched_read_task(FILE *in, SchedTask *task, int *line_number)
+{
+    char line[MAX_LINE_LENGTH];
+    int status;
+
+    while ((status = sched_read_line(in, line, sizeof(line))) != 0)
+    {
+        (*line_number)++;
+        if (status < 0)
+            return status;
+
+        char *p = line;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#')
+            continue;
+
+        int consumed = 0;
+        int fields = sscanf(p, "%d %d %d %d %d %d %d%n",
+                            &task->id,
+                            &task->arrival_time,
+                            &task->burst_time,
+                            &task->deadline,
+                            &task->criticality,
+                            &task->period,
+                            &task->system_priority,
+                            &consumed);
+        if (fields == 7)
+        {
+            int io_work = sched_parse_extensions(p + consumed, &task->io, &task->group, &task->sections,
+                                                 &task->after);
+            if (io_work < 0)
+                return -1;
+            task->burst_time += io_work;
+            return 1;
+        }
+        if (fields == 1)
+            continue; // Process count header of the batch input format
+
+        return -1;
+    }
+
+    return 0;
+}
+
+// Adds a "cs=" tag's section after the ones already parsed
+static int addSection(SchedCriticalSections *sections, int resource, int start, int length)
+{
+    if (sections->count == SCHED_MAX_CRITICAL_SECTIONS ||
+        resource < 0 || resource >= SCHED_MAX_RESOURCES || start < 0 || length <= 0)
+        return -1;
+
+    int last = sections->count - 1;
+    if (last >= 0 && start < sections->start[last] + sections->length[last])
+        return -1;
+
+    sections->resource[sections->count] = resource;
+    sections->start[sections->count] = start;
+    sections->length[sections->count] = length;
+    sections->count++;
+    return 0;
+}
+
+// Parses the ids of an "after=" tag. Returns 1, 0 if there is none, or -1
+// if it lists too many.
+static int parsePredecessors(const char *text, SchedPredecessors *after, int *consumed)
+{
+    int id, used;
+    if (sscanf(text, " after=%d%n", &id, consumed) != 1)
+        return 0;
+
+    after->count = 0;
+    for (;;)
+    {
+        if (after->count == SCHED_MAX_PREDECESSORS)
+            return -1;
+        after->id[after->count++] = id;
+        if (sscanf(text + *consumed, ",%d%n", &id, &used) != 1)
+            return 1;
+        *consumed += used;
+    }
+}
+
+int sched_parse_extensions(const char *text, SchedIoPhases *io, int *group,
+                           SchedCriticalSections *sections, SchedPredecessors *after)
+{
+    SchedCriticalSections parsed;
+    SchedPredecessors predecessors;
+    int io_work = 0;
+    int wait, burst, consumed;
+    int tag, start, length;
+
+    io->count = 0;
+    parsed.count = 0;
+    predecessors.count = 0;
+    if (group != NULL)
+        *group = 0;
+
+    for (;;)
+    {
+        if (sscanf(text, " group=%d%n", &tag, &consumed) == 1)
+        {
+            if (tag < 0)
+                return -1;
+            if (group != NULL)
+                *group = tag;
+        }
+        else if (sscanf(text, " cs=%d:%d:%d%n", &tag, &start, &length, &consumed) == 3)
+        {
+            if (addSection(&parsed, tag, start, length) != 0)
+                return -1;
+        }
+        else
+        {
+            int found = parsePredecessors(text, &predecessors, &consumed);
+            if (found < 0)
+                return -1;
+            if (found == 0)
+                break;
+        }
+        text += consumed;
+    }
+    if (sections != NULL)
+        *sections = parsed;
+    if (after != NULL)
+        *after = predecessors;
+
+    while (sscanf(text, "%d %d%n", &wait, &burst, &consumed) == 2)
+    {
+        if (io->count == SCHED_MAX_IO_PHASES || wait < 0 || burst <= 0)
+            return -1;
+        io->wait[io->count] = wait;
+        io->burst[io->count] = burst;
+        io->count++;
+        io_work += burst;
+        text += consumed;
+    }
+
+    // Anything left must be blank or a trailing comment
+    while (*text == ' ' || *text == '\t')
+        text++;
+    if (*text != '\0' && *text != '\n' && *text != '\r' && *text != '#')
+        return -1;
+    return io_work;
+}
+
+int sched_io_time(const SchedIoPhases *io)
+{
+    int total = 0;
+    for (int i = 0; i < io->count; i++)
+        total += io->wait[i];
+    return total;
+}
+
+static void writeCompletion(FILE *out, const SchedTask *task)
+{
+    fprintf(out, "%d,%d,%d,%d,%d,%d,%d\n",
+            task->id,
+            task->arrival_time,
+            task->burst_time,
+            task->completion_time,
+            task->turnaround_time,
+            task->waiting_time,
+            task->response_time);
+}
+
+typedef struct
+{
+    FILE *in;
+    FILE *out;
+    int line_number;
+    bool reported; // The source has already said why it stopped the stream
+} StreamSource;
+
+static int nextFromStream(void *ctx, SchedTask **out)
+{
+    StreamSource *src = ctx;
+    SchedTask *task = calloc(1, sizeof(SchedTask));
+    if (task == NULL)
+        return -1;
+
+    int status = sched_read_task(src->in, task, &src->line_number);
+    if (status <= 0)
+    {
+        free(task);
+        if (status == SCHED_LINE_TOO_LONG)
+        {
+            fprintf(stderr, "Over-long line %d\n", src->line_number);
+            src->reported = true;
+        }
+        else if (status < 0)
+        {
+            fprintf(stderr, "Malformed record on line %d\n", src->line_number);
+            src->reported = true;
+        }
+        return status;
+    }
+
+    if (task->burst_time <= 0)
+    {
+        fprintf(stderr, "Line %d: burst time must be positive\n", src->line_number);
+        src->reported = true;
+        free(task);
+        return -1;
+    }
+
+    // A predecessor may have completed and been freed long before
+    if (task->after.count > 0)
+    {
+        fprintf(stderr, "Line %d: predecessors need the batch input format\n", src->line_number);
+        src->reported = true;
+        free(task);
+        return -1;
+    }
+
+    *out = task;
+    return 1;
+}
+
+static void emitCompletion(void *ctx, SchedTask *task)
+{
+    StreamSource *src = ctx;
+    if (!task->rejected)
+        writeCompletion(src->out, task);
+    if (task->origin == NULL)
+        free(task);
+}
+
+static void freeRetired(void *ctx, SchedTask *task)
+{
+    (void)ctx;
+    free(task);
+}
+
+int sched_run_stream(Scheduler *sched, FILE *in, FILE *out,
+                     const SchedSimOptions *options, SchedSimResult *result)
+{
+    StreamSource src = {in, out, 0, false};
+    SchedSimHooks hooks = {NULL, emitCompletion, freeRetired, &src};
+
+    fprintf(out, "ProcessID,ArrivalTime,BurstTime,CompletionTime,TurnaroundTime,WaitingTime,ResponseTime\n");
+
+    int status = sched_sim_run(sched, nextFromStream, &src, &hooks, options, result);
+    if (status == SCHED_SIM_UNORDERED)
+        fprintf(stderr, "Line %d: stream aborted, arrivals must be ordered by arrival_time\n", src.line_number);
+    else if (status != 0 && !src.reported)
+        fprintf(stderr, "Line %d: stream aborted, out of memory or the decision log failed\n", src.line_number);
+
+    return status != 0 ? -1 : 0;
+}
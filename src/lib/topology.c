@@ -0,0 +1,79 @@
+#include <string.h>
+
+#include "sched_topology.h"
+
+#define MAX_LINE_LENGTH 256
+
+void sched_topology_single(SchedTopology *topology)
+{
+    memset(topology, 0, sizeof(SchedTopology));
+    topology->cpus = 1;
+}
+
+int sched_topology_read(FILE *in, SchedTopology *topology, int *line_number)
+{
+    char line[MAX_LINE_LENGTH];
+    bool seen[SCHED_MAX_CPUS] = {false};
+
+    memset(topology, 0, sizeof(SchedTopology));
+    *line_number = 0;
+
+    while (fgets(line, sizeof(line), in) != NULL)
+    {
+        (*line_number)++;
+
+        char *p = line;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#')
+            continue;
+
+        int id, llc, node, cost;
+        if (sscanf(p, "cpu %d %d %d", &id, &llc, &node) == 3)
+        {
+            if (id < 0 || id >= SCHED_MAX_CPUS || seen[id])
+                return -1;
+            seen[id] = true;
+            topology->llc[id] = llc;
+            topology->node[id] = node;
+            if (id >= topology->cpus)
+                topology->cpus = id + 1;
+        }
+        else if (sscanf(p, "llc_migration_cost %d", &cost) == 1 && cost >= 0)
+            topology->llc_migration_cost = cost;
+        else if (sscanf(p, "node_migration_cost %d", &cost) == 1 && cost >= 0)
+            topology->node_migration_cost = cost;
+        else
+            return -1;
+    }
+
+    for (int i = 0; i < topology->cpus; i++)
+    {
+        if (!seen[i])
+        {
+            *line_number = 0;
+            return -1;
+        }
+    }
+    if (topology->cpus == 0)
+    {
+        *line_number = 0;
+        return -1;
+    }
+
+    return 0;
+}
+
+bool sched_same_llc(const SchedTopology *topology, int a, int b)
+{
+    return topology->node[a] == topology->node[b] && topology->llc[a] == topology->llc[b];
+}
+
+int sched_migration_cost(const SchedTopology *topology, int from, int to)
+{
+    if (from < 0 || sched_same_llc(topology, from, to))
+        return 0;
+    if (topology->node[from] != topology->node[to])
+        return topology->node_migration_cost;
+    return topology->llc_migration_cost;
+}
@@ -0,0 +1,602 @@
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scheduler.h"
+#include "sched_trace.h"
+
+#define MAX_LINE_LENGTH 1024
+
+// sched_read_task reads lines of up to 255 characters
+#define MAX_RECORD_LENGTH 254
+
+typedef enum
+{
+    TASK_SLEEPING,
+    TASK_RUNNABLE,
+    TASK_RUNNING
+} TaskState;
+
+// One process of the output, in nanoseconds until it is written
+typedef struct
+{
+    int pid;
+    int prio;
+    long arrival;
+    long burst[SCHED_MAX_IO_PHASES + 1]; // burst[k + 1] follows the I/O wait[k]
+    long wait[SCHED_MAX_IO_PHASES];
+    long wake[SCHED_MAX_IO_PHASES];      // When wait[k] ended
+    int phases;
+    long seq;       // Breaks ties on arrival, so the output is stable
+    int heap_index; // In whichever heap holds the record
+} TraceRecord;
+
+typedef struct
+{
+    int pid; // 0 for an empty slot; the idle task is never stored
+    TaskState state;
+    long since; // Start of the slice running, or of the sleep
+    int prio;
+    TraceRecord *open;
+} TraceTask;
+
+typedef struct
+{
+    TraceRecord **items;
+    int size;
+    int capacity;
+} RecordHeap;
+
+typedef struct
+{
+    const SchedTraceOptions *options;
+    SchedTraceStats *stats;
+    FILE *out;
+    TraceTask *tasks; // Open addressing on pid
+    int task_capacity;
+    RecordHeap open;    // Records still growing, by arrival
+    RecordHeap pending; // Closed records waiting for every earlier one
+    long origin;        // Timestamp of the first event, -1 before it
+    long now;
+    long next_seq;
+} Importer;
+
+static bool recordBefore(const TraceRecord *a, const TraceRecord *b)
+{
+    return a->arrival < b->arrival || (a->arrival == b->arrival && a->seq < b->seq);
+}
+
+static void heapSwap(RecordHeap *heap, int i, int j)
+{
+    TraceRecord *t = heap->items[i];
+    heap->items[i] = heap->items[j];
+    heap->items[j] = t;
+    heap->items[i]->heap_index = i;
+    heap->items[j]->heap_index = j;
+}
+
+static void siftUp(RecordHeap *heap, int i)
+{
+    while (i > 0 && recordBefore(heap->items[i], heap->items[(i - 1) / 2]))
+    {
+        heapSwap(heap, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void siftDown(RecordHeap *heap, int i)
+{
+    for (;;)
+    {
+        int least = i;
+        int left = 2 * i + 1;
+        if (left < heap->size && recordBefore(heap->items[left], heap->items[least]))
+            least = left;
+        if (left + 1 < heap->size && recordBefore(heap->items[left + 1], heap->items[least]))
+            least = left + 1;
+        if (least == i)
+            return;
+        heapSwap(heap, i, least);
+        i = least;
+    }
+}
+
+static int heapPush(RecordHeap *heap, TraceRecord *record)
+{
+    if (heap->size == heap->capacity)
+    {
+        int capacity = heap->capacity > 0 ? heap->capacity * 2 : 64;
+        TraceRecord **items = realloc(heap->items, sizeof(TraceRecord *) * capacity);
+        if (items == NULL)
+            return -1;
+        heap->items = items;
+        heap->capacity = capacity;
+    }
+
+    record->heap_index = heap->size;
+    heap->items[heap->size++] = record;
+    siftUp(heap, record->heap_index);
+    return 0;
+}
+
+static void heapRemove(RecordHeap *heap, TraceRecord *record)
+{
+    int i = record->heap_index;
+    heap->size--;
+    if (i == heap->size)
+        return;
+
+    heap->items[i] = heap->items[heap->size];
+    heap->items[i]->heap_index = i;
+    siftUp(heap, i);
+    siftDown(heap, heap->items[i]->heap_index);
+}
+
+static TraceTask *findTask(Importer *imp, int pid);
+
+// Keeps the table at most half full, so probes stay short
+static int growTasks(Importer *imp)
+{
+    TraceTask *old = imp->tasks;
+    int old_capacity = imp->task_capacity;
+    int capacity = old_capacity > 0 ? old_capacity * 2 : 1024;
+
+    imp->tasks = calloc(capacity, sizeof(TraceTask));
+    if (imp->tasks == NULL)
+    {
+        imp->tasks = old;
+        return -1;
+    }
+    imp->task_capacity = capacity;
+
+    for (int i = 0; i < old_capacity; i++)
+    {
+        if (old[i].pid != 0)
+            *findTask(imp, old[i].pid) = old[i];
+    }
+    free(old);
+    return 0;
+}
+
+// The task's slot, or the empty one it would take
+static TraceTask *findTask(Importer *imp, int pid)
+{
+    unsigned int mask = (unsigned int)imp->task_capacity - 1;
+    unsigned int slot = ((unsigned int)pid * 2654435761u) & mask;
+    while (imp->tasks[slot].pid != 0 && imp->tasks[slot].pid != pid)
+        slot = (slot + 1) & mask;
+    return &imp->tasks[slot];
+}
+
+// Returns the task for a pid, adding it asleep if it is new. The pointer
+// stays valid until the next call.
+static TraceTask *lookUp(Importer *imp, int pid)
+{
+    TraceTask *task = findTask(imp, pid);
+    if (task->pid == pid)
+        return task;
+
+    if (2 * (imp->stats->tasks + 1) > imp->task_capacity)
+    {
+        if (growTasks(imp) != 0)
+            return NULL;
+        task = findTask(imp, pid);
+    }
+
+    memset(task, 0, sizeof(TraceTask));
+    task->pid = pid;
+    task->state = TASK_SLEEPING;
+    task->prio = 120;
+    imp->stats->tasks++;
+    return task;
+}
+
+static int openRecord(Importer *imp, TraceTask *task, long now)
+{
+    TraceRecord *record = calloc(1, sizeof(TraceRecord));
+    if (record == NULL)
+        return -1;
+
+    record->pid = task->pid;
+    record->prio = task->prio;
+    record->arrival = now;
+    record->seq = imp->next_seq++;
+    if (heapPush(&imp->open, record) != 0)
+    {
+        free(record);
+        return -1;
+    }
+    task->open = record;
+    return 0;
+}
+
+// Moves the task's record to the pending heap, without the I/O of a last
+// phase that never ran
+static int closeRecord(Importer *imp, TraceTask *task)
+{
+    TraceRecord *record = task->open;
+    heapRemove(&imp->open, record);
+    task->open = NULL;
+
+    while (record->phases > 0 && record->burst[record->phases] == 0)
+        record->phases--;
+    if (record->phases == 0 && record->burst[0] == 0)
+    {
+        free(record);
+        return 0;
+    }
+
+    record->seq = imp->next_seq++;
+    if (heapPush(&imp->pending, record) != 0)
+    {
+        free(record);
+        return -1;
+    }
+    return 0;
+}
+
+// Nice 0 is 5, each 4 nice levels one step, real-time tasks 10
+static int criticality(int prio)
+{
+    if (prio < 100)
+        return 10;
+    int level = 5 - (prio - 120) / 4;
+    return level < 1 ? 1 : level > 10 ? 10 : level;
+}
+
+// Rounds to the nearest unit; a burst that ran at all keeps at least one
+static long toUnits(long ns, long unit, long least)
+{
+    long units = (ns + unit / 2) / unit;
+    return units < least ? least : units;
+}
+
+// Writes as many phases as fit on a line; the rest go back to the pending
+// heap as a record arriving with the wakeup they start from. The caller
+// frees the record on error.
+static int writeRecord(Importer *imp, TraceRecord *record)
+{
+    long unit = imp->options->unit_ns;
+    long arrival = (record->arrival - imp->origin) / unit;
+    long burst = toUnits(record->burst[0], unit, 1);
+    if (arrival > INT_MAX || burst > INT_MAX)
+        return SCHED_TRACE_TOO_LONG;
+
+    int level = criticality(record->prio);
+    char line[MAX_RECORD_LENGTH + 1];
+    int length = snprintf(line, sizeof(line), "%d %ld %ld 0 %d 0 %d", record->pid, arrival, burst, level, level);
+    imp->stats->cpu_time += burst;
+
+    int k = 0;
+    for (; k < record->phases; k++)
+    {
+        long wait = toUnits(record->wait[k], unit, 0);
+        long work = toUnits(record->burst[k + 1], unit, 1);
+        if (wait > INT_MAX || work > INT_MAX)
+            return SCHED_TRACE_TOO_LONG;
+
+        char pair[48];
+        int size = snprintf(pair, sizeof(pair), " %ld %ld", wait, work);
+        if (length + size > MAX_RECORD_LENGTH)
+            break;
+        memcpy(line + length, pair, size + 1);
+        length += size;
+        imp->stats->cpu_time += work;
+    }
+
+    if (fprintf(imp->out, "%s\n", line) < 0)
+        return -1;
+    imp->stats->records++;
+
+    if (k == record->phases)
+    {
+        free(record);
+        return 0;
+    }
+
+    record->arrival = record->wake[k];
+    record->burst[0] = record->burst[k + 1];
+    record->phases -= k + 1;
+    memmove(record->burst + 1, record->burst + k + 2, sizeof(long) * record->phases);
+    memmove(record->wait, record->wait + k + 1, sizeof(long) * record->phases);
+    memmove(record->wake, record->wake + k + 1, sizeof(long) * record->phases);
+    record->seq = imp->next_seq++;
+    return heapPush(&imp->pending, record);
+}
+
+// Writes every closed record that no open one can arrive before
+static int flushRecords(Importer *imp)
+{
+    RecordHeap *pending = &imp->pending;
+    while (pending->size > 0 &&
+           (imp->open.size == 0 || !recordBefore(imp->open.items[0], pending->items[0])))
+    {
+        TraceRecord *record = pending->items[0];
+        heapRemove(pending, record);
+        int status = writeRecord(imp, record);
+        if (status != 0)
+        {
+            free(record);
+            return status;
+        }
+    }
+    return 0;
+}
+
+// Adds the part of the slice since the last accounting to the open record
+static void chargeRunning(TraceTask *task, long now)
+{
+    if (task->state == TASK_RUNNING && task->open != NULL)
+        task->open->burst[task->open->phases] += now - task->since;
+    task->since = now;
+}
+
+static int wakeTask(Importer *imp, TraceTask *task, long now)
+{
+    if (task->state != TASK_SLEEPING)
+        return 0;
+    task->state = TASK_RUNNABLE;
+
+    TraceRecord *record = task->open;
+    if (record != NULL && record->phases == SCHED_MAX_IO_PHASES && closeRecord(imp, task) != 0)
+        return -1;
+    if (task->open == NULL)
+        return openRecord(imp, task, now);
+
+    record->wait[record->phases] = now - task->since;
+    record->wake[record->phases] = now;
+    record->phases++;
+    record->burst[record->phases] = 0;
+    return 0;
+}
+
+static int switchTasks(Importer *imp, long prev_pid, int prev_prio, char prev_state,
+                       long next_pid, int next_prio, long now)
+{
+    if (prev_pid > 0)
+    {
+        TraceTask *task = lookUp(imp, (int)prev_pid);
+        if (task == NULL)
+            return -1;
+
+        chargeRunning(task, now);
+        task->prio = prev_prio;
+        task->state = prev_state == 'R' ? TASK_RUNNABLE : TASK_SLEEPING;
+        if ((prev_state == 'X' || prev_state == 'Z') && task->open != NULL && closeRecord(imp, task) != 0)
+            return -1;
+    }
+
+    if (next_pid > 0)
+    {
+        TraceTask *task = lookUp(imp, (int)next_pid);
+        if (task == NULL)
+            return -1;
+
+        task->prio = next_prio;
+        // The trace may have missed the wakeup, or started with the task ready
+        if (wakeTask(imp, task, now) != 0)
+            return -1;
+        if (task->open == NULL && openRecord(imp, task, now) != 0)
+            return -1;
+        task->state = TASK_RUNNING;
+        task->since = now;
+    }
+    return 0;
+}
+
+// Closes records open for longer than the window, so the output can move on.
+// A task that is ready goes on in a new record arriving now.
+static int ageRecords(Importer *imp)
+{
+    long limit = imp->now - imp->options->window_ns;
+
+    while (imp->open.size > 0 && imp->open.items[0]->arrival < limit)
+    {
+        TraceTask *task = lookUp(imp, imp->open.items[0]->pid);
+        if (task == NULL)
+            return -1;
+
+        chargeRunning(task, imp->now);
+        if (closeRecord(imp, task) != 0)
+            return -1;
+        if (task->state != TASK_SLEEPING && openRecord(imp, task, imp->now) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+// Reads the number after " key", the key being the start of a field
+static bool readField(const char *text, const char *key, long *value)
+{
+    const char *p = strstr(text, key);
+    while (p != NULL && p != text && p[-1] != ' ')
+        p = strstr(p + 1, key);
+    if (p == NULL)
+        return false;
+
+    char *end;
+    const char *start = p + strlen(key);
+    *value = strtol(start, &end, 10);
+    return end != start;
+}
+
+// The "<seconds>.<fraction>:" stamp just before the event name, which perf
+// prefixes with "sched:"
+static bool readTimestamp(const char *line, const char *event, long *ns)
+{
+    const char *p = event;
+    if (p - line >= 6 && strncmp(p - 6, "sched:", 6) == 0)
+        p -= 6;
+    while (p > line && p[-1] == ' ')
+        p--;
+    if (p == line || p[-1] != ':')
+        return false;
+
+    const char *end = --p;
+    while (p > line && ((p[-1] >= '0' && p[-1] <= '9') || p[-1] == '.'))
+        p--;
+
+    long seconds = 0;
+    long fraction = 0;
+    int digits = 0;
+    bool dot = false;
+    for (; p < end; p++)
+    {
+        if (*p == '.')
+        {
+            if (dot)
+                return false;
+            dot = true;
+        }
+        else if (!dot)
+        {
+            if (seconds > LONG_MAX / 10000000000L)
+                return false;
+            seconds = seconds * 10 + (*p - '0');
+        }
+        else if (digits < 9)
+        {
+            fraction = fraction * 10 + (*p - '0');
+            digits++;
+        }
+    }
+    if (!dot || digits == 0)
+        return false;
+
+    for (; digits < 9; digits++)
+        fraction *= 10;
+    *ns = seconds * 1000000000L + fraction;
+    return true;
+}
+
+static int handleLine(Importer *imp, const char *line)
+{
+    const char *event = strstr(line, "sched_switch: ");
+    bool is_switch = event != NULL;
+    if (!is_switch)
+        event = strstr(line, "sched_wakeup: ");
+    if (event == NULL)
+        event = strstr(line, "sched_wakeup_new: ");
+    if (event == NULL)
+        return 0;
+
+    long stamp;
+    long prev_pid, prev_prio, next_pid, next_prio, pid, prio;
+    const char *fields = strchr(event, ':') + 1;
+    const char *state = strstr(fields, " prev_state=");
+    bool valid = readTimestamp(line, event, &stamp);
+    if (is_switch)
+        valid = valid && readField(fields, "prev_pid=", &prev_pid) && readField(fields, "prev_prio=", &prev_prio) &&
+                state != NULL && readField(fields, "next_pid=", &next_pid) &&
+                readField(fields, "next_prio=", &next_prio);
+    else
+        valid = valid && readField(fields, "pid=", &pid) && readField(fields, "prio=", &prio);
+    if (!valid)
+    {
+        imp->stats->malformed++;
+        return 0;
+    }
+
+    if (imp->origin < 0)
+    {
+        imp->origin = stamp;
+        imp->now = stamp;
+    }
+    if (stamp < imp->now)
+    {
+        imp->stats->reordered++;
+        stamp = imp->now;
+    }
+    imp->now = stamp;
+    imp->stats->events++;
+
+    int status;
+    if (is_switch)
+    {
+        status = switchTasks(imp, prev_pid, (int)prev_prio, state[12], next_pid, (int)next_prio, stamp);
+    }
+    else if (pid > 0)
+    {
+        TraceTask *task = lookUp(imp, (int)pid);
+        if (task == NULL)
+            return -1;
+        task->prio = (int)prio;
+        status = wakeTask(imp, task, stamp);
+    }
+    else
+    {
+        status = 0;
+    }
+
+    if (status == 0)
+        status = ageRecords(imp);
+    if (status == 0)
+        status = flushRecords(imp);
+    return status;
+}
+
+void sched_trace_default_options(SchedTraceOptions *options)
+{
+    options->unit_ns = 1000;
+    options->window_ns = 1000000000L;
+}
+
+int sched_trace_import(FILE *in, FILE *out, const SchedTraceOptions *options, SchedTraceStats *stats)
+{
+    SchedTraceOptions defaults;
+    if (options == NULL)
+    {
+        sched_trace_default_options(&defaults);
+        options = &defaults;
+    }
+
+    Importer imp;
+    memset(&imp, 0, sizeof(Importer));
+    memset(stats, 0, sizeof(SchedTraceStats));
+    imp.options = options;
+    imp.stats = stats;
+    imp.out = out;
+    imp.origin = -1;
+
+    char line[MAX_LINE_LENGTH];
+    int status = growTasks(&imp);
+    fprintf(out, "# Linux scheduler trace, one time unit = %ld ns\n", options->unit_ns);
+
+    while (status == 0 && fgets(line, sizeof(line), in) != NULL)
+    {
+        size_t length = strlen(line);
+        if (length > 0 && line[length - 1] != '\n')
+        {
+            // Only the start of an overlong line is needed
+            int c;
+            while ((c = getc(in)) != EOF && c != '\n')
+                ;
+        }
+        stats->lines++;
+        status = handleLine(&imp, line);
+    }
+
+    // Tasks still running when the trace ends stop there
+    for (int i = 0; i < imp.task_capacity && status == 0; i++)
+    {
+        TraceTask *task = &imp.tasks[i];
+        if (task->pid == 0 || task->open == NULL)
+            continue;
+        chargeRunning(task, imp.now);
+        status = closeRecord(&imp, task);
+    }
+    if (status == 0)
+        status = flushRecords(&imp);
+    if (status == 0 && (fflush(out) != 0 || ferror(out)))
+        status = -1;
+
+    for (int i = 0; i < imp.task_capacity; i++)
+        free(imp.tasks[i].open);
+    for (int i = 0; i < imp.pending.size; i++)
+        free(imp.pending.items[i]);
+    free(imp.tasks);
+    free(imp.open.items);
+    free(imp.pending.items);
+    return status;
+}
@@ -0,0 +1,215 @@
+#include <math.h>
+#include <string.h>
+
+#include "sched_workload.h"
+#include "sched_sim.h"
+
+#define MAX_LINE_LENGTH 256
+
+// Largest value one sample may take, so a heavy tail cannot overflow a task
+#define MAX_SAMPLE 1000000
+
+static void setDist(SchedDist *dist, SchedDistKind kind, double a, double b)
+{
+    dist->kind = kind;
+    dist->a = a;
+    dist->b = b;
+}
+
+void sched_workload_default(SchedWorkload *workload)
+{
+    workload->processes = 20;
+    setDist(&workload->interarrival, SCHED_DIST_EXPONENTIAL, 4.0, 0.0);
+    setDist(&workload->burst, SCHED_DIST_UNIFORM, 1.0, 10.0);
+    workload->deadline_share = 0.0;
+    setDist(&workload->slack, SCHED_DIST_UNIFORM, 0.0, 20.0);
+    setDist(&workload->criticality, SCHED_DIST_UNIFORM, 1.0, 10.0);
+    setDist(&workload->priority, SCHED_DIST_UNIFORM, 1.0, 10.0);
+    setDist(&workload->io_phases, SCHED_DIST_CONST, 0.0, 0.0);
+    setDist(&workload->io_wait, SCHED_DIST_UNIFORM, 1.0, 10.0);
+    setDist(&workload->io_burst, SCHED_DIST_UNIFORM, 1.0, 5.0);
+}
+
+// Parses "<kind> <a> [<b>]". Returns 0, or -1 if malformed or out of range.
+static int parseDist(const char *text, SchedDist *dist)
+{
+    char kind[16];
+    double a, b;
+    int fields = sscanf(text, "%15s %lf %lf", kind, &a, &b);
+
+    if (fields == 2 && strcmp(kind, "const") == 0 && a >= 0)
+        setDist(dist, SCHED_DIST_CONST, a, 0.0);
+    else if (fields == 3 && strcmp(kind, "uniform") == 0 && a >= 0 && b >= a)
+        setDist(dist, SCHED_DIST_UNIFORM, a, b);
+    else if (fields == 2 && strcmp(kind, "exponential") == 0 && a > 0)
+        setDist(dist, SCHED_DIST_EXPONENTIAL, a, 0.0);
+    else if (fields == 3 && strcmp(kind, "normal") == 0 && b >= 0)
+        setDist(dist, SCHED_DIST_NORMAL, a, b);
+    else if (fields == 3 && strcmp(kind, "pareto") == 0 && a > 0 && b > 0)
+        setDist(dist, SCHED_DIST_PARETO, a, b);
+    else
+        return -1;
+    return 0;
+}
+
+// The distribution a key sets, or NULL if it names none
+static SchedDist *distField(SchedWorkload *workload, const char *key)
+{
+    if (strcmp(key, "interarrival") == 0)
+        return &workload->interarrival;
+    if (strcmp(key, "burst") == 0)
+        return &workload->burst;
+    if (strcmp(key, "slack") == 0)
+        return &workload->slack;
+    if (strcmp(key, "criticality") == 0)
+        return &workload->criticality;
+    if (strcmp(key, "priority") == 0)
+        return &workload->priority;
+    if (strcmp(key, "io_phases") == 0)
+        return &workload->io_phases;
+    if (strcmp(key, "io_wait") == 0)
+        return &workload->io_wait;
+    if (strcmp(key, "io_burst") == 0)
+        return &workload->io_burst;
+    return NULL;
+}
+
+int sched_workload_read(FILE *in, SchedWorkload *workload, int *line_number)
+{
+    char line[MAX_LINE_LENGTH];
+
+    sched_workload_default(workload);
+    *line_number = 0;
+
+    while (fgets(line, sizeof(line), in) != NULL)
+    {
+        (*line_number)++;
+
+        char *p = line;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#')
+            continue;
+
+        char key[32];
+        int consumed;
+        double share;
+        if (sscanf(p, "%31s%n", key, &consumed) != 1)
+            return -1;
+        const char *rest = p + consumed;
+        SchedDist *dist = distField(workload, key);
+
+        if (dist != NULL)
+        {
+            if (parseDist(rest, dist) != 0)
+                return -1;
+        }
+        else if (strcmp(key, "processes") == 0)
+        {
+            if (sscanf(rest, "%d", &workload->processes) != 1 || workload->processes <= 0)
+                return -1;
+        }
+        else if (strcmp(key, "deadline_share") == 0 && sscanf(rest, "%lf", &share) == 1 &&
+                 share >= 0.0 && share <= 1.0)
+            workload->deadline_share = share;
+        else
+            return -1;
+    }
+
+    return 0;
+}
+
+// splitmix64: every seed gives its own well-mixed stream
+static unsigned long long nextRandom(unsigned long long *state)
+{
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1)
+static double nextUnit(unsigned long long *state)
+{
+    return (nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static int sample(const SchedDist *dist, unsigned long long *state, int min, int max)
+{
+    double value = 0.0;
+
+    switch (dist->kind)
+    {
+    case SCHED_DIST_CONST:
+        value = dist->a;
+        break;
+    case SCHED_DIST_UNIFORM:
+        value = floor(dist->a + nextUnit(state) * (floor(dist->b) - dist->a + 1.0));
+        break;
+    case SCHED_DIST_EXPONENTIAL:
+        value = -dist->a * log(1.0 - nextUnit(state));
+        break;
+    case SCHED_DIST_NORMAL:
+    {
+        // Box-Muller; 1 - u keeps the logarithm finite
+        double u = 1.0 - nextUnit(state);
+        double v = nextUnit(state);
+        value = dist->a + dist->b * sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+        break;
+    }
+    case SCHED_DIST_PARETO:
+        value = dist->a / pow(1.0 - nextUnit(state), 1.0 / dist->b);
+        break;
+    }
+
+    if (dist->kind != SCHED_DIST_UNIFORM)
+        value = floor(value + 0.5);
+    if (!(value >= min))
+        return min;
+    if (value > max)
+        return max;
+    return (int)value;
+}
+
+int sched_workload_generate(const SchedWorkload *workload, unsigned long seed, SchedTask *tasks)
+{
+    unsigned long long state = seed;
+    long arrival = 0;
+    long work = 0; // Every CPU burst and I/O wait so far, which bounds the end of the run
+
+    for (int i = 0; i < workload->processes; i++)
+    {
+        SchedTask *task = &tasks[i];
+        memset(task, 0, sizeof(SchedTask));
+
+        if (i > 0)
+            arrival += sample(&workload->interarrival, &state, 0, MAX_SAMPLE);
+        if (arrival > SCHED_SIM_MAX_HORIZON)
+            return -1;
+        task->id = i + 1;
+        task->arrival_time = (int)arrival;
+        task->burst_time = sample(&workload->burst, &state, 1, MAX_SAMPLE);
+        task->criticality = sample(&workload->criticality, &state, 1, 10);
+        task->system_priority = sample(&workload->priority, &state, 1, 10);
+
+        task->io.count = sample(&workload->io_phases, &state, 0, SCHED_MAX_IO_PHASES);
+        for (int k = 0; k < task->io.count; k++)
+        {
+            task->io.wait[k] = sample(&workload->io_wait, &state, 0, MAX_SAMPLE);
+            task->io.burst[k] = sample(&workload->io_burst, &state, 1, MAX_SAMPLE);
+            task->burst_time += task->io.burst[k];
+        }
+        work += task->burst_time + sched_io_time(&task->io);
+
+        // Drawn for every task, so the share does not shift the other samples
+        bool has_deadline = nextUnit(&state) < workload->deadline_share;
+        int slack = sample(&workload->slack, &state, 0, MAX_SAMPLE);
+        if (has_deadline)
+            task->deadline = task->burst_time + sched_io_time(&task->io) + slack;
+
+        if (arrival + work > SCHED_SIM_MAX_HORIZON)
+            return -1;
+    }
+
+    return 0;
+}